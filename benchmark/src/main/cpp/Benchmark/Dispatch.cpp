@@ -0,0 +1,105 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Benchmark/LocalInterface.h"
+#include "Benchmark/Suites.h"
+#include "TMInterface/Metrics.h"
+#include "TMInterface/Utils/CycleClock.h"
+
+namespace Benchmark {
+
+using namespace TMInterface;
+
+namespace {
+
+uint64_t calls = 0;
+
+Packet* countCall(Packets::S_ON_CUSTOM_COMMAND&, Packet* response) {
+	++calls;
+
+	return response;
+}
+
+}  // namespace
+
+void runDispatch(Runner& runner) {
+	runner.run("packet/get_by_id", Packets::ANY_ID, [](size_t count) {
+		for (size_t i = 1; i <= count; ++i) {
+			const std::unique_ptr<Packet> packet = Packet::getPacketById(static_cast<int32_t>(i));
+			keep(packet.get());
+		}
+	});
+
+	Packets::PacketStorage storage;
+
+	runner.run("packet/emplace_by_id", Packets::ANY_ID, [&storage](size_t count) {
+		for (size_t i = 1; i <= count; ++i) {
+			keep(Packets::emplacePacketById(static_cast<int32_t>(i), storage));
+		}
+	});
+
+	Packets::S_ON_BRUTEFORCE_EVALUATE uncalled;
+
+	runner.run("call_callbacks/0", 256, [&uncalled](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			keep(uncalled.callCallbacks(nullptr));
+		}
+	});
+
+	// Callbacks can't be removed, so the custom command only gets more of them
+	Packets::S_ON_CUSTOM_COMMAND called;
+	size_t registered = 0;
+
+	for (size_t callbacks : {1, 4}) {
+		for (; registered < callbacks; ++registered) {
+			Packets::S_ON_CUSTOM_COMMAND::registerCallback(countCall);
+		}
+
+		runner.run("call_callbacks/" + std::to_string(callbacks), 256, [&called](size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				keep(called.callCallbacks(nullptr));
+			}
+		});
+	}
+
+	keep(calls);
+
+	// What every packet pays for the instrumentation, one operation is a request and its response. Most of it is the
+	// clock, which virtual machines may make a lot slower
+	runner.run("metrics/cycle_clock", 256, [](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			keep(Utils::CycleClock::now());
+		}
+	});
+
+	Metrics metrics;
+
+	runner.run("metrics/on_send+on_receive", 256, [&metrics](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			metrics.onSend(Packets::C_PROCESSED_CALL_ID, 48);
+			metrics.onReceive(Packets::S_ON_SIM_STEP_ID);
+		}
+	});
+
+	keep(metrics.snapshot().packetsSent);
+
+	LocalInterface local;
+
+	runner.run("receive_packet/S_ON_SIM_STEP", 64, [&local](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.loadPacket(Packets::S_ON_SIM_STEP_ID, CallOnSimStepData{static_cast<uint32_t>(i)});
+			keep(local.receivePacket());
+		}
+	});
+
+	// Includes sending the C_PROCESSED_CALL the default callback answers with
+	runner.run("receive_packet/S_ON_REGISTERED", 64, [&local](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.loadPacket(Packets::S_ON_REGISTERED_ID);
+			keep(local.receivePacket());
+		}
+	});
+}
+
+}  // namespace Benchmark
@@ -0,0 +1,20 @@
+#include "Benchmark/LocalInterface.h"
+
+namespace Benchmark {
+
+LocalInterface::LocalInterface(const std::string& name)
+    : Interface(name, true, TMInterface::Utils::MappingOptions{true}) {}
+
+void LocalInterface::rewind() {
+	cursor.seek(0);
+}
+
+void LocalInterface::clear() {
+	zero();
+}
+
+void LocalInterface::loadPacket(int32_t packetId) {
+	loadPacket(packetId, int32_t{0});
+}
+
+}  // namespace Benchmark
@@ -0,0 +1,37 @@
+#include "Benchmark/Peer.h"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace Benchmark {
+
+using namespace TMInterface;
+
+Peer::Peer(const std::string& bufferName) : running(true), server(bufferName, Utils::MappingOptions{true}) {
+	if (!server) throw std::runtime_error("Can't create buffer " + bufferName);
+
+	thread = std::thread([this] { server.run(running); });
+}
+
+Peer::~Peer() {
+	running = false;
+	thread.join();
+}
+
+Packet* exchange(Interface& client, const Packet& packet) {
+	client.sendPacket(packet);
+
+	return waitAndReceive(client);
+}
+
+Packet* waitAndReceive(Interface& client) {
+	if (!client.waitForPacket(std::chrono::seconds(1))) throw std::runtime_error("No answer from the emulator");
+
+	Packet* packet = client.receivePacket();
+
+	if (packet == nullptr) throw std::runtime_error("Unknown packet from the emulator");
+
+	return packet;
+}
+
+}  // namespace Benchmark
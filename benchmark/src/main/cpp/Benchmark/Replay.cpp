@@ -0,0 +1,69 @@
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include "Benchmark/Peer.h"
+#include "Benchmark/Suites.h"
+#include "TMInterface/TraceReplayer.h"
+
+namespace Benchmark {
+
+using namespace TMInterface;
+
+namespace {
+
+constexpr size_t RECORDED_STEPS = 4096;
+
+// Registers, answers RECORDED_STEPS server calls and deregisters again, all of it recorded to path
+void recordSession(const std::string& bufferName, const std::string& path) {
+	Peer peer(bufferName);
+	Interface client(bufferName);
+
+	if (!client) throw std::runtime_error("Can't open buffer " + bufferName);
+
+	client.startRecording(path);
+
+	exchange(client, Packets::C_REGISTER{});
+
+	Packets::C_PROCESSED_CALL processed;
+
+	for (size_t i = 0; i < RECORDED_STEPS; ++i) {
+		processed.which = waitAndReceive(client)->packetId;
+		client.sendPacket(processed);
+	}
+
+	waitAndReceive(client);
+	exchange(client, Packets::C_DEREGISTER{});
+
+	client.stopRecording();
+}
+
+}  // namespace
+
+void runReplay(Runner& runner, const std::string& bufferName) {
+	if (!runner.isEnabled("replay/")) return;
+
+	const std::string path = (std::filesystem::temp_directory_path() / (bufferName + ".trace")).string();
+
+	recordSession(bufferName, path);
+
+	{
+		TraceReplayer replayer(path, bufferName + "Replay");
+
+		// One received packet of the session per operation, from the trace instead of the server
+		runner.run("replay/receive_packet", 64, [&replayer](size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				if (!replayer.loadNext()) {
+					replayer.rewind();
+					replayer.loadNext();
+				}
+
+				keep(replayer.receivePacket());
+			}
+		});
+	}
+
+	std::filesystem::remove(path);
+}
+
+}  // namespace Benchmark
@@ -0,0 +1,44 @@
+#include <stdexcept>
+
+#include "Benchmark/Peer.h"
+#include "Benchmark/Suites.h"
+
+namespace Benchmark {
+
+using namespace TMInterface;
+
+void runRoundTrip(Runner& runner, const std::string& bufferName) {
+	if (!runner.isEnabled("round_trip/")) return;
+
+	Peer peer(bufferName);
+	Interface client(bufferName);
+
+	if (!client) throw std::runtime_error("Can't open buffer " + bufferName);
+
+	const Packets::C_SIM_GET_STATE getState;
+
+	runner.run("round_trip/C_SIM_GET_STATE", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			exchange(client, getState);
+			keep(SimStateView::read(client).data);
+		}
+	});
+
+	// The default callback acknowledges S_ON_REGISTERED, the server starts simulating right after
+	exchange(client, Packets::C_REGISTER{});
+
+	Packets::C_PROCESSED_CALL processed;
+
+	runner.run("round_trip/server_call", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			processed.which = waitAndReceive(client)->packetId;
+			client.sendPacket(processed);
+		}
+	});
+
+	// The server only takes client calls while it waits for an answer to one of its calls
+	waitAndReceive(client);
+	exchange(client, Packets::C_DEREGISTER{});
+}
+
+}  // namespace Benchmark
@@ -0,0 +1,112 @@
+#include "Benchmark/Runner.h"
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace Benchmark {
+
+Runner::Runner(const RunnerSettings& settings) : settings(settings) {}
+
+bool Runner::isEnabled(const std::string& name) const {
+	return name.find(settings.filter) != std::string::npos;
+}
+
+const std::vector<BenchmarkResult>& Runner::getResults() const {
+	return results;
+}
+
+void Runner::writeJson(std::ostream& os) const {
+	const std::ios_base::fmtflags flags = os.flags();
+
+	os << std::fixed << std::setprecision(3);
+
+	for (const BenchmarkResult& result : results) {
+		// Names are ours and never need escaping
+		os << "{\"name\":\"" << result.name << "\",\"operations\":" << result.operations
+		   << ",\"batch_size\":" << result.batchSize << ",\"mean_ns\":" << result.mean << ",\"min_ns\":" << result.min
+		   << ",\"p50_ns\":" << result.p50 << ",\"p90_ns\":" << result.p90 << ",\"p99_ns\":" << result.p99
+		   << ",\"max_ns\":" << result.max << "}\n";
+	}
+
+	os.flags(flags);
+}
+
+void Runner::writeTable(std::ostream& os) const {
+	const std::ios_base::fmtflags flags = os.flags();
+
+	os << std::left << std::setw(44) << "benchmark (ns/op)" << std::right << std::setw(12) << "operations"
+	   << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+	   << '\n';
+
+	os << std::fixed << std::setprecision(1);
+
+	for (const BenchmarkResult& result : results) {
+		os << std::left << std::setw(44) << result.name << std::right << std::setw(12) << result.operations
+		   << std::setw(10) << result.mean << std::setw(10) << result.p50 << std::setw(10) << result.p90
+		   << std::setw(10) << result.p99 << '\n';
+	}
+
+	os.flags(flags);
+}
+
+size_t Runner::compare(const std::map<std::string, double>& baseline, double threshold, std::ostream& os) const {
+	const std::ios_base::fmtflags flags = os.flags();
+	size_t regressions = 0;
+
+	os << std::fixed << std::setprecision(1);
+
+	for (const BenchmarkResult& result : results) {
+		const std::map<std::string, double>::const_iterator it = baseline.find(result.name);
+
+		if ((it == baseline.end()) || (it->second <= 0.0)) continue;
+
+		const double change = (result.mean / it->second) - 1.0;
+
+		if (change > threshold) {
+			os << "Regression: " << result.name << " " << it->second << " -> " << result.mean << " ns/op (+"
+			   << static_cast<int>(change * 100.0) << "%)\n";
+
+			++regressions;
+		}
+	}
+
+	os.flags(flags);
+
+	return regressions;
+}
+
+std::map<std::string, double> Runner::readBaseline(const std::string& path) {
+	std::ifstream file(path);
+
+	if (!file) throw std::runtime_error("Can't read baseline " + path);
+
+	std::map<std::string, double> baseline;
+	std::string line;
+
+	// Only needs to understand what writeJson produces
+	const std::string nameKey = "\"name\":\"";
+	const std::string meanKey = "\"mean_ns\":";
+
+	while (std::getline(file, line)) {
+		const size_t name = line.find(nameKey);
+		const size_t mean = line.find(meanKey);
+
+		if ((name == std::string::npos) || (mean == std::string::npos)) continue;
+
+		const size_t nameStart = name + nameKey.size();
+		const size_t nameEnd = line.find('"', nameStart);
+
+		if (nameEnd == std::string::npos) continue;
+
+		baseline[line.substr(nameStart, nameEnd - nameStart)] = std::stod(line.substr(mean + meanKey.size()));
+	}
+
+	return baseline;
+}
+
+void Runner::add(BenchmarkResult&& result) {
+	results.push_back(std::move(result));
+}
+
+}  // namespace Benchmark
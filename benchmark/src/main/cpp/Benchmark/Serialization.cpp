@@ -0,0 +1,113 @@
+#include "Benchmark/LocalInterface.h"
+#include "Benchmark/Suites.h"
+#include "Emulator/CarModel.h"
+
+namespace Benchmark {
+
+using namespace TMInterface;
+
+void runSerialization(Runner& runner) {
+	LocalInterface local;
+
+	SimState state;
+	Emulator::CarModel{}.reset(state);
+	const SimStateView view = state.view();
+
+	runner.run("write_obj/int32", 1024, [&](size_t count) {
+		local.rewind();
+
+		for (size_t i = 0; i < count; ++i) {
+			local.writeObj(static_cast<int32_t>(i));
+		}
+
+		clobber();
+	});
+
+	runner.run("read_obj/int32", 1024, [&](size_t count) {
+		local.rewind();
+
+		for (size_t i = 0; i < count; ++i) {
+			int32_t value;
+			local.readObj(value);
+			keep(value);
+		}
+	});
+
+	runner.run("write_obj/SimStateData", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.rewind();
+			local.writeObj(state.data);
+			clobber();
+		}
+	});
+
+	runner.run("write/SimStateView", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.rewind();
+			view.write(local);
+			clobber();
+		}
+	});
+
+	// What a rewind between two nearby states sends
+	constexpr uint32_t partial = HAS_TIMERS | HAS_STATE_2 | HAS_INPUT_STATE;
+
+	runner.run("write/SimStateView/partial", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.rewind();
+			view.write(local, partial);
+			clobber();
+		}
+	});
+
+	SimState other = state;
+	other.data.inputSteerState = 65536;
+	const SimStateView otherView = other.view();
+
+	runner.run("diff_chunks/SimStateView", 64, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			keep(view.diffChunks(otherView));
+			clobber();
+		}
+	});
+
+	runner.run("read/SimStateView", 64, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.rewind();
+			keep(SimStateView::read(local).data);
+		}
+	});
+
+	runner.run("read/SimState", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.rewind();
+
+			const SimState owned = SimStateView::read(local).toOwned();
+			keep(owned.data);
+		}
+	});
+
+	runner.run("zero/header", 64, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			local.writeObj(Packets::C_PROCESSED_CALL_ID);
+			local.writeObj(ErrorCode::NONE);
+			local.clear();
+		}
+	});
+
+	runner.run("zero/SimStateView", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			view.write(local);
+			local.clear();
+		}
+	});
+
+	runner.run("zero/SimStateView/partial", 16, [&](size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			view.write(local, partial);
+			local.clear();
+		}
+	});
+}
+
+}  // namespace Benchmark
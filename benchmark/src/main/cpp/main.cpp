@@ -0,0 +1,86 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include "Benchmark/Runner.h"
+#include "Benchmark/Suites.h"
+
+namespace {
+
+void printUsage(const char* name) {
+	std::cerr << "Usage: " << name << " [options]\n"
+	          << "  --filter <text>      only run benchmarks whose name contains text\n"
+	          << "  --min-time <ms>      minimum time per benchmark (default: 500)\n"
+	          << "  --json <path>        write the results as JSON lines, - for stdout\n"
+	          << "  --baseline <path>    compare against the JSON output of an earlier run\n"
+	          << "  --threshold <pct>    slowdown counted as a regression (default: 10)\n"
+	          << "  --buffer <name>      buffer used for the round trips (default: TMInterfaceBench)\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	Benchmark::RunnerSettings settings;
+	std::string jsonPath;
+	std::string baselinePath;
+	double threshold = 10.0;
+	std::string bufferName = "TMInterfaceBench";
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const bool hasValue = (i + 1) < argc;
+
+		if ((arg == "--filter") && hasValue) {
+			settings.filter = argv[++i];
+		} else if ((arg == "--min-time") && hasValue) {
+			settings.minTime = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+		} else if ((arg == "--json") && hasValue) {
+			jsonPath = argv[++i];
+		} else if ((arg == "--baseline") && hasValue) {
+			baselinePath = argv[++i];
+		} else if ((arg == "--threshold") && hasValue) {
+			threshold = std::strtod(argv[++i], nullptr);
+		} else if ((arg == "--buffer") && hasValue) {
+			bufferName = argv[++i];
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	Benchmark::Runner runner(settings);
+
+	try {
+		// Read it first, so a wrong path doesn't waste a whole run
+		const std::map<std::string, double> baseline =
+		    baselinePath.empty() ? std::map<std::string, double>{} : Benchmark::Runner::readBaseline(baselinePath);
+
+		Benchmark::runSerialization(runner);
+		Benchmark::runDispatch(runner);
+		Benchmark::runRoundTrip(runner, bufferName);
+		Benchmark::runReplay(runner, bufferName);
+
+		// Keep stdout machine readable when the JSON goes there
+		std::ostream& table = (jsonPath == "-") ? std::cerr : std::cout;
+		runner.writeTable(table);
+
+		if (jsonPath == "-") {
+			runner.writeJson(std::cout);
+		} else if (!jsonPath.empty()) {
+			std::ofstream file(jsonPath);
+			runner.writeJson(file);
+
+			if (!file) throw std::runtime_error("Can't write " + jsonPath);
+		}
+
+		if (!baselinePath.empty() && (runner.compare(baseline, threshold / 100.0, table) != 0)) return 2;
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+#include "TMInterface/Interface.h"
+
+namespace Benchmark {
+
+// Interface on a private buffer without a peer. Opens up the parts of the transport the benchmarks time on their own
+class LocalInterface : public TMInterface::Interface {
+public:
+	explicit LocalInterface(const std::string& name = "TMInterfaceBenchLocal");
+
+	// Moves the cursor back to the start of the buffer, without clearing anything
+	void rewind();
+	void clear();
+
+	// Puts a packet into the buffer like the peer would, so receivePacket() picks it up
+	template <typename T>
+	void loadPacket(int32_t packetId, const T& data);
+	void loadPacket(int32_t packetId);
+};
+
+// template functions
+template <typename T>
+void LocalInterface::loadPacket(int32_t packetId, const T& data) {
+	zero();
+
+	writeObj(packetId);
+	writeObj(TMInterface::ErrorCode::NONE);
+	writeObj(data);
+
+	ready.publish();
+}
+
+}  // namespace Benchmark
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "Emulator/Server.h"
+#include "TMInterface/Interface.h"
+
+namespace Benchmark {
+
+// Emulator server on its own thread, stopped when leaving scope
+class Peer {
+protected:
+	std::atomic_bool running;
+	Emulator::Server server;
+	std::thread thread;
+
+public:
+	explicit Peer(const std::string& bufferName);
+	~Peer();
+
+	// Delete copy stuff
+	Peer(const Peer&) = delete;
+	Peer& operator=(const Peer&) = delete;
+};
+
+// Sends packet and returns the answer. Throws std::runtime_error if there is none within a second
+TMInterface::Packet* exchange(TMInterface::Interface& client, const TMInterface::Packet& packet);
+TMInterface::Packet* waitAndReceive(TMInterface::Interface& client);
+
+}  // namespace Benchmark
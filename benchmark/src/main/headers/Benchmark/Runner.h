@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+struct RunnerSettings {
+	// Every benchmark runs at least this long, after a warm up of a tenth of it
+	std::chrono::milliseconds minTime{500};
+	// Only benchmarks whose name contains this run
+	std::string filter;
+};
+
+// Times are nanoseconds per operation. Percentiles are over batches, so they are per operation averages of a batch
+struct BenchmarkResult {
+	std::string name;
+	uint64_t operations = 0;
+	uint64_t batchSize = 0;
+	double mean = 0.0;
+	double min = 0.0;
+	double p50 = 0.0;
+	double p90 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+};
+
+class Runner {
+protected:
+	const RunnerSettings settings;
+	std::vector<BenchmarkResult> results;
+
+public:
+	explicit Runner(const RunnerSettings& settings = {});
+
+	bool isEnabled(const std::string& name) const;
+
+	// Calls body(batchSize) until minTime is up. body has to perform batchSize operations per call, which keeps the
+	// timer overhead out of cheap operations
+	template <typename Body>
+	void run(const std::string& name, size_t batchSize, Body&& body);
+
+	const std::vector<BenchmarkResult>& getResults() const;
+
+	// One JSON object per line and benchmark
+	void writeJson(std::ostream& os) const;
+	void writeTable(std::ostream& os) const;
+	// Prints every benchmark whose mean got slower than the baseline by more than threshold (0.1 = 10%). Returns how
+	// many did
+	size_t compare(const std::map<std::string, double>& baseline, double threshold, std::ostream& os) const;
+
+	// Mean per benchmark of a previous writeJson output. Throws std::runtime_error if the file can't be read
+	static std::map<std::string, double> readBaseline(const std::string& path);
+
+protected:
+	void add(BenchmarkResult&& result);
+};
+
+// Keeps the compiler from optimizing away value or the computation leading up to it
+template <typename T>
+void keep(const T& value);
+
+// Keeps the compiler from optimizing away or reordering memory writes across this point
+void clobber();
+
+}  // namespace Benchmark
+
+#define Benchmark_Runner_Proper_Included
+
+#include "Runner.inc.h"
+
+#undef Benchmark_Runner_Proper_Included
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Runner.h"
+
+#ifdef Benchmark_Runner_Proper_Included
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <utility>
+
+#include "TMInterface/Utils/CycleClock.h"
+#include "TMInterface/Utils/Histogram.h"
+
+namespace Benchmark {
+
+// template functions
+template <typename Body>
+void Runner::run(const std::string& name, size_t batchSize, Body&& body) {
+	using TMInterface::Utils::CycleClock;
+
+	if (!isEnabled(name)) return;
+
+	const std::chrono::steady_clock::time_point warmUpEnd = std::chrono::steady_clock::now() + (settings.minTime / 10);
+
+	while (std::chrono::steady_clock::now() < warmUpEnd) {
+		body(batchSize);
+	}
+
+	TMInterface::Utils::Histogram batches;
+
+	const CycleClock::Calibration start = CycleClock::Calibration::now();
+	const std::chrono::steady_clock::time_point end = start.time + settings.minTime;
+	// Checking the time isn't part of the measurement, only the batches are
+	do {
+		const uint64_t before = CycleClock::now();
+		body(batchSize);
+		batches.record(CycleClock::now() - before);
+	} while (std::chrono::steady_clock::now() < end);
+
+	const double scale = CycleClock::Calibration::getScale(start, CycleClock::Calibration::now());
+	const double perOperation = scale / static_cast<double>(batchSize);
+
+	BenchmarkResult result;
+	result.name = name;
+	result.operations = batches.getCount() * batchSize;
+	result.batchSize = batchSize;
+	result.mean = batches.getMean() * perOperation;
+	result.min = static_cast<double>(batches.getMin()) * perOperation;
+	result.p50 = static_cast<double>(batches.getPercentile(50.0)) * perOperation;
+	result.p90 = static_cast<double>(batches.getPercentile(90.0)) * perOperation;
+	result.p99 = static_cast<double>(batches.getPercentile(99.0)) * perOperation;
+	result.max = static_cast<double>(batches.getMax()) * perOperation;
+
+	add(std::move(result));
+}
+
+template <typename T>
+void keep(const T& value) {
+#ifdef _MSC_VER
+	const volatile char sink = *reinterpret_cast<const volatile char*>(&value);
+	(void)sink;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+inline void clobber() {
+#ifdef _MSC_VER
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : : "memory");
+#endif
+}
+
+}  // namespace Benchmark
+
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "Runner.h"
+
+namespace Benchmark {
+
+// writeObj/readObj, SimStateView and Interface::zero on a local buffer
+void runSerialization(Runner& runner);
+// Packet construction by id, callCallbacks and the whole client side receive path
+void runDispatch(Runner& runner);
+// Request/response round trips against an emulator server on another thread of this process
+void runRoundTrip(Runner& runner, const std::string& bufferName);
+// The client side alone, on a recorded session against an emulator server played back with TraceReplayer
+void runReplay(Runner& runner, const std::string& bufferName);
+
+}  // namespace Benchmark
@@ -0,0 +1,124 @@
+#include "Emulator/CarModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Emulator {
+
+namespace {
+
+template <typename T, size_t N>
+T load(const std::array<unsigned char, N>& chunk, size_t offset) {
+	T value;
+	std::memcpy(&value, chunk.data() + offset, sizeof(T));
+	return value;
+}
+
+template <typename T, size_t N>
+void store(std::array<unsigned char, N>& chunk, size_t offset, const T& value) {
+	std::memcpy(chunk.data() + offset, &value, sizeof(T));
+}
+
+}  // namespace
+
+Track Track::getDefault() {
+	// A lazy S curve with 4 checkpoints and the finish
+	return Track{{0.0f, 9.0f, 0.0f},
+	             0.0f,
+	             {{0.0f, 9.0f, 200.0f},
+	              {80.0f, 9.0f, 380.0f},
+	              {0.0f, 9.0f, 560.0f},
+	              {-80.0f, 9.0f, 740.0f},
+	              {0.0f, 9.0f, 920.0f}},
+	             12.0f};
+}
+
+CarModel::CarModel(const Track& track) : track(track) {}
+
+void CarModel::reset(TMInterface::SimState& state) const {
+	state = TMInterface::SimState{};
+
+	state.data.contextMode = static_cast<uint32_t>(TMInterface::ContextMode::SIMULATION);
+	state.data.flags = TMInterface::HAS_ALL;
+	state.data.inputRunningState = 1;
+
+	store(state.data.state2, POSITION_OFFSET, track.start);
+	store(state.data.state2, YAW_OFFSET, track.startYaw);
+
+	state.cpStates.assign(track.checkpoints.size(), 0);
+	state.cpTimes.assign(track.checkpoints.size(), TMInterface::CheckpointTime{});
+}
+
+bool CarModel::step(TMInterface::SimState& state) const {
+	constexpr float dt = TICK_MS / 1000.0f;
+	constexpr float engineForce = 16.0f;
+	constexpr float brakeForce = 30.0f;
+	constexpr float drag = 0.02f;
+	constexpr float turnRate = 1.6f;
+
+	TMInterface::SimStateData& data = state.data;
+
+	const uint32_t time = getTime(state) + TICK_MS;
+	store(data.timers, TIME_OFFSET, time);
+
+	Vec3 position = load<Vec3>(data.state2, POSITION_OFFSET);
+	Vec3 velocity = load<Vec3>(data.state2, VELOCITY_OFFSET);
+	float yaw = load<float>(data.state2, YAW_OFFSET);
+
+	float speed = std::sqrt(velocity.x * velocity.x + velocity.z * velocity.z);
+
+	// Analog steer wins over the digital keys
+	float steer = data.inputSteerState / 65536.0f;
+	if (steer == 0.0f) steer = static_cast<float>(data.inputRightState - data.inputLeftState);
+	steer = std::clamp(steer, -1.0f, 1.0f);
+
+	float gas = data.inputAccelerateState ? 1.0f : 0.0f;
+	if (data.inputGasState != 0) gas = std::clamp(data.inputGasState / 65536.0f, -1.0f, 1.0f);
+
+	speed += (engineForce * gas - (data.inputBrakeState ? brakeForce : 0.0f) - drag * speed * speed) * dt;
+	speed = std::max(speed, 0.0f);
+
+	// Steering gets less effective when standing still
+	yaw += steer * turnRate * dt * std::min(1.0f, speed / 10.0f);
+
+	velocity = {std::sin(yaw) * speed, 0.0f, std::cos(yaw) * speed};
+	position.x += velocity.x * dt;
+	position.z += velocity.z * dt;
+
+	store(data.state2, POSITION_OFFSET, position);
+	store(data.state2, VELOCITY_OFFSET, velocity);
+	store(data.state2, YAW_OFFSET, yaw);
+
+	// Checkpoints have to be taken in order
+	const uint32_t next = getCheckpointCount(state);
+
+	if (next < track.checkpoints.size()) {
+		const Vec3& cp = track.checkpoints[next];
+		const float dx = position.x - cp.x;
+		const float dz = position.z - cp.z;
+
+		if (dx * dx + dz * dz <= track.checkpointRadius * track.checkpointRadius) {
+			state.cpStates[next] = 1;
+			state.cpTimes[next].time = static_cast<int32_t>(time);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint32_t CarModel::getCheckpointCount(const TMInterface::SimState& state) const {
+	return static_cast<uint32_t>(std::count(state.cpStates.begin(), state.cpStates.end(), 1u));
+}
+
+uint32_t CarModel::getCheckpointTarget() const {
+	return static_cast<uint32_t>(track.checkpoints.size());
+}
+
+uint32_t CarModel::getTime(const TMInterface::SimState& state) {
+	return load<uint32_t>(state.data.timers, TIME_OFFSET);
+}
+
+}  // namespace Emulator
@@ -0,0 +1,311 @@
+#include "Emulator/Server.h"
+
+#include <algorithm>
+
+namespace Emulator {
+
+using namespace TMInterface;
+
+Server::Server(size_t index, const Utils::MappingOptions& options, const ServerSettings& settings,
+               const CarModel& model)
+    : Server(getNameFromIndex(index), options, settings, model) {}
+
+Server::Server(const std::string& name, const Utils::MappingOptions& options, const ServerSettings& settings,
+               const CarModel& model)
+    : Interface(name, true, options),
+      model(model),
+      settings(settings),
+      timeout(settings.timeout),
+      running(nullptr),
+      eventsDuration(0),
+      historyLength(0),
+      stepsServed(0),
+      callsServed(0) {
+	model.reset(state);
+}
+
+Server::~Server() {}
+
+void Server::run(const std::atomic_bool& running) {
+	this->running = &running;
+
+	while (running) {
+		if (registered) {
+			simulate();
+			continue;
+		}
+
+		const int32_t packetId = waitForClient(-1);
+
+		if (packetId != -1) handleClientCall(packetId);
+	}
+
+	this->running = nullptr;
+}
+
+uint64_t Server::getStepsServed() const {
+	return stepsServed;
+}
+
+uint64_t Server::getCallsServed() const {
+	return callsServed;
+}
+
+void Server::simulate() {
+	model.reset(state);
+	historyLength = 0;
+	serverCall(Packets::S_ON_SIM_BEGIN_ID);
+
+	while (*running && registered) {
+		// Like the game, the client gets to look at (and modify) the state before the physics step
+		saveState();
+		serverCall(Packets::S_ON_SIM_STEP_ID, CallOnSimStepData{CarModel::getTime(state)});
+		applyEvents();
+
+		if (model.step(state)) {
+			serverCall(Packets::S_ON_CHECKPOINT_COUNT_CHANGED_ID,
+			           CallOnCheckpointCountChangedData{model.getCheckpointCount(state), model.getCheckpointTarget()});
+		}
+
+		++stepsServed;
+
+		if (CarModel::getTime(state) >= settings.simDuration) {
+			serverCall(Packets::S_ON_SIM_END_ID, CallOnSimEndData{});
+
+			model.reset(state);
+			historyLength = 0;
+			serverCall(Packets::S_ON_SIM_BEGIN_ID);
+		}
+	}
+}
+
+template <typename T>
+void Server::serverCall(int32_t packetId, const T& data) {
+	if (!registered) return;
+
+	writeHeader(packetId, ErrorCode::NONE);
+	writeObj(data);
+	publish();
+
+	while (*running && registered) {
+		const int32_t clientPacketId = waitForClient(timeout);
+
+		// The client didn't answer in time. The game just carries on in that case
+		if (clientPacketId == -1) return;
+
+		if (!handleClientCall(clientPacketId)) return;
+	}
+}
+
+void Server::serverCall(int32_t packetId) {
+	serverCall(packetId, int32_t{0});
+}
+
+int32_t Server::waitForClient(int32_t timeout) {
+	// Wake up regularly to notice shutdowns
+	constexpr std::chrono::milliseconds slice{100};
+
+	const std::chrono::steady_clock::time_point deadline =
+	    std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout, 0));
+
+	// Client packet ids all come after the server ones, so our own pending call never matches
+	auto isClientPacket = [](int32_t packetId) { return packetId >= Packets::C_REGISTER_ID; };
+
+	while (!ready.wait(isClientPacket, slice)) {
+		if (!*running) return -1;
+		if ((timeout >= 0) && (std::chrono::steady_clock::now() > deadline)) return -1;
+	}
+
+	ready.consume();
+	cursor.seek(0);
+
+	int32_t packetId;
+	ErrorCode error;
+
+	readObj(packetId);
+	readObj(error);
+
+	return packetId;
+}
+
+bool Server::handleClientCall(int32_t packetId) {
+	++callsServed;
+
+	if (packetId == Packets::C_PROCESSED_CALL_ID) {
+		zero();
+
+		return false;
+	} else if (packetId == Packets::C_REGISTER_ID) {
+		if (registered) {
+			respond(ErrorCode::CLIENT_ALREADY_REGISTERED);
+		} else {
+			registered = true;
+			timeout = settings.timeout;
+
+			serverCall(Packets::S_ON_REGISTERED_ID);
+		}
+	} else if (packetId == Packets::C_DEREGISTER_ID) {
+		registered = false;
+
+		respond();
+	} else if (packetId == Packets::C_SIM_GET_STATE_ID) {
+		writeHeader(Packets::S_RESPONSE_ID, ErrorCode::NONE);
+		writeState();
+		publish();
+	} else if (packetId == Packets::C_SIM_REWIND_TO_STATE_ID) {
+		readState();
+		saveState();
+
+		respond();
+	} else if (packetId == Packets::C_SIM_REWIND_TO_TIME_ID) {
+		SimRewindToTimeData data;
+		readObj(data);
+
+		const size_t tick = data.time / CarModel::TICK_MS;
+
+		if (((data.time % CarModel::TICK_MS) != 0) || (tick >= historyLength) || !saved[tick]) {
+			respond(ErrorCode::NO_SAVED_STATE);
+		} else {
+			state = history[tick];
+			historyLength = tick + 1;
+
+			respond();
+		}
+	} else if (packetId == Packets::C_SET_INPUT_STATES_ID) {
+		SetInputStatesData inputs;
+		readObj(inputs);
+
+		SimStateData& data = state.data;
+
+		if (inputs.left != -1) data.inputLeftState = inputs.left;
+		if (inputs.right != -1) data.inputRightState = inputs.right;
+		if (inputs.up != -1) data.inputAccelerateState = inputs.up;
+		if (inputs.down != -1) data.inputBrakeState = inputs.down;
+		if (inputs.steer != std::numeric_limits<int32_t>::max()) data.inputSteerState = inputs.steer;
+		if (inputs.gas != std::numeric_limits<int32_t>::max()) data.inputGasState = inputs.gas;
+
+		respond();
+	} else if (packetId == Packets::C_SIM_GET_EVENT_BUFFER_ID) {
+		writeHeader(Packets::S_RESPONSE_ID, ErrorCode::NONE);
+		EventBufferView{eventsDuration, {events.data(), events.size()}}.write(*this);
+		publish();
+	} else if (packetId == Packets::C_SIM_SET_EVENT_BUFFER_ID) {
+		const EventBufferView incoming = EventBufferView::read(*this);
+
+		events.assign(incoming.events.begin(), incoming.events.end());
+		std::stable_sort(events.begin(), events.end(),
+		                 [](const InputEvent& lhs, const InputEvent& rhs) { return lhs.time < rhs.time; });
+		eventsDuration = incoming.eventsDuration;
+
+		respond();
+	} else if (packetId == Packets::C_GET_CONTEXT_MODE_ID) {
+		respond(GetContextModeData{ContextMode::SIMULATION});
+	} else if (packetId == Packets::C_GET_CHECKPOINT_STATE_ID) {
+		writeHeader(Packets::S_RESPONSE_ID, ErrorCode::NONE);
+		writeObj(CheckpointData{model.getCheckpointCount(state), 0});
+		writeObj(static_cast<uint32_t>(state.cpStates.size()));
+		for (uint32_t cpState : state.cpStates) writeObj(cpState);
+		writeObj(static_cast<uint32_t>(state.cpTimes.size()));
+		for (const CheckpointTime& cpTime : state.cpTimes) writeObj(cpTime);
+		publish();
+	} else if (packetId == Packets::C_SET_TIMEOUT_ID) {
+		SetTimeoutData data;
+		readObj(data);
+
+		timeout = data.timeout;
+
+		respond();
+	} else {
+		// Everything else is accepted and ignored
+		respond();
+	}
+
+	return true;
+}
+
+template <typename T>
+void Server::respond(const T& data, ErrorCode error) {
+	writeHeader(Packets::S_RESPONSE_ID, error);
+	writeObj(data);
+	publish();
+}
+
+void Server::respond(ErrorCode error) {
+	respond(int32_t{0}, error);
+}
+
+void Server::writeHeader(int32_t packetId, ErrorCode error) {
+	zero();
+
+	writeObj(packetId);
+	writeObj(error);
+}
+
+void Server::writeState() {
+	state.view().write(*this);
+}
+
+void Server::readState() {
+	const SimStateView incoming = SimStateView::read(*this);
+
+	state.assignChunks(incoming, incoming.data->flags);
+}
+
+void Server::saveState() {
+	const size_t tick = CarModel::getTime(state) / CarModel::TICK_MS;
+
+	if (history.size() <= tick) {
+		history.resize(tick + 1);
+		saved.resize(tick + 1, false);
+	}
+
+	// Ticks skipped by a rewind ahead keep nothing from an older trajectory
+	for (size_t i = historyLength; i < tick; ++i) saved[i] = false;
+
+	history[tick] = state;
+	saved[tick] = true;
+	historyLength = tick + 1;
+}
+
+void Server::applyEvents() {
+	const uint32_t time = CarModel::getTime(state);
+
+	auto event = std::lower_bound(events.begin(), events.end(), time,
+	                              [](const InputEvent& event, uint32_t time) { return event.time < time; });
+
+	SimStateData& data = state.data;
+
+	for (; (event != events.end()) && (event->time == time); ++event) {
+		const int32_t value = event->getValue();
+
+		switch (event->getType()) {
+		case InputType::ACCELERATE:
+			data.inputAccelerateState = value;
+			break;
+		case InputType::BRAKE:
+			data.inputBrakeState = value;
+			break;
+		case InputType::STEER:
+			data.inputSteerState = value;
+			break;
+		case InputType::GAS:
+			data.inputGasState = value;
+			break;
+		case InputType::LEFT:
+			data.inputLeftState = value;
+			break;
+		case InputType::RIGHT:
+			data.inputRightState = value;
+			break;
+		default:
+			// The car model can't respawn
+			break;
+		}
+	}
+}
+
+void Server::publish() {
+	ready.publish();
+}
+
+}  // namespace Emulator
@@ -0,0 +1,118 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Emulator/Server.h"
+
+namespace {
+
+std::atomic_bool running{true};
+
+void stop(int) {
+	running = false;
+}
+
+void printUsage(const char* name) {
+	std::cerr << "Usage: " << name << " [options]\n"
+	          << "  --servers <n>        number of TMInterface buffers to create (default: 16)\n"
+	          << "  --first <index>      index of the first buffer (default: 0)\n"
+	          << "  --duration <ms>      simulated time before the simulation restarts (default: 60000)\n"
+	          << "  --timeout <ms>       initial C_PROCESSED_CALL timeout, -1 waits forever (default: 2000)\n"
+	          << "  --no-prefault        don't prefault the mappings\n"
+	          << "  --lock               lock the mappings into memory\n"
+	          << "  --hugepages          try to use huge pages for the mappings\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	size_t servers = TMInterface::MAX_SERVERS;
+	size_t first = 0;
+	TMInterface::Utils::MappingOptions options;
+	Emulator::ServerSettings settings;
+
+	options.create = true;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const bool hasValue = (i + 1) < argc;
+
+		if ((arg == "--servers") && hasValue) {
+			servers = std::strtoul(argv[++i], nullptr, 10);
+		} else if ((arg == "--first") && hasValue) {
+			first = std::strtoul(argv[++i], nullptr, 10);
+		} else if ((arg == "--duration") && hasValue) {
+			settings.simDuration = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		} else if ((arg == "--timeout") && hasValue) {
+			settings.timeout = static_cast<int32_t>(std::strtol(argv[++i], nullptr, 10));
+		} else if (arg == "--no-prefault") {
+			options.prefault = false;
+		} else if (arg == "--lock") {
+			options.lock = true;
+		} else if (arg == "--hugepages") {
+			options.hugePages = true;
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if ((servers == 0) || ((first + servers) > TMInterface::MAX_SERVERS)) {
+		std::cerr << "Servers " << first << " to " << (first + servers) << " out of range 0 to "
+		          << TMInterface::MAX_SERVERS << std::endl;
+		return 1;
+	}
+
+	std::signal(SIGINT, stop);
+	std::signal(SIGTERM, stop);
+
+	std::vector<std::unique_ptr<Emulator::Server>> list;
+	std::vector<std::thread> threads;
+
+	for (size_t i = first; i < (first + servers); ++i) {
+		list.push_back(std::make_unique<Emulator::Server>(i, options, settings));
+
+		if (!*list.back()) return 1;
+	}
+
+	for (std::unique_ptr<Emulator::Server>& server : list) {
+		threads.emplace_back([&server] { server->run(running); });
+	}
+
+	std::cout << "Serving " << list.front()->getName() << " to " << list.back()->getName() << std::endl;
+
+	uint64_t lastSteps = 0;
+	uint64_t lastCalls = 0;
+
+	while (running) {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		uint64_t steps = 0;
+		uint64_t calls = 0;
+
+		for (const std::unique_ptr<Emulator::Server>& server : list) {
+			steps += server->getStepsServed();
+			calls += server->getCallsServed();
+		}
+
+		if ((steps != lastSteps) || (calls != lastCalls)) {
+			std::cout << (steps - lastSteps) << " sims/s, " << (calls - lastCalls) << " calls/s" << std::endl;
+		}
+
+		lastSteps = steps;
+		lastCalls = calls;
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	return 0;
+}
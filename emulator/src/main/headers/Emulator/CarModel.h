@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+
+namespace Emulator {
+
+using TMInterface::Vec3;
+
+struct Track {
+	Vec3 start;
+	float startYaw;
+	// The last checkpoint is the finish
+	std::vector<Vec3> checkpoints;
+	float checkpointRadius;
+
+	static Track getDefault();
+};
+
+// Tiny deterministic stand in for the game physics. It stores its state in the same places the real game does
+// (race time in the timers, physics in state2, inputs in the input fields), so the client can't tell the difference
+// at the protocol level.
+class CarModel {
+public:
+	static constexpr uint32_t TICK_MS = 10;
+
+	// Offsets of the fields inside the state chunks
+	static constexpr size_t TIME_OFFSET = TMInterface::SimStateView::RACE_TIME_OFFSET;
+	static constexpr size_t POSITION_OFFSET = TMInterface::SimStateView::POSITION_OFFSET;
+	static constexpr size_t VELOCITY_OFFSET = TMInterface::SimStateView::VELOCITY_OFFSET;
+	static constexpr size_t YAW_OFFSET = TMInterface::SimStateView::ORIENTATION_OFFSET;
+
+protected:
+	const Track track;
+
+public:
+	CarModel(const Track& track = Track::getDefault());
+
+	void reset(TMInterface::SimState& state) const;
+	// Advances the state by one tick. Returns true if the checkpoint count changed
+	bool step(TMInterface::SimState& state) const;
+
+	uint32_t getCheckpointCount(const TMInterface::SimState& state) const;
+	uint32_t getCheckpointTarget() const;
+
+	static uint32_t getTime(const TMInterface::SimState& state);
+};
+
+}  // namespace Emulator
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CarModel.h"
+#include "TMInterface/Interface.h"
+
+namespace Emulator {
+
+struct ServerSettings {
+	// Simulated game time after which the simulation ends and starts over
+	uint32_t simDuration = 60'000;
+	// How long the server waits for C_PROCESSED_CALL. Negative means forever, like C_SET_TIMEOUT
+	int32_t timeout = 2'000;
+};
+
+// Server side of the TMInterface protocol. Creates the TMInterface<N> buffer and answers client calls the same way
+// the game does, driving CarModel instead of the game
+class Server : public TMInterface::Interface {
+protected:
+	const CarModel model;
+	const ServerSettings settings;
+	int32_t timeout;
+	const std::atomic_bool* running;
+
+	// Everything the game would hand out through C_SIM_GET_STATE
+	TMInterface::SimState state;
+	// Replayed on every simulation, like the game replays its event buffer. Sorted by time
+	std::vector<TMInterface::InputEvent> events;
+	uint32_t eventsDuration;
+	// States of the current simulation by tick, for C_SIM_REWIND_TO_TIME. Only the first historyLength ticks belong to
+	// the current trajectory, the rest is kept to reuse the allocations
+	std::vector<TMInterface::SimState> history;
+	std::vector<bool> saved;
+	size_t historyLength;
+
+	std::atomic<uint64_t> stepsServed;
+	std::atomic<uint64_t> callsServed;
+
+public:
+	Server(size_t index, const TMInterface::Utils::MappingOptions& options, const ServerSettings& settings = {},
+	       const CarModel& model = CarModel{});
+	// Serves a buffer with any name, e.g. a private one for benchmarks
+	Server(const std::string& name, const TMInterface::Utils::MappingOptions& options,
+	       const ServerSettings& settings = {}, const CarModel& model = CarModel{});
+	virtual ~Server();
+
+	void run(const std::atomic_bool& running);
+
+	uint64_t getStepsServed() const;
+	uint64_t getCallsServed() const;
+
+protected:
+	void simulate();
+
+	// Sends a server call and serves client calls until the client answers with C_PROCESSED_CALL
+	template <typename T>
+	void serverCall(int32_t packetId, const T& data);
+	void serverCall(int32_t packetId);
+
+	// Waits until the client put a packet into the buffer. Returns its id or -1 on timeout/shutdown
+	int32_t waitForClient(int32_t timeout);
+	// Handles the client call in the buffer. Returns false if the packet was C_PROCESSED_CALL
+	bool handleClientCall(int32_t packetId);
+
+	template <typename T>
+	void respond(const T& data, TMInterface::ErrorCode error = TMInterface::ErrorCode::NONE);
+	void respond(TMInterface::ErrorCode error = TMInterface::ErrorCode::NONE);
+
+	void writeHeader(int32_t packetId, TMInterface::ErrorCode error);
+	void writeState();
+	void readState();
+	// Saves the state for its time and forgets all later ones, like the game does whenever the timeline changes
+	void saveState();
+	// Applies the events of the current step to the inputs
+	void applyEvents();
+	void publish();
+};
+
+}  // namespace Emulator
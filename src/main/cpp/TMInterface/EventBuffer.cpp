@@ -0,0 +1,29 @@
+#include "TMInterface/EventBuffer.h"
+
+#include "TMInterface/Interface.h"
+
+namespace TMInterface {
+
+EventBufferView::EventBufferView() : eventsDuration(0), events() {}
+
+EventBufferView::EventBufferView(uint32_t eventsDuration, ArrayView<InputEvent> events)
+    : eventsDuration(eventsDuration), events(events) {}
+
+void EventBufferView::write(Interface& interface) const {
+	interface.writeObj(SimEventBufferData{eventsDuration});
+
+	interface.writeObj(static_cast<uint32_t>(events.size));
+	interface.writeArray(events.data, events.size);
+}
+
+EventBufferView EventBufferView::read(Interface& interface) {
+	SimEventBufferData data;
+	uint32_t size;
+
+	interface.readObj(data);
+	interface.readObj(size);
+
+	return EventBufferView{data.eventsDuration, {interface.viewArray<InputEvent>(size), size}};
+}
+
+}  // namespace TMInterface
@@ -0,0 +1,142 @@
+#include "TMInterface/EventLoop.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace TMInterface {
+
+PacketAwaitable::PacketAwaitable(Interface& interface, const Packet* packet) : interface(interface), packet(packet) {}
+
+bool PacketAwaitable::await_ready() const {
+	return (packet == nullptr) && interface.hasPacket();
+}
+
+void PacketAwaitable::await_suspend(std::coroutine_handle<> handle) {
+	if (interface.loop == nullptr) throw std::logic_error(interface.getName() + " isn't attached to an EventLoop");
+
+	if (packet != nullptr) interface.sendPacket(*packet);
+
+	interface.loop->suspend(interface, handle);
+}
+
+Packet* PacketAwaitable::await_resume() {
+	return interface.receivePacket();
+}
+
+EventLoop::EventLoop() : stopped(false) {}
+
+EventLoop::~EventLoop() {
+	// Tasks may still be parked on interfaces. Destroying the tasks destroys their coroutines
+	for (Interface* interface : interfaces) {
+		interface->loop = nullptr;
+		interface->waiter = nullptr;
+	}
+}
+
+void EventLoop::attach(Interface& interface) {
+	if (interface.loop == this) return;
+	if (interface.loop != nullptr) throw std::logic_error(interface.getName() + " is attached to another EventLoop");
+
+	interface.loop = this;
+	interfaces.push_back(&interface);
+}
+
+void EventLoop::detach(Interface& interface) {
+	if (interface.loop != this) return;
+
+	interface.loop = nullptr;
+	interface.waiter = nullptr;
+	interfaces.erase(std::remove(interfaces.begin(), interfaces.end(), &interface), interfaces.end());
+}
+
+void EventLoop::spawn(Utils::Task<void> task) {
+	tasks.push_back(std::move(task));
+	tasks.back().start();
+}
+
+void EventLoop::run() {
+	stopped = false;
+
+	std::chrono::nanoseconds sleep = MIN_SLEEP;
+
+	while (!stopped) {
+		collect();
+
+		if (tasks.empty()) break;
+
+		if (poll() != 0) {
+			sleep = MIN_SLEEP;
+			continue;
+		}
+
+		idle(sleep);
+		sleep = std::min<std::chrono::nanoseconds>(sleep * 2, MAX_SLEEP);
+	}
+}
+
+size_t EventLoop::poll() {
+	size_t resumed = 0;
+
+	// Resuming may attach or detach interfaces, so no iterators
+	for (size_t i = 0; i < interfaces.size(); ++i) {
+		Interface& interface = *interfaces[i];
+
+		if (!interface.waiter || !interface.hasPacket()) continue;
+
+		std::exchange(interface.waiter, nullptr).resume();
+		++resumed;
+	}
+
+	return resumed;
+}
+
+void EventLoop::stop() {
+	stopped = true;
+}
+
+size_t EventLoop::getTaskCount() const {
+	return tasks.size();
+}
+
+void EventLoop::collect() {
+	for (size_t i = 0; i < tasks.size();) {
+		if (!tasks[i].isDone()) {
+			++i;
+			continue;
+		}
+
+		Utils::Task<void> task = std::move(tasks[i]);
+		tasks.erase(tasks.begin() + i);
+
+		task.rethrow();
+	}
+}
+
+void EventLoop::idle(std::chrono::nanoseconds timeout) {
+	// The request sent first is the one most likely to be answered first
+	Interface* oldest = nullptr;
+
+	for (Interface* interface : interfaces) {
+		if (interface->waiter && ((oldest == nullptr) || (interface->waitingSince < oldest->waitingSince))) {
+			oldest = interface;
+		}
+	}
+
+	if (oldest != nullptr) {
+		oldest->waitForPacket(timeout);
+	} else {
+		// Nobody waits on a packet, the tasks are waiting on something else
+		std::this_thread::sleep_for(timeout);
+	}
+}
+
+void EventLoop::suspend(Interface& interface, std::coroutine_handle<> handle) {
+	if (interface.waiter) throw std::logic_error("Only one coroutine can wait on " + interface.getName());
+
+	interface.waiter = handle;
+	interface.waitingSince = std::chrono::steady_clock::now();
+}
+
+}  // namespace TMInterface
@@ -1,23 +1,46 @@
-#include "TmInterface/Interface.h"
+#include "TMInterface/Interface.h"
 
-#include <iostream>
+#include <algorithm>
 #include <sstream>
 
+#include "TMInterface/EventLoop.h"
+#include "TMInterface/PacketTrace.h"
+#include "TMInterface/Utils/Log.h"
+
 namespace TMInterface {
 
-Interface::Interface(const std::string& name, bool printErrors)
-    : name(name), buffer(name, BUF_SIZE, printErrors), bufferOffset(0), registered(false) {}
+Interface::Interface(const std::string& name, bool printErrors, const Utils::MappingOptions& options)
+    : name(name),
+      buffer(name, BUF_SIZE, printErrors, options),
+      ready(buffer.buffer),
+      cursor(buffer.buffer),
+      pendingPacketId(-1),
+      lastError(ErrorCode::NONE),
+      registered(false),
+      loop(nullptr),
+      waiter(nullptr) {}
+
+Interface::Interface(size_t index, bool printErrors, const Utils::MappingOptions& options)
+    : Interface(getNameFromIndex(index), printErrors, options) {}
 
-Interface::Interface(size_t index, bool printErrors) : Interface(getNameFromIndex(index), printErrors) {}
+Interface::~Interface() {
+	if (loop != nullptr) loop->detach(*this);
 
-Interface::~Interface() {}
+	stopRecording();
+}
 
 const std::string& Interface::getName() const {
 	return name;
 }
 
+ErrorCode Interface::getLastError() const {
+	return lastError;
+}
+
 void Interface::sendPacket(const Packet& packet) {
-	std::cout << "Sending packet: " << packet.packetName << std::endl;
+	Utils::log<Utils::LogLevel::DEBUG>("Sending packet: ", packet.packetName);
+
+	if (recorder) finishRecording();
 
 	zero();
 
@@ -26,19 +49,107 @@ void Interface::sendPacket(const Packet& packet) {
 
 	packet.write(*this);
 
+	if (recorder) recorder->recordSent(packet.packetId, cursor.buffer + HEADER_SIZE, cursor.getOffset() - HEADER_SIZE);
+	metrics.onSend(packet.packetId, cursor.getDirtySize());
+
 	// Send packet
-	buffer.buffer[1] = 0xFF;
+	pendingPacketId = packet.packetId;
+	ready.publish();
+}
+
+bool Interface::hasPacket() const {
+	const uint32_t value = ready.load();
+
+	return ((value & Utils::ReadyFlag::READY_MASK) == Utils::ReadyFlag::READY_MASK) &&
+	       (static_cast<int32_t>(value & Utils::ReadyFlag::ID_MASK) != pendingPacketId);
+}
+
+bool Interface::waitForPacket(std::chrono::nanoseconds timeout) {
+	// Our own packet sits in the buffer with the ready byte set until the peer picks it up
+	const int32_t ownPacketId = pendingPacketId;
+
+	return ready.wait([ownPacketId](int32_t packetId) { return packetId != ownPacketId; }, timeout);
+}
+
+Packet* Interface::receivePacket() {
+	Packet* response = nullptr;
+	Packet* packet = readPacket(response);
+
+	if (packet == nullptr) return nullptr;
+
+	finishPacket(packet->callCallbacks(response));
+
+	return packet;
+}
+
+PacketAwaitable Interface::request(const Packet& packet) {
+	return PacketAwaitable{*this, &packet};
+}
+
+PacketAwaitable Interface::receive() {
+	return PacketAwaitable{*this, nullptr};
+}
+
+void Interface::skip(size_t size) {
+	cursor.skip(size);
+}
+
+MetricsSnapshot Interface::getMetrics() const {
+	return metrics.snapshot();
+}
+
+void Interface::resetMetrics() {
+	metrics.reset();
+}
+
+void Interface::startRecording(const std::string& path) {
+	stopRecording();
+
+	recorder = std::make_unique<TraceRecorder>(path);
+}
+
+void Interface::stopRecording() {
+	if (!recorder) return;
+
+	finishRecording();
+	recorder.reset();
+}
+
+bool Interface::isRecording() const {
+	return static_cast<bool>(recorder);
+}
+
+std::vector<std::shared_ptr<Interface>> Interface::getActiveInterfaces(const Utils::MappingOptions& options) {
+	std::vector<std::shared_ptr<Interface>> list{};
+	list.reserve(MAX_SERVERS);
+
+	// Discovery must never create the buffers itself
+	Utils::MappingOptions discoveryOptions = options;
+	discoveryOptions.create = false;
+
+	for (size_t i = 0; i < MAX_SERVERS; ++i) {
+		std::shared_ptr<Interface> interface = std::make_shared<Interface>(i, false, discoveryOptions);
+
+		if (*interface) list.push_back(interface);
+	}
+
+	list.shrink_to_fit();
+	return list;
 }
 
-std::unique_ptr<Packet> Interface::receivePacket() {
-	bufferOffset = 0;
+Packet* Interface::readPacket(Packet*& response) {
+	if (recorder) finishRecording();
 
-	if (buffer.buffer[1] != (char)0xFF) {
+	// The packet we sent last is still in the buffer past what the peer wrote, it mustn't count as read
+	cursor.rewind();
+
+	if (!ready.isReady()) {
 		// TODO throw error, packet not ready to receive!
-		std::cout << "Error! packet not ready to receive" << std::endl;
+		Utils::log<Utils::LogLevel::ERROR>("Packet not ready to receive");
 	}
 
-	buffer.buffer[1] = 0x00;
+	ready.consume();
+	pendingPacketId = -1;
 
 	int32_t packetId;
 	ErrorCode error;
@@ -46,49 +157,53 @@ std::unique_ptr<Packet> Interface::receivePacket() {
 	readObj(packetId);
 	readObj(error);
 
+	lastError = error;
+	metrics.onReceive(packetId);
+
+	if (recorder) recorder->beginReceived(packetId, error);
+
 	if (error != ErrorCode::NONE) {
 		// TODO throw error, error code received
-		std::cout << "Error! " << error << std::endl;
+		Utils::log<Utils::LogLevel::WARNING>("Error code received: ", error);
 	}
 
-	std::unique_ptr<Packet> packet = Packet::getPacketById(packetId);
+	Packet* packet = Packets::emplacePacketById(packetId, receivedPacket);
 
-	std::cout << "Received packet: " << packetId << " -> " << packet->packetName << std::endl;
+	if (packet == nullptr) {
+		// TODO throw error, unknown packet
+		Utils::log<Utils::LogLevel::ERROR>("Unknown packet: ", packetId);
 
-	packet->read(*this);
+		if (recorder) finishRecording();
 
-	// TODO: Only zero the package size
-	zero();
+		zero();
+		return nullptr;
+	}
 
-	std::unique_ptr<Packet> response = packet->callCallbacks(Packet::getPacketById(packet->responsePacketId));
+	Utils::log<Utils::LogLevel::DEBUG>("Received packet: ", packetId, " -> ", packet->packetName);
 
-	if (response != nullptr) {
-		sendPacket(*response);
-	}
+	packet->read(*this);
+
+	// Not zeroed yet, so callbacks can still look at the payload. The next sendPacket takes care of that
+	response = Packets::emplacePacketById(packet->responsePacketId, responsePacket);
 
 	return packet;
 }
 
-std::vector<std::shared_ptr<Interface>> Interface::getActiveInterfaces() {
-	std::vector<std::shared_ptr<Interface>> list{};
-	list.reserve(MAX_SERVERS);
-
-	for (size_t i = 0; i < MAX_SERVERS; ++i) {
-		std::shared_ptr<Interface> interface = std::make_shared<Interface>(i, false);
-
-		if (*interface) list.push_back(interface);
+void Interface::finishPacket(Packet* response) {
+	if (response != nullptr) {
+		sendPacket(*response);
 	}
+}
 
-	list.shrink_to_fit();
-	return list;
+void Interface::zero() {
+	metrics.onZero(cursor.getDirtySize());
+	cursor.zero();
 }
 
-void Interface::zero(size_t amount) {
-	// TODO implement check to prevent already zeroed buffer
-	// Perrformance, not that important
+void Interface::finishRecording() {
+	const size_t end = std::max(cursor.getHighWater(), HEADER_SIZE);
 
-	std::fill_n(buffer.buffer, amount, 0);
-	bufferOffset = 0;
+	recorder->finishReceived(cursor.buffer + HEADER_SIZE, end - HEADER_SIZE);
 }
 
 std::string Interface::getNameFromIndex(size_t index) {
@@ -0,0 +1,156 @@
+#include "TMInterface/Metrics.h"
+
+#include <iomanip>
+
+#include "TMInterface/Packets.h"
+
+namespace TMInterface {
+
+Metrics::Metrics() {
+	reset();
+}
+
+void Metrics::onSend(int32_t packetId, size_t bytes) {
+	const uint64_t now = Utils::CycleClock::now();
+
+	if (lastReceivedId != -1) record(processingTime, lastReceivedId, now - lastReceive);
+
+	++packetsSent;
+	bytesWritten += bytes;
+
+	lastSend = now;
+	lastSentId = packetId;
+	lastReceivedId = -1;
+}
+
+void Metrics::onReceive(int32_t packetId) {
+	const uint64_t now = Utils::CycleClock::now();
+
+	if (lastSentId != -1) record(requestLatency, lastSentId, now - lastSend);
+
+	++packetsReceived;
+	if (packetId == Packets::S_ON_SIM_STEP_ID) ++simSteps;
+
+	lastReceive = now;
+	lastReceivedId = packetId;
+	lastSentId = -1;
+}
+
+void Metrics::onZero(size_t bytes) {
+	bytesZeroed += bytes;
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+	MetricsSnapshot snapshot;
+
+	const Utils::CycleClock::Calibration now = Utils::CycleClock::Calibration::now();
+	const double scale = Utils::CycleClock::Calibration::getScale(start, now);
+
+	snapshot.elapsed = now.time - start.time;
+	snapshot.packetsSent = packetsSent;
+	snapshot.packetsReceived = packetsReceived;
+	snapshot.bytesWritten = bytesWritten;
+	snapshot.bytesZeroed = bytesZeroed;
+	snapshot.simSteps = simSteps;
+
+	const double seconds = std::chrono::duration<double>(snapshot.elapsed).count();
+	snapshot.simsPerSecond = (seconds > 0.0) ? (static_cast<double>(simSteps) / seconds) : 0.0;
+
+	snapshot.requestLatency = summarize(requestLatency, scale);
+	snapshot.processingTime = summarize(processingTime, scale);
+
+	return snapshot;
+}
+
+void Metrics::reset() {
+	for (std::unique_ptr<Utils::Histogram>& histogram : requestLatency) {
+		if (histogram) histogram->reset();
+	}
+
+	for (std::unique_ptr<Utils::Histogram>& histogram : processingTime) {
+		if (histogram) histogram->reset();
+	}
+
+	packetsSent = 0;
+	packetsReceived = 0;
+	bytesWritten = 0;
+	bytesZeroed = 0;
+	simSteps = 0;
+
+	start = Utils::CycleClock::Calibration::now();
+	lastSentId = -1;
+	lastReceivedId = -1;
+}
+
+void Metrics::record(Histograms& histograms, int32_t packetId, uint64_t ticks) {
+	if ((packetId < 0) || (packetId > MAX_PACKET_ID)) return;
+
+	std::unique_ptr<Utils::Histogram>& histogram = histograms[packetId];
+
+	// Only the first packet of every id allocates
+	if (!histogram) histogram = std::make_unique<Utils::Histogram>();
+
+	histogram->record(ticks);
+}
+
+std::vector<LatencySummary> Metrics::summarize(const Histograms& histograms, double scale) {
+	std::vector<LatencySummary> summaries;
+
+	for (int32_t packetId = 0; packetId <= MAX_PACKET_ID; ++packetId) {
+		const Utils::Histogram* histogram = histograms[packetId].get();
+
+		if ((histogram == nullptr) || (histogram->getCount() == 0)) continue;
+
+		const std::unique_ptr<Packet> packet = Packet::getPacketById(packetId);
+
+		LatencySummary summary;
+		summary.packetId = packetId;
+		summary.packetName = packet ? packet->packetName : std::string_view{"UNKNOWN"};
+		auto toNanoseconds = [scale](uint64_t ticks) { return static_cast<uint64_t>(static_cast<double>(ticks) * scale); };
+
+		summary.count = histogram->getCount();
+		summary.mean = histogram->getMean() * scale;
+		summary.min = toNanoseconds(histogram->getMin());
+		summary.p50 = toNanoseconds(histogram->getPercentile(50.0));
+		summary.p90 = toNanoseconds(histogram->getPercentile(90.0));
+		summary.p99 = toNanoseconds(histogram->getPercentile(99.0));
+		summary.p999 = toNanoseconds(histogram->getPercentile(99.9));
+		summary.max = toNanoseconds(histogram->getMax());
+
+		summaries.push_back(summary);
+	}
+
+	return summaries;
+}
+
+std::ostream& operator<<(std::ostream& os, const MetricsSnapshot& snapshot) {
+	const double seconds = std::chrono::duration<double>(snapshot.elapsed).count();
+
+	os << "elapsed " << seconds << "s, sent " << snapshot.packetsSent << ", received " << snapshot.packetsReceived
+	   << ", written " << snapshot.bytesWritten << "B, zeroed " << snapshot.bytesZeroed << "B, "
+	   << snapshot.simSteps << " sim steps (" << snapshot.simsPerSecond << "/s)\n";
+
+	auto table = [&os](const char* title, const std::vector<LatencySummary>& summaries) {
+		os << title << " (us)\n";
+		os << std::left << std::setw(32) << "packet" << std::right << std::setw(10) << "count" << std::setw(10)
+		   << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10)
+		   << "p99.9" << std::setw(10) << "max" << '\n';
+
+		for (const LatencySummary& summary : summaries) {
+			os << std::left << std::setw(32) << summary.packetName << std::right << std::setw(10) << summary.count
+			   << std::fixed << std::setprecision(1) << std::setw(10) << (summary.mean / 1000.0) << std::setw(10)
+			   << (summary.p50 / 1000.0) << std::setw(10) << (summary.p90 / 1000.0) << std::setw(10)
+			   << (summary.p99 / 1000.0) << std::setw(10) << (summary.p999 / 1000.0) << std::setw(10)
+			   << (summary.max / 1000.0) << '\n';
+		}
+
+		os << std::defaultfloat;
+	};
+
+	table("Request latency", snapshot.requestLatency);
+	table("Processing time", snapshot.processingTime);
+
+	return os;
+}
+
+}  // namespace TMInterface
@@ -0,0 +1,142 @@
+#include "TMInterface/PacketTrace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace TMInterface {
+
+constexpr size_t TRACE_ALIGNMENT = 8;
+
+constexpr size_t alignRecord(size_t size) {
+	return (size + TRACE_ALIGNMENT - 1) / TRACE_ALIGNMENT * TRACE_ALIGNMENT;
+}
+
+TraceRecorder::TraceRecorder(const std::string& path)
+    : file(path, true, INITIAL_SIZE),
+      offset(sizeof(TraceFileHeader)),
+      records(0),
+      start(std::chrono::steady_clock::now()),
+      pending(false) {
+	if (!file) throw std::runtime_error("Could not create trace file " + path);
+
+	getFileHeader() = TraceFileHeader{};
+}
+
+TraceRecorder::~TraceRecorder() {
+	// Cut off the unused tail
+	file.resize(offset, false);
+}
+
+void TraceRecorder::recordSent(int32_t packetId, const char* payload, size_t size) {
+	TraceRecordHeader header;
+	header.timestamp = now();
+	header.packetId = packetId;
+	header.payloadSize = static_cast<uint32_t>(size);
+	header.direction = TraceDirection::SENT;
+
+	append(header, payload);
+}
+
+void TraceRecorder::beginReceived(int32_t packetId, ErrorCode error) {
+	pendingHeader = TraceRecordHeader{};
+	pendingHeader.timestamp = now();
+	pendingHeader.packetId = packetId;
+	pendingHeader.error = error;
+	pendingHeader.direction = TraceDirection::RECEIVED;
+
+	pending = true;
+}
+
+void TraceRecorder::finishReceived(const char* payload, size_t size) {
+	if (!pending) return;
+
+	pending = false;
+	pendingHeader.payloadSize = static_cast<uint32_t>(size);
+
+	append(pendingHeader, payload);
+}
+
+bool TraceRecorder::isPending() const {
+	return pending;
+}
+
+size_t TraceRecorder::getRecordCount() const {
+	return records;
+}
+
+size_t TraceRecorder::getLength() const {
+	return offset;
+}
+
+void TraceRecorder::append(const TraceRecordHeader& header, const char* payload) {
+	const size_t recordSize = sizeof(TraceRecordHeader) + alignRecord(header.payloadSize);
+
+	if ((offset + recordSize) > file.size) {
+		if (!file.resize(std::max(file.size * 2, offset + recordSize))) {
+			throw std::runtime_error("Could not grow trace file " + file.getPath());
+		}
+	}
+
+	char* destination = file.data + offset;
+
+	std::memcpy(destination, &header, sizeof(TraceRecordHeader));
+	std::memcpy(destination + sizeof(TraceRecordHeader), payload, header.payloadSize);
+	std::memset(destination + sizeof(TraceRecordHeader) + header.payloadSize, 0,
+	            recordSize - sizeof(TraceRecordHeader) - header.payloadSize);
+
+	offset += recordSize;
+	++records;
+
+	getFileHeader().length = offset - sizeof(TraceFileHeader);
+}
+
+TraceFileHeader& TraceRecorder::getFileHeader() {
+	return *reinterpret_cast<TraceFileHeader*>(file.data);
+}
+
+std::chrono::nanoseconds::rep TraceRecorder::now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TraceReader::TraceReader(const std::string& path) : file(path, false), offset(0), end(0) {
+	if (!file) throw std::runtime_error("Could not open trace file " + path);
+
+	TraceFileHeader header;
+
+	if (file.size >= sizeof(header)) std::memcpy(&header, file.data, sizeof(header));
+
+	if ((file.size < sizeof(header)) || (header.magic != TraceFileHeader::MAGIC)) {
+		throw std::runtime_error(path + " isn't a trace file");
+	}
+
+	if (header.version != TraceFileHeader::VERSION) {
+		throw std::runtime_error(path + " has unsupported trace version " + std::to_string(header.version));
+	}
+
+	end = sizeof(header) + std::min<size_t>(header.length, file.size - sizeof(header));
+
+	rewind();
+}
+
+bool TraceReader::next(Record& record) {
+	if ((offset + sizeof(TraceRecordHeader)) > end) return false;
+
+	std::memcpy(&record.header, file.data + offset, sizeof(TraceRecordHeader));
+
+	const size_t recordSize = sizeof(TraceRecordHeader) + alignRecord(record.header.payloadSize);
+
+	// Truncated record
+	if ((offset + recordSize) > end) return false;
+
+	record.payload = file.data + offset + sizeof(TraceRecordHeader);
+	offset += recordSize;
+
+	return true;
+}
+
+void TraceReader::rewind() {
+	offset = sizeof(TraceFileHeader);
+}
+
+}  // namespace TMInterface
@@ -0,0 +1,159 @@
+#include "TMInterface/SimState.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "TMInterface/Interface.h"
+
+namespace TMInterface {
+
+// Partial reads and writes skip from one chunk to the next
+static_assert(
+    [] {
+	    size_t offset = offsetof(SimStateData, timers);
+
+	    for (const SimStateChunk& chunk : SimStateView::CHUNKS) {
+		    if (chunk.offset != offset) return false;
+
+		    offset += chunk.size;
+	    }
+
+	    return offset == offsetof(SimStateData, numRespawns);
+    }(),
+    "Chunks have to cover everything from timers to numRespawns without gaps");
+
+SimStateView::SimStateView() : data(nullptr), cpStates(), cpTimes() {}
+
+SimStateView::SimStateView(const SimState& state)
+    : data(&state.data),
+      cpStates{state.cpStates.data(), state.cpStates.size()},
+      cpTimes{state.cpTimes.data(), state.cpTimes.size()} {}
+
+bool SimStateView::isValid() const {
+	return data != nullptr;
+}
+
+size_t SimStateView::getSize() const {
+	return sizeof(SimStateData) + sizeof(uint32_t) + (cpStates.size * sizeof(uint32_t)) + sizeof(uint32_t) +
+	       (cpTimes.size * sizeof(CheckpointTime));
+}
+
+int32_t SimStateView::getRaceTime() const {
+	int32_t time;
+	std::memcpy(&time, data->timers.data() + RACE_TIME_OFFSET, sizeof(time));
+
+	return time;
+}
+
+Vec3 SimStateView::getPosition() const {
+	Vec3 position;
+	std::memcpy(&position, data->state2.data() + POSITION_OFFSET, sizeof(position));
+
+	return position;
+}
+
+Vec3 SimStateView::getVelocity() const {
+	Vec3 velocity;
+	std::memcpy(&velocity, data->state2.data() + VELOCITY_OFFSET, sizeof(velocity));
+
+	return velocity;
+}
+
+uint32_t SimStateView::getCheckpointCount() const {
+	return static_cast<uint32_t>(std::count_if(cpStates.begin(), cpStates.end(), [](uint32_t cp) { return cp != 0; }));
+}
+
+uint32_t SimStateView::diffChunks(const SimStateView& other) const {
+	const char* lhs = reinterpret_cast<const char*>(data);
+	const char* rhs = reinterpret_cast<const char*>(other.data);
+
+	uint32_t chunks = 0;
+
+	// memcmp compares whole vectors at a time and stops at the first difference
+	for (const SimStateChunk& chunk : CHUNKS) {
+		if (std::memcmp(lhs + chunk.offset, rhs + chunk.offset, chunk.size) != 0) chunks |= chunk.flag;
+	}
+
+	return chunks;
+}
+
+SimState SimStateView::toOwned() const {
+	return SimState{*data, {cpStates.begin(), cpStates.end()}, {cpTimes.begin(), cpTimes.end()}};
+}
+
+void SimStateView::write(Interface& interface) const {
+	interface.writeObj(*data);
+
+	interface.writeObj(static_cast<uint32_t>(cpStates.size));
+	interface.writeArray(cpStates.data, cpStates.size);
+
+	interface.writeObj(static_cast<uint32_t>(cpTimes.size));
+	interface.writeArray(cpTimes.data, cpTimes.size);
+}
+
+void SimStateView::write(Interface& interface, uint32_t chunks) const {
+	interface.writeObj(data->contextMode);
+	interface.writeObj(data->flags & chunks);
+
+	const char* bytes = reinterpret_cast<const char*>(data);
+
+	for (const SimStateChunk& chunk : CHUNKS) {
+		if (data->flags & chunks & chunk.flag) {
+			interface.writeArray(bytes + chunk.offset, chunk.size);
+		} else {
+			interface.skip(chunk.size);
+		}
+	}
+
+	interface.writeObj(data->numRespawns);
+
+	interface.writeObj(static_cast<uint32_t>(cpStates.size));
+	interface.writeArray(cpStates.data, cpStates.size);
+
+	interface.writeObj(static_cast<uint32_t>(cpTimes.size));
+	interface.writeArray(cpTimes.data, cpTimes.size);
+}
+
+SimStateView SimStateView::read(Interface& interface) {
+	SimStateView view;
+	uint32_t size;
+
+	// contextMode and flags
+	view.data = reinterpret_cast<const SimStateData*>(interface.viewArray<uint32_t>(2));
+
+	for (const SimStateChunk& chunk : CHUNKS) {
+		if (view.data->flags & chunk.flag) {
+			interface.viewArray<char>(chunk.size);
+		} else {
+			interface.skip(chunk.size);
+		}
+	}
+
+	interface.viewArray<uint32_t>(1);  // numRespawns
+
+	interface.readObj(size);
+	view.cpStates = {interface.viewArray<uint32_t>(size), size};
+
+	interface.readObj(size);
+	view.cpTimes = {interface.viewArray<CheckpointTime>(size), size};
+
+	return view;
+}
+
+SimStateView SimState::view() const {
+	return SimStateView{*this};
+}
+
+void SimState::assignChunks(const SimStateView& state, uint32_t flags) {
+	const char* source = reinterpret_cast<const char*>(state.data);
+	char* target = reinterpret_cast<char*>(&data);
+
+	for (const SimStateChunk& chunk : SimStateView::CHUNKS) {
+		if (flags & chunk.flag) std::memcpy(target + chunk.offset, source + chunk.offset, chunk.size);
+	}
+
+	if (state.cpStates.size == cpStates.size()) cpStates.assign(state.cpStates.begin(), state.cpStates.end());
+	if (state.cpTimes.size == cpTimes.size()) cpTimes.assign(state.cpTimes.begin(), state.cpTimes.end());
+}
+
+}  // namespace TMInterface
@@ -0,0 +1,46 @@
+#include "TMInterface/TraceReplayer.h"
+
+namespace TMInterface {
+
+TraceReplayer::TraceReplayer(const std::string& tracePath, const std::string& bufferName)
+    : Interface(bufferName, true, Utils::MappingOptions{true}), reader(tracePath), replayed(0) {}
+
+bool TraceReplayer::loadNext() {
+	TraceReader::Record record;
+
+	do {
+		if (!reader.next(record)) return false;
+	} while (record.header.direction != TraceDirection::RECEIVED);
+
+	zero();
+
+	writeObj(record.header.packetId);
+	writeObj(record.header.error);
+	cursor.writeBytes(record.payload, record.header.payloadSize);
+
+	++replayed;
+	ready.publish();
+
+	return true;
+}
+
+size_t TraceReplayer::replay() {
+	size_t count = 0;
+
+	while (loadNext()) {
+		receivePacket();
+		++count;
+	}
+
+	return count;
+}
+
+void TraceReplayer::rewind() {
+	reader.rewind();
+}
+
+size_t TraceReplayer::getReplayedCount() const {
+	return replayed;
+}
+
+}  // namespace TMInterface
@@ -0,0 +1,76 @@
+#include "TMInterface/Utils/Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace TMInterface {
+namespace Utils {
+
+Histogram::Histogram() {
+	reset();
+}
+
+void Histogram::merge(const Histogram& other) {
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		counts[i] += other.counts[i];
+	}
+
+	total += other.total;
+	sum += other.sum;
+	min = std::min(min, other.min);
+	max = std::max(max, other.max);
+}
+
+void Histogram::reset() {
+	counts.fill(0);
+	total = 0;
+	sum = 0;
+	min = std::numeric_limits<uint64_t>::max();
+	max = 0;
+}
+
+uint64_t Histogram::getCount() const {
+	return total;
+}
+
+uint64_t Histogram::getMin() const {
+	return (total == 0) ? 0 : min;
+}
+
+uint64_t Histogram::getMax() const {
+	return max;
+}
+
+double Histogram::getMean() const {
+	return (total == 0) ? 0.0 : (static_cast<double>(sum) / static_cast<double>(total));
+}
+
+uint64_t Histogram::getPercentile(double percentile) const {
+	if (total == 0) return 0;
+
+	const double clamped = std::clamp(percentile, 0.0, 100.0);
+	const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * total)));
+
+	uint64_t seen = 0;
+
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		seen += counts[i];
+
+		if (seen >= rank) return std::min(getHighestValue(i), max);
+	}
+
+	return max;
+}
+
+uint64_t Histogram::getHighestValue(size_t index) {
+	if (index < (2 * SUB_BUCKETS)) return index;
+
+	const size_t shift = (index / SUB_BUCKETS) - 1;
+	const uint64_t subBucket = index - (shift * SUB_BUCKETS);
+
+	return ((subBucket + 1) << shift) - 1;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
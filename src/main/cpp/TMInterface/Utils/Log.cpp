@@ -0,0 +1,166 @@
+#include "TMInterface/Utils/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace TMInterface {
+namespace Utils {
+
+std::ostream& operator<<(std::ostream& os, LogLevel level) {
+	switch (level) {
+	case LogLevel::TRACE:
+		return os << "TRACE";
+	case LogLevel::DEBUG:
+		return os << "DEBUG";
+	case LogLevel::INFO:
+		return os << "INFO";
+	case LogLevel::WARNING:
+		return os << "WARNING";
+	case LogLevel::ERROR:
+		return os << "ERROR";
+	default:
+		return os << "NONE";
+	}
+}
+
+LogString::LogString(std::string_view string) : length(static_cast<uint8_t>(std::min(string.size(), CAPACITY))) {
+	std::memcpy(characters.data(), string.data(), length);
+}
+
+std::ostream& operator<<(std::ostream& os, const LogString& string) {
+	return os << std::string_view(string.characters.data(), string.length);
+}
+
+Logger& Logger::getInstance() {
+	static Logger instance;
+
+	return instance;
+}
+
+Logger::Logger() : output(&std::cout), level(LogLevel::TRACE), dropped(0), reportedDropped(0), running(true) {
+	thread = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+
+	wakeUp.notify_one();
+	thread.join();
+}
+
+void Logger::setLevel(LogLevel level) {
+	this->level = level;
+}
+
+LogLevel Logger::getLevel() const {
+	return level;
+}
+
+void Logger::setOutput(std::ostream& output) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	this->output = &output;
+}
+
+uint64_t Logger::getDropped() const {
+	return dropped;
+}
+
+size_t Logger::getRingCount() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return rings.size();
+}
+
+void Logger::flush() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	drain();
+	output->flush();
+}
+
+Logger::Ring& Logger::getRing() {
+	// The logger keeps a reference, so records of exited threads still get written
+	thread_local RingOwner owner;
+
+	if (!owner.ring) {
+		owner.ring = std::make_shared<Ring>();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		rings.push_back(owner.ring);
+	}
+
+	return *owner.ring;
+}
+
+Logger::RingOwner::~RingOwner() {
+	if (ring) ring->orphaned.store(true, std::memory_order_release);
+}
+
+void Logger::run() {
+	using namespace std::chrono_literals;
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (running) {
+		if (!drain()) {
+			// Only flush once there's nothing left, so bursts get written in one go
+			output->flush();
+			wakeUp.wait_for(lock, 1ms);
+		}
+	}
+
+	drain();
+	output->flush();
+}
+
+bool Logger::drain() {
+	bool any = false;
+
+	for (size_t i = 0; i < rings.size();) {
+		Ring& ring = *rings[i];
+		// Loaded before head, so once an orphaned ring is written up to head, nothing can follow
+		const bool orphaned = ring.orphaned.load(std::memory_order_acquire);
+		const size_t head = ring.head.load(std::memory_order_acquire);
+		size_t tail = ring.tail.load(std::memory_order_relaxed);
+
+		if (tail != head) {
+			for (; tail != head; ++tail) {
+				const Record& record = ring.records[tail % RING_SIZE];
+
+				*output << '[' << record.level << "] ";
+				record.format(*output, record.arguments.data());
+				*output << '\n';
+			}
+
+			ring.tail.store(head, std::memory_order_release);
+			any = true;
+		}
+
+		if (orphaned) {
+			// Order doesn't matter
+			std::swap(rings[i], rings.back());
+			rings.pop_back();
+		} else {
+			++i;
+		}
+	}
+
+	const uint64_t total = dropped.load(std::memory_order_relaxed);
+
+	if (total != reportedDropped) {
+		*output << '[' << LogLevel::WARNING << "] Dropped " << (total - reportedDropped) << " log messages\n";
+		reportedDropped = total;
+	}
+
+	return any;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
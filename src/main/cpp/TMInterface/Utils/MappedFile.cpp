@@ -0,0 +1,40 @@
+#include "TMInterface/Utils/MappedFile.h"
+
+namespace TMInterface {
+namespace Utils {
+
+MappedFile::MappedFile(const std::string& path, bool writable, size_t size, bool printErrors)
+    : MappedFile(path, writable ? Mode::WRITE : Mode::READ, size, printErrors) {}
+
+MappedFile::MappedFile(const std::string& path, Mode mode, size_t size, bool printErrors)
+    : data(nullptr),
+      size(0),
+      path(path),
+      mode(mode),
+      opened(false),
+#ifdef _WIN32
+      hFile(nullptr),
+      hMapFile(nullptr)
+#else
+      fd(-1)
+#endif
+{
+	opened = open(size, printErrors) && map(printErrors);
+
+	if (!opened) close();
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+const std::string& MappedFile::getPath() const {
+	return path;
+}
+
+bool MappedFile::isWritable() const {
+	return mode == Mode::WRITE;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
@@ -0,0 +1,105 @@
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "TMInterface/Utils/MappedFile.h"
+
+namespace TMInterface {
+namespace Utils {
+
+bool MappedFile::resize(size_t newSize, bool printErrors) {
+	if (!opened || (mode != Mode::WRITE)) return false;
+
+	unmap();
+
+	if (ftruncate(fd, static_cast<off_t>(newSize)) == -1) {
+		if (printErrors) std::cerr << "Could not resize " << path << " (" << std::strerror(errno) << ")." << std::endl;
+
+		// Keep the old mapping usable
+		map(printErrors);
+		return false;
+	}
+
+	size = newSize;
+
+	return map(printErrors);
+}
+
+void MappedFile::flush(bool async) {
+	if ((data != nullptr) && (mode == Mode::WRITE)) msync(data, size, async ? MS_ASYNC : MS_SYNC);
+}
+
+bool MappedFile::open(size_t minimumSize, bool printErrors) {
+	fd = ::open(path.c_str(), (mode == Mode::WRITE) ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+
+	if (fd == -1) {
+		if (printErrors) std::cerr << "Could not open " << path << " (" << std::strerror(errno) << ")." << std::endl;
+		return false;
+	}
+
+	struct stat info;
+
+	if (fstat(fd, &info) == -1) {
+		if (printErrors) std::cerr << "Could not stat " << path << " (" << std::strerror(errno) << ")." << std::endl;
+		return false;
+	}
+
+	size = static_cast<size_t>(info.st_size);
+
+	if ((mode == Mode::WRITE) && (size < minimumSize)) {
+		if (ftruncate(fd, static_cast<off_t>(minimumSize)) == -1) {
+			if (printErrors) std::cerr << "Could not size " << path << " (" << std::strerror(errno) << ")." << std::endl;
+			return false;
+		}
+
+		size = minimumSize;
+	}
+
+	return true;
+}
+
+bool MappedFile::map(bool printErrors) {
+	// Empty files can't be mapped, but are fine otherwise
+	if (size == 0) return true;
+
+	// Private mappings are writable without write access to the file
+	const int protection = (mode == Mode::READ) ? PROT_READ : (PROT_READ | PROT_WRITE);
+	const int flags = (mode == Mode::COPY_ON_WRITE) ? MAP_PRIVATE : MAP_SHARED;
+	void* mapping = mmap(nullptr, size, protection, flags, fd, 0);
+
+	if (mapping == MAP_FAILED) {
+		if (printErrors) std::cerr << "Could not map " << path << " (" << std::strerror(errno) << ")." << std::endl;
+		return false;
+	}
+
+	data = static_cast<char*>(mapping);
+
+	return true;
+}
+
+void MappedFile::unmap() {
+	if (data != nullptr) munmap(data, size);
+
+	data = nullptr;
+}
+
+void MappedFile::close() {
+	unmap();
+
+	if (fd != -1) ::close(fd);
+
+	fd = -1;
+	opened = false;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#endif
@@ -0,0 +1,126 @@
+#ifdef _WIN32
+
+#include <windows.h>
+
+#include <cstdint>
+#include <iostream>
+
+#include "TMInterface/Utils/MappedFile.h"
+
+#undef max
+#undef min
+
+namespace TMInterface {
+namespace Utils {
+
+bool MappedFile::resize(size_t newSize, bool printErrors) {
+	if (!opened || (mode != Mode::WRITE)) return false;
+
+	unmap();
+
+	// Growing happens through CreateFileMapping, shrinking needs the file to be cut. Cutting fails while another
+	// mapping of the file is open, growing doesn't
+	LARGE_INTEGER position;
+	position.QuadPart = static_cast<LONGLONG>(newSize);
+
+	if ((newSize < size) && (!SetFilePointerEx(hFile, position, nullptr, FILE_BEGIN) || !SetEndOfFile(hFile))) {
+		if (printErrors) std::cerr << "Could not resize " << path << " (" << GetLastError() << ")." << std::endl;
+
+		map(printErrors);
+		return false;
+	}
+
+	size = newSize;
+
+	return map(printErrors);
+}
+
+void MappedFile::flush(bool async) {
+	if ((data == nullptr) || (mode != Mode::WRITE)) return;
+
+	FlushViewOfFile(data, size);
+
+	if (!async) FlushFileBuffers(hFile);
+}
+
+bool MappedFile::open(size_t minimumSize, bool printErrors) {
+	const bool writable = mode == Mode::WRITE;
+
+	hFile = CreateFileA(path.c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+	                    FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING,
+	                    FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (hFile == INVALID_HANDLE_VALUE) {
+		hFile = nullptr;
+
+		if (printErrors) std::cerr << "Could not open " << path << " (" << GetLastError() << ")." << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(hFile, &fileSize)) {
+		if (printErrors) std::cerr << "Could not stat " << path << " (" << GetLastError() << ")." << std::endl;
+		return false;
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+
+	// CreateFileMapping grows the file for us
+	if (writable && (size < minimumSize)) size = minimumSize;
+
+	return true;
+}
+
+bool MappedFile::map(bool printErrors) {
+	// Empty files can't be mapped, but are fine otherwise
+	if (size == 0) return true;
+
+	const DWORD protection = (mode == Mode::WRITE) ? PAGE_READWRITE
+	                         : (mode == Mode::COPY_ON_WRITE) ? PAGE_WRITECOPY
+	                                                          : PAGE_READONLY;
+
+	hMapFile = CreateFileMappingA(hFile, nullptr, protection, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+	                              static_cast<DWORD>(size), nullptr);
+
+	if (hMapFile == nullptr) {
+		if (printErrors) std::cerr << "Could not create file mapping for " << path << " (" << GetLastError() << ")."
+		                           << std::endl;
+		return false;
+	}
+
+	const DWORD access = (mode == Mode::WRITE) ? FILE_MAP_WRITE
+	                     : (mode == Mode::COPY_ON_WRITE) ? FILE_MAP_COPY
+	                                                      : FILE_MAP_READ;
+
+	data = reinterpret_cast<char*>(MapViewOfFile(hMapFile, access, 0, 0, size));
+
+	if (data == nullptr) {
+		if (printErrors) std::cerr << "Could not map " << path << " (" << GetLastError() << ")." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::unmap() {
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (hMapFile != nullptr) CloseHandle(hMapFile);
+
+	data = nullptr;
+	hMapFile = nullptr;
+}
+
+void MappedFile::close() {
+	unmap();
+
+	if (hFile != nullptr) CloseHandle(hFile);
+
+	hFile = nullptr;
+	opened = false;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#endif
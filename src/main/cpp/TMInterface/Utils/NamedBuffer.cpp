@@ -1,55 +1,42 @@
 #include "TMInterface/Utils/NamedBuffer.h"
 
-#include <stdio.h>
-#include <windows.h>
-
 #include <algorithm>
-#include <iostream>
-#pragma comment(lib, "user32.lib")
-
-#undef max
-#undef min
 
 namespace TMInterface {
 namespace Utils {
 
-NamedBuffer::NamedBuffer(const std::string& bufferName, size_t buf_size, bool printErrors)
-    : buf_size(buf_size), buffer(nullptr), hMapFile(nullptr) {
-	hMapFile = OpenFileMapping(FILE_MAP_ALL_ACCESS,  // read/write access
-	                           FALSE,                // do not inherit the name
-	                           bufferName.c_str());  // name of mapping object
-
-	if (hMapFile == nullptr) {
-		if (printErrors) std::cerr << "Could not open file mapping object (" << GetLastError() << ")." << std::endl;
-		return;
-	}
-
-	buffer = reinterpret_cast<char*>(MapViewOfFile(hMapFile,             // handle to map object
-	                                               FILE_MAP_ALL_ACCESS,  // read/write permission
-	                                               0, 0, buf_size        // buffer size
-	                                               ));
-
-	if (buffer == nullptr) {
-		if (printErrors) std::cerr << "Could not map view of file (" << GetLastError() << ")." << std::endl;
-
-		CloseHandle(hMapFile);
-
-		return;
+NamedBuffer::NamedBuffer(const std::string& bufferName, size_t buf_size, bool printErrors,
+                         const MappingOptions& options)
+    : buf_size(buf_size),
+      buffer(nullptr),
+      bufferName(bufferName),
+      options(options),
+      mappedSize(0),
+#ifdef _WIN32
+      hMapFile(nullptr)
+#else
+      fd(-1)
+#endif
+{
+	if (map(printErrors)) {
+		zero();
 	}
-
-	zero();
 }
 
 NamedBuffer::~NamedBuffer() {
 	if (buffer != nullptr) {
 		zero();
-
-		UnmapViewOfFile(buffer);
 	}
 
-	if (hMapFile != nullptr) {
-		CloseHandle(hMapFile);
-	}
+	unmap();
+}
+
+const std::string& NamedBuffer::getName() const {
+	return bufferName;
+}
+
+const MappingOptions& NamedBuffer::getOptions() const {
+	return options;
 }
 
 void NamedBuffer::zero() {
@@ -0,0 +1,116 @@
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "TMInterface/Utils/NamedBuffer.h"
+
+namespace TMInterface {
+namespace Utils {
+
+// Transparent huge pages for shmem are PMD sized, 2 MiB on every platform we care about
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+bool NamedBuffer::map(bool printErrors) {
+	// POSIX shared memory names need to start with a slash, but are otherwise identical to the Win32 names
+	const std::string shmName = '/' + bufferName;
+
+	fd = shm_open(shmName.c_str(), options.create ? (O_RDWR | O_CREAT) : O_RDWR, 0600);
+
+	if (fd == -1) {
+		if (printErrors) std::cerr << "Could not open shared memory object (" << std::strerror(errno) << ")." << std::endl;
+		return false;
+	}
+
+	mappedSize = options.hugePages ? ((buf_size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE) : buf_size;
+
+	struct stat info;
+
+	if (fstat(fd, &info) == -1) {
+		if (printErrors) std::cerr << "Could not stat shared memory object (" << std::strerror(errno) << ")." << std::endl;
+
+		unmap();
+		return false;
+	}
+
+	if (options.create && static_cast<size_t>(info.st_size) < mappedSize) {
+		if (ftruncate(fd, static_cast<off_t>(mappedSize)) == -1) {
+			if (printErrors) std::cerr << "Could not size shared memory object (" << std::strerror(errno) << ")." << std::endl;
+
+			unmap();
+			return false;
+		}
+	} else if (static_cast<size_t>(info.st_size) < buf_size) {
+		// The server hasn't sized the object (yet)
+		if (printErrors) std::cerr << "Shared memory object too small (" << info.st_size << " bytes)." << std::endl;
+
+		unmap();
+		return false;
+	} else if (static_cast<size_t>(info.st_size) < mappedSize) {
+		// The creator didn't ask for huge pages, so we can't either
+		mappedSize = buf_size;
+	}
+
+	int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+	if (options.prefault) flags |= MAP_POPULATE;
+#endif
+
+	void* mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, flags, fd, 0);
+
+	if (mapping == MAP_FAILED) {
+		if (printErrors) std::cerr << "Could not map shared memory object (" << std::strerror(errno) << ")." << std::endl;
+
+		unmap();
+		return false;
+	}
+
+	buffer = static_cast<char*>(mapping);
+
+#ifdef MADV_HUGEPAGE
+	// Only has an effect if /sys/kernel/mm/transparent_hugepage/shmem_enabled is set to advise
+	if (options.hugePages) madvise(buffer, mappedSize, MADV_HUGEPAGE);
+#endif
+
+#ifndef MAP_POPULATE
+	if (options.prefault) {
+		const long pageSize = sysconf(_SC_PAGESIZE);
+
+		for (size_t offset = 0; offset < mappedSize; offset += pageSize) {
+			static_cast<volatile char*>(buffer)[offset] = buffer[offset];
+		}
+	}
+#endif
+
+	if (options.lock && mlock(buffer, mappedSize) == -1) {
+		if (printErrors) std::cerr << "Could not lock shared memory object (" << std::strerror(errno) << ")." << std::endl;
+	}
+
+	return true;
+}
+
+void NamedBuffer::unmap() {
+	if (buffer != nullptr) {
+		// munmap also drops the lock
+		munmap(buffer, mappedSize);
+		buffer = nullptr;
+	}
+
+	if (fd != -1) {
+		close(fd);
+		fd = -1;
+
+		if (options.create) shm_unlink(('/' + bufferName).c_str());
+	}
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#endif
@@ -0,0 +1,100 @@
+#ifdef _WIN32
+
+#include <stdio.h>
+#include <windows.h>
+
+#include <iostream>
+
+#include "TMInterface/Utils/NamedBuffer.h"
+#pragma comment(lib, "user32.lib")
+
+#undef max
+#undef min
+
+namespace TMInterface {
+namespace Utils {
+
+bool NamedBuffer::map(bool printErrors) {
+	mappedSize = buf_size;
+
+	if (options.create) {
+		DWORD protection = PAGE_READWRITE | SEC_COMMIT;
+
+		// Large pages need SeLockMemoryPrivilege. Just retry without them if we don't have it
+		if (options.hugePages && GetLargePageMinimum() != 0) {
+			const size_t largePage = GetLargePageMinimum();
+			const size_t largeSize = (buf_size + largePage - 1) / largePage * largePage;
+
+			hMapFile = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, protection | SEC_LARGE_PAGES,
+			                             static_cast<DWORD>(static_cast<uint64_t>(largeSize) >> 32),
+			                             static_cast<DWORD>(largeSize), bufferName.c_str());
+
+			if (hMapFile != nullptr) mappedSize = largeSize;
+		}
+
+		if (hMapFile == nullptr) {
+			hMapFile = CreateFileMapping(INVALID_HANDLE_VALUE,  // use paging file
+			                             nullptr,               // default security
+			                             protection,            // read/write access
+			                             static_cast<DWORD>(static_cast<uint64_t>(buf_size) >> 32),
+			                             static_cast<DWORD>(buf_size),  // buffer size
+			                             bufferName.c_str());           // name of mapping object
+		}
+	} else {
+		hMapFile = OpenFileMapping(FILE_MAP_ALL_ACCESS,  // read/write access
+		                           FALSE,                // do not inherit the name
+		                           bufferName.c_str());  // name of mapping object
+	}
+
+	if (hMapFile == nullptr) {
+		if (printErrors) std::cerr << "Could not open file mapping object (" << GetLastError() << ")." << std::endl;
+		return false;
+	}
+
+	DWORD access = FILE_MAP_ALL_ACCESS;
+	if (mappedSize != buf_size) access |= FILE_MAP_LARGE_PAGES;
+
+	buffer = reinterpret_cast<char*>(MapViewOfFile(hMapFile,         // handle to map object
+	                                               access,           // read/write permission
+	                                               0, 0, mappedSize  // buffer size
+	                                               ));
+
+	if (buffer == nullptr) {
+		if (printErrors) std::cerr << "Could not map view of file (" << GetLastError() << ")." << std::endl;
+
+		CloseHandle(hMapFile);
+		hMapFile = nullptr;
+
+		return false;
+	}
+
+	if (options.prefault) {
+		WIN32_MEMORY_RANGE_ENTRY range{buffer, mappedSize};
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+
+	if (options.lock && !VirtualLock(buffer, mappedSize)) {
+		if (printErrors) std::cerr << "Could not lock view of file (" << GetLastError() << ")." << std::endl;
+	}
+
+	return true;
+}
+
+void NamedBuffer::unmap() {
+	if (buffer != nullptr) {
+		if (options.lock) VirtualUnlock(buffer, mappedSize);
+
+		UnmapViewOfFile(buffer);
+		buffer = nullptr;
+	}
+
+	if (hMapFile != nullptr) {
+		CloseHandle(hMapFile);
+		hMapFile = nullptr;
+	}
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#endif
@@ -0,0 +1,102 @@
+#include "TMInterface/Utils/ReadyFlag.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#undef max
+#undef min
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <climits>
+#endif
+
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace TMInterface {
+namespace Utils {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The ready word has to overlay the packet id");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "The ready word is shared between processes");
+
+// The mapping is page aligned, so the first word always is suitably aligned
+ReadyFlag::ReadyFlag(char* buffer) : word(reinterpret_cast<std::atomic<uint32_t>*>(buffer)) {}
+
+uint32_t ReadyFlag::load() const {
+	return word->load(std::memory_order_acquire);
+}
+
+bool ReadyFlag::isReady() const {
+	return (load() & READY_MASK) == READY_MASK;
+}
+
+void ReadyFlag::publish() {
+	word->fetch_or(READY_MASK, std::memory_order_release);
+
+	wakeAll();
+}
+
+void ReadyFlag::consume() {
+	word->fetch_and(~READY_MASK, std::memory_order_acq_rel);
+}
+
+#ifdef _WIN32
+
+// WaitOnAddress only works inside a single process, so the best we can do is handing our time slice to someone else
+void ReadyFlag::waitOnValue(uint32_t expected, std::chrono::nanoseconds timeout) const {
+	if (word->load(std::memory_order_relaxed) != expected) return;
+
+	if (timeout < std::chrono::milliseconds(1)) {
+		SwitchToThread();
+	} else {
+		Sleep(1);
+	}
+}
+
+void ReadyFlag::wakeAll() {}
+
+#else
+
+void ReadyFlag::waitOnValue(uint32_t expected, std::chrono::nanoseconds timeout) const {
+#ifdef SYS_futex
+	const std::chrono::seconds seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+	const timespec relative{static_cast<time_t>(seconds.count()), static_cast<long>((timeout - seconds).count())};
+
+	// Not FUTEX_PRIVATE_FLAG, the other side lives in another process
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+#else
+	if (word->load(std::memory_order_relaxed) == expected) std::this_thread::sleep_for(timeout);
+#endif
+}
+
+void ReadyFlag::wakeAll() {
+#ifdef SYS_futex
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+#endif
+
+uint32_t ReadyFlag::getSpinCount() {
+	static const uint32_t spinCount = (std::thread::hardware_concurrency() > 1) ? SPIN_COUNT : 0;
+
+	return spinCount;
+}
+
+void ReadyFlag::cpuRelax() {
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
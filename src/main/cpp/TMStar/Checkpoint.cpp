@@ -0,0 +1,371 @@
+#include "TMStar/Checkpoint.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace TMStar {
+
+namespace {
+
+// The append only files grow by at least this much, so they are rarely mapped again
+constexpr size_t GROWTH = size_t{64} << 20;
+
+void applyChanges(const std::vector<Utils::TranspositionTable::Change>& changes, uint64_t* slots) {
+	for (const Utils::TranspositionTable::Change& change : changes) {
+		slots[change.slot] = change.value;
+	}
+}
+
+}  // namespace
+
+void Checkpoint::Snapshot::clear() {
+	nodes.clear();
+	expanded.clear();
+	states.clear();
+	table.clear();
+	tableSlots = 0;
+	statistics.clear();
+	actionCount = 0;
+}
+
+Checkpoint::Checkpoint(const CheckpointSettings& settings)
+    : settings(settings),
+      generation(0),
+      nodeCount(0),
+      stateBytes(0),
+      tableSlots(0),
+      tableImage(NO_IMAGE),
+      pinnedImage(NO_IMAGE),
+      emptyGeneration(0) {
+	tableGenerations.fill(UNKNOWN);
+
+	if (isEnabled()) std::filesystem::create_directories(settings.directory);
+}
+
+Checkpoint::~Checkpoint() {
+	if (writer.valid()) writer.wait();
+}
+
+bool Checkpoint::isEnabled() const {
+	return !settings.directory.empty();
+}
+
+bool Checkpoint::isReady() {
+	if (!writer.valid()) return true;
+	if (writer.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+
+	writer.get();
+
+	return true;
+}
+
+void Checkpoint::wait() {
+	if (writer.valid()) writer.get();
+}
+
+void Checkpoint::write(Snapshot& changes) {
+	wait();
+
+	written.clear();
+	std::swap(written, changes);
+
+	writer = std::async(std::launch::async, [this]() { writeSnapshot(written); });
+}
+
+bool Checkpoint::load(View& view, uint64_t slots) {
+	using Mode = TMInterface::Utils::MappedFile::Mode;
+
+	wait();
+
+	if (!std::filesystem::exists(getPath("manifest"))) return false;
+
+	view.manifestFile = map("manifest", sizeof(Manifest), Mode::READ);
+
+	if (!view.manifestFile) return false;
+
+	const Manifest* manifest = reinterpret_cast<const Manifest*>(view.manifestFile->data);
+
+	if ((manifest->magic != MAGIC) || (manifest->version != VERSION) ||
+	    (view.manifestFile->size != (sizeof(Manifest) + manifest->statisticsSize))) {
+		return false;
+	}
+
+	view.nodesFile = map("nodes", manifest->nodeCount * sizeof(NodeArena::Record), Mode::COPY_ON_WRITE);
+	view.expandedFile = map(getSlotName("expanded", manifest->generation),
+	                        manifest->expandedCount * sizeof(NodeArena::Index), Mode::READ);
+	view.statesFile = map("states", manifest->stateBytes, Mode::READ);
+
+	if (!view.nodesFile || !view.expandedFile || !view.statesFile) return false;
+
+	// Taken with another size, the image is of no use
+	const bool hasImage = (manifest->tableImage < TABLE_IMAGES) && (manifest->tableSlots != 0);
+
+	if (hasImage && (manifest->tableSlots == slots)) {
+		view.tableFile = map(getImageName(manifest->tableImage), slots * sizeof(uint64_t), Mode::COPY_ON_WRITE);
+	}
+
+	view.manifest = manifest;
+	view.nodes = reinterpret_cast<NodeArena::Record*>(view.nodesFile->data);
+	view.expanded = reinterpret_cast<const NodeArena::Index*>(view.expandedFile->data);
+	view.states = reinterpret_cast<const uint8_t*>(view.statesFile->data);
+	view.table = view.tableFile ? reinterpret_cast<uint64_t*>(view.tableFile->data) : nullptr;
+	view.statistics = reinterpret_cast<const uint8_t*>(view.manifestFile->data + sizeof(Manifest));
+
+	// The next snapshot goes on right after this one
+	written.clear();
+	nodesFile.reset();
+	statesFile.reset();
+	generation = manifest->generation;
+	nodeCount = manifest->nodeCount;
+	stateBytes = manifest->stateBytes;
+	expanded.assign(view.expanded, view.expanded + manifest->expandedCount);
+
+	// The other images may be half written
+	for (std::unique_ptr<TMInterface::Utils::MappedFile>& file : tableFiles) {
+		file.reset();
+	}
+
+	tableChanges.clear();
+	tableGenerations.fill(UNKNOWN);
+	tableSlots = slots;
+	tableImage = hasImage ? manifest->tableImage : NO_IMAGE;
+
+	if (view.tableFile) {
+		tableGenerations[tableImage] = generation;
+		pinnedImage = tableImage;
+		emptyGeneration = UNKNOWN;
+	} else {
+		pinnedImage = NO_IMAGE;
+		emptyGeneration = generation;
+	}
+
+	return true;
+}
+
+void Checkpoint::clear() {
+	wait();
+
+	written.clear();
+	nodesFile.reset();
+	statesFile.reset();
+	generation = 0;
+	nodeCount = 0;
+	stateBytes = 0;
+	expanded.clear();
+
+	for (std::unique_ptr<TMInterface::Utils::MappedFile>& file : tableFiles) {
+		file.reset();
+	}
+
+	tableChanges.clear();
+	tableGenerations.fill(UNKNOWN);
+	tableSlots = 0;
+	tableImage = NO_IMAGE;
+	pinnedImage = NO_IMAGE;
+	emptyGeneration = 0;
+
+	if (!isEnabled()) return;
+
+	// The manifest goes first, so a crash in between leaves nothing that looks complete
+	for (const std::string& name : {std::string("manifest"), std::string("nodes"), std::string("states"),
+	                                getSlotName("expanded", 0), getSlotName("expanded", 1), getImageName(0),
+	                                getImageName(1), getImageName(2)}) {
+		std::error_code error;
+		std::filesystem::remove(getPath(name), error);
+	}
+}
+
+void Checkpoint::writeSnapshot(Snapshot& snapshot) {
+	const uint64_t next = generation + 1;
+
+	append(nodesFile, "nodes", nodeCount * sizeof(NodeArena::Record), snapshot.nodes.data(),
+	       snapshot.nodes.size() * sizeof(NodeArena::Record));
+
+	// The last snapshot is complete, so its expansions can go into the records. That is what loading it does as well,
+	// so it doesn't matter if this snapshot never gets done
+	NodeArena::Record* records = reinterpret_cast<NodeArena::Record*>(nodesFile->data);
+
+	for (NodeArena::Index node : expanded) {
+		records[node].state = StateStore::NONE;
+		records[node].flags |= NodeArena::EXPANDED;
+	}
+
+	compacted.clear();
+	StateStore::compactChanges(snapshot.states.data(), snapshot.states.size(), compacted);
+	append(statesFile, "states", stateBytes, compacted.data(), compacted.size());
+
+	writeFile(getSlotName("expanded", next), snapshot.expanded.data(),
+	          snapshot.expanded.size() * sizeof(NodeArena::Index));
+
+	const uint32_t image = writeTable(snapshot, next);
+
+	nodesFile->flush(false);
+	statesFile->flush(false);
+
+	const Manifest manifest{MAGIC,
+	                        VERSION,
+	                        next,
+	                        nodeCount + snapshot.nodes.size(),
+	                        snapshot.expanded.size(),
+	                        stateBytes + compacted.size(),
+	                        (image != NO_IMAGE) ? snapshot.tableSlots : 0,
+	                        image,
+	                        snapshot.actionCount,
+	                        static_cast<uint32_t>(snapshot.statistics.size()),
+	                        0};
+
+	std::vector<uint8_t> bytes(sizeof(Manifest) + snapshot.statistics.size());
+	std::memcpy(bytes.data(), &manifest, sizeof(manifest));
+	std::copy(snapshot.statistics.begin(), snapshot.statistics.end(), bytes.begin() + sizeof(Manifest));
+
+	writeFile("manifest.tmp", bytes.data(), bytes.size());
+	std::filesystem::rename(getPath("manifest.tmp"), getPath("manifest"));
+
+	generation = manifest.generation;
+	nodeCount = manifest.nodeCount;
+	stateBytes = manifest.stateBytes;
+	tableImage = image;
+	expanded.swap(snapshot.expanded);
+	tableChanges.swap(snapshot.table);
+}
+
+uint32_t Checkpoint::writeTable(const Snapshot& snapshot, uint64_t next) {
+	if (snapshot.tableSlots == 0) return NO_IMAGE;
+
+	// Only the changes of this snapshot and the last one are at hand. So the image is brought up to date from one at
+	// most two snapshots old: the image itself, an empty one, or a copy of the last snapshot's image
+	const auto isRecent = [next](uint64_t base) { return (base != UNKNOWN) && ((base + 2) >= next); };
+
+	uint32_t image = NO_IMAGE;
+
+	for (uint32_t candidate = 0; candidate < TABLE_IMAGES; ++candidate) {
+		if ((candidate == tableImage) || (candidate == pinnedImage)) continue;
+
+		const uint64_t base = tableGenerations[candidate];
+
+		if ((image == NO_IMAGE) || (isRecent(base) && (!isRecent(tableGenerations[image]) ||
+		                                               (base > tableGenerations[image])))) {
+			image = candidate;
+		}
+	}
+
+	const std::string path = getPath(getImageName(image));
+	const size_t bytes = snapshot.tableSlots * sizeof(uint64_t);
+	std::unique_ptr<TMInterface::Utils::MappedFile>& file = tableFiles[image];
+	uint64_t base = tableGenerations[image];
+
+	// Until it is complete again
+	tableGenerations[image] = UNKNOWN;
+
+	if (!file || (file->size != bytes)) {
+		file = std::make_unique<TMInterface::Utils::MappedFile>(path, true, bytes);
+		base = UNKNOWN;
+
+		if (!*file || ((file->size != bytes) && !file->resize(bytes))) {
+			throw std::runtime_error("Could not open checkpoint file " + path);
+		}
+	}
+
+	if (!isRecent(base) && isRecent(emptyGeneration)) {
+		// Cutting the file and growing it again zeroes it without writing every page
+		if (!file->resize(0) || !file->resize(bytes)) {
+			throw std::runtime_error("Could not clear checkpoint file " + path);
+		}
+
+		base = emptyGeneration;
+	} else if (!isRecent(base)) {
+		if ((tableImage == NO_IMAGE) || (tableSlots != snapshot.tableSlots)) {
+			throw std::logic_error("No table image to start from");
+		}
+
+		// The search may have the last image mapped, which only ever gets read
+		std::shared_ptr<TMInterface::Utils::MappedFile> last;
+		const TMInterface::Utils::MappedFile* source = tableFiles[tableImage].get();
+
+		if (source == nullptr) {
+			last = map(getImageName(tableImage), bytes, TMInterface::Utils::MappedFile::Mode::READ);
+			source = last.get();
+		}
+
+		if (source == nullptr) throw std::runtime_error("Could not read checkpoint file " + getImageName(tableImage));
+
+		std::memcpy(file->data, source->data, bytes);
+		base = next - 1;
+	}
+
+	uint64_t* slots = reinterpret_cast<uint64_t*>(file->data);
+
+	if ((base + 2) == next) applyChanges(tableChanges, slots);
+	applyChanges(snapshot.table, slots);
+
+	file->flush(false);
+
+	tableGenerations[image] = next;
+	tableSlots = snapshot.tableSlots;
+
+	return image;
+}
+
+void Checkpoint::append(std::unique_ptr<TMInterface::Utils::MappedFile>& file, const std::string& name,
+                        size_t offset, const void* data, size_t size) {
+	const std::string path = getPath(name);
+
+	if (!file) {
+		file = std::make_unique<TMInterface::Utils::MappedFile>(path, true, offset + size + GROWTH);
+
+		if (!*file) throw std::runtime_error("Could not open checkpoint file " + path);
+	}
+
+	if ((offset + size) > file->size) {
+		if (!file->resize(std::max(offset + size + GROWTH, file->size * 2))) {
+			throw std::runtime_error("Could not grow checkpoint file " + path);
+		}
+	}
+
+	if (size != 0) std::memcpy(file->data + offset, data, size);
+}
+
+void Checkpoint::writeFile(const std::string& name, const void* data, size_t size) {
+	const std::string path = getPath(name);
+
+	TMInterface::Utils::MappedFile file(path, true, size);
+
+	// Left over from an older snapshot, which may have been larger
+	if (!file || ((file.size != size) && !file.resize(size))) {
+		throw std::runtime_error("Could not write checkpoint file " + path);
+	}
+
+	if (size == 0) return;
+
+	std::memcpy(file.data, data, size);
+	file.flush(false);
+}
+
+std::shared_ptr<TMInterface::Utils::MappedFile> Checkpoint::map(const std::string& name, size_t size,
+                                                                TMInterface::Utils::MappedFile::Mode mode) {
+	std::shared_ptr<TMInterface::Utils::MappedFile> file =
+	    std::make_shared<TMInterface::Utils::MappedFile>(getPath(name), mode, 0, false);
+
+	if (!*file || (file->size < size)) return nullptr;
+
+	return file;
+}
+
+std::string Checkpoint::getPath(const std::string& name) const {
+	return (std::filesystem::path(settings.directory) / name).string();
+}
+
+std::string Checkpoint::getSlotName(const char* name, uint64_t generation) {
+	return std::string(name) + '.' + std::to_string(generation % 2);
+}
+
+std::string Checkpoint::getImageName(uint32_t image) {
+	return "table." + std::to_string(image);
+}
+
+}  // namespace TMStar
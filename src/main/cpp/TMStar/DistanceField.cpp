@@ -0,0 +1,405 @@
+#include "TMStar/DistanceField.h"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "TMStar/Utils/Hash.h"
+
+namespace TMStar {
+
+using TMInterface::Vec3;
+
+namespace {
+
+struct Grid {
+	Vec3 origin;
+	float cellSize;
+	uint32_t sizeX;
+	uint32_t sizeY;
+	uint32_t sizeZ;
+
+	size_t getCellCount() const {
+		return static_cast<size_t>(sizeX) * sizeY * sizeZ;
+	}
+
+	size_t getCell(uint32_t x, uint32_t y, uint32_t z) const {
+		return (((static_cast<size_t>(z) * sizeY) + y) * sizeX) + x;
+	}
+
+	// First and last cell touched along one axis, clamped to the grid
+	static void getRange(float min, float max, float origin, float cellSize, uint32_t size, uint32_t& first,
+	                     uint32_t& last) {
+		const float low = std::floor((min - origin) / cellSize);
+		const float high = std::floor((max - origin) / cellSize);
+
+		first = static_cast<uint32_t>(std::clamp(low, 0.0f, static_cast<float>(size - 1)));
+		last = static_cast<uint32_t>(std::clamp(high, 0.0f, static_cast<float>(size - 1)));
+	}
+};
+
+constexpr size_t alignOffset(size_t offset) {
+	return (offset + 63) / 64 * 64;
+}
+
+size_t getStepsOffset(uint32_t layers) {
+	return alignOffset(sizeof(DistanceField::FileHeader) + (layers * sizeof(float)));
+}
+
+Grid makeGrid(const TrackDescription& track, float cellSize) {
+	const Box& bounds = track.bounds;
+
+	auto getSize = [cellSize](float min, float max) {
+		return std::max(static_cast<uint32_t>(std::ceil((max - min) / cellSize)), 1u);
+	};
+
+	return Grid{bounds.min, cellSize, getSize(bounds.min.x, bounds.max.x), getSize(bounds.min.y, bounds.max.y),
+	            getSize(bounds.min.z, bounds.max.z)};
+}
+
+std::vector<uint8_t> getDrivableCells(const TrackDescription& track, const Grid& grid) {
+	std::vector<uint8_t> drivable(grid.getCellCount(), track.drivable.empty() ? 1 : 0);
+
+	for (const Box& box : track.drivable) {
+		uint32_t x0, x1, y0, y1, z0, z1;
+		Grid::getRange(box.min.x, box.max.x, grid.origin.x, grid.cellSize, grid.sizeX, x0, x1);
+		Grid::getRange(box.min.y, box.max.y, grid.origin.y, grid.cellSize, grid.sizeY, y0, y1);
+		Grid::getRange(box.min.z, box.max.z, grid.origin.z, grid.cellSize, grid.sizeZ, z0, z1);
+
+		for (uint32_t z = z0; z <= z1; ++z) {
+			for (uint32_t y = y0; y <= y1; ++y) {
+				for (uint32_t x = x0; x <= x1; ++x) {
+					drivable[grid.getCell(x, y, z)] = 1;
+				}
+			}
+		}
+	}
+
+	return drivable;
+}
+
+// Every cell that could be inside the checkpoint
+std::vector<uint32_t> getCheckpointCells(const Vec3& checkpoint, float radius, const Grid& grid) {
+	std::vector<uint32_t> cells;
+
+	uint32_t x0, x1, z0, z1;
+	Grid::getRange(checkpoint.x - radius, checkpoint.x + radius, grid.origin.x, grid.cellSize, grid.sizeX, x0, x1);
+	Grid::getRange(checkpoint.z - radius, checkpoint.z + radius, grid.origin.z, grid.cellSize, grid.sizeZ, z0, z1);
+
+	for (uint32_t z = z0; z <= z1; ++z) {
+		for (uint32_t x = x0; x <= x1; ++x) {
+			// Closest point of the cell to the checkpoint
+			const float minX = grid.origin.x + (static_cast<float>(x) * grid.cellSize);
+			const float minZ = grid.origin.z + (static_cast<float>(z) * grid.cellSize);
+			const float dx = checkpoint.x - std::clamp(checkpoint.x, minX, minX + grid.cellSize);
+			const float dz = checkpoint.z - std::clamp(checkpoint.z, minZ, minZ + grid.cellSize);
+
+			if (((dx * dx) + (dz * dz)) > (radius * radius)) continue;
+
+			// Measured horizontally, so the whole column counts
+			for (uint32_t y = 0; y < grid.sizeY; ++y) {
+				cells.push_back(static_cast<uint32_t>(grid.getCell(x, y, z)));
+			}
+		}
+	}
+
+	return cells;
+}
+
+// Level synchronous BFS. The threads share a frontier and claim cells with a CAS, so every cell is visited once
+void fillSteps(DistanceField::Steps* steps, const Grid& grid, const std::vector<uint8_t>& drivable,
+               const std::vector<uint32_t>& seeds, size_t threadCount) {
+	using Steps = DistanceField::Steps;
+
+	constexpr size_t CHUNK = 256;
+
+	std::fill(steps, steps + grid.getCellCount(), DistanceField::UNREACHABLE);
+
+	std::vector<uint32_t> frontier;
+	// Never reallocates in the barrier's completion, which mustn't throw
+	frontier.reserve(grid.getCellCount());
+
+	for (uint32_t seed : seeds) {
+		if (steps[seed] == 0) continue;
+
+		steps[seed] = 0;
+		frontier.push_back(seed);
+	}
+
+	std::vector<std::vector<uint32_t>> next(threadCount);
+	std::atomic<size_t> position{0};
+	Steps level = 0;
+	bool done = frontier.empty();
+
+	auto advance = [&]() noexcept {
+		frontier.clear();
+
+		for (std::vector<uint32_t>& part : next) {
+			frontier.insert(frontier.end(), part.begin(), part.end());
+			part.clear();
+		}
+
+		position = 0;
+		++level;
+		done = frontier.empty() || (level == (DistanceField::UNREACHABLE - 1));
+	};
+
+	std::barrier sync(static_cast<std::ptrdiff_t>(threadCount), advance);
+
+	auto work = [&](size_t index) {
+		std::vector<uint32_t>& found = next[index];
+
+		while (!done) {
+			const Steps nextLevel = level + 1;
+
+			for (size_t begin; (begin = position.fetch_add(CHUNK, std::memory_order_relaxed)) < frontier.size();) {
+				const size_t end = std::min(begin + CHUNK, frontier.size());
+
+				for (size_t i = begin; i < end; ++i) {
+					const uint32_t cell = frontier[i];
+					const uint32_t x = cell % grid.sizeX;
+					const uint32_t y = (cell / grid.sizeX) % grid.sizeY;
+					const uint32_t z = cell / (grid.sizeX * grid.sizeY);
+
+					for (int32_t dz = -1; dz <= 1; ++dz) {
+						for (int32_t dy = -1; dy <= 1; ++dy) {
+							for (int32_t dx = -1; dx <= 1; ++dx) {
+								const uint32_t nx = x + dx;
+								const uint32_t ny = y + dy;
+								const uint32_t nz = z + dz;
+
+								// Wraps around below 0
+								if ((nx >= grid.sizeX) || (ny >= grid.sizeY) || (nz >= grid.sizeZ)) continue;
+
+								const size_t neighbor = grid.getCell(nx, ny, nz);
+
+								if (!drivable[neighbor]) continue;
+
+								std::atomic_ref<Steps> slot(steps[neighbor]);
+								Steps expected = DistanceField::UNREACHABLE;
+
+								if (slot.load(std::memory_order_relaxed) != expected) continue;
+
+								if (slot.compare_exchange_strong(expected, nextLevel, std::memory_order_relaxed)) {
+									found.push_back(static_cast<uint32_t>(neighbor));
+								}
+							}
+						}
+					}
+				}
+			}
+
+			sync.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (size_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(work, i);
+	}
+
+	work(0);
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+}  // namespace
+
+uint64_t TrackDescription::hash() const {
+	uint64_t result = Utils::hashBytes(checkpoints.data(), checkpoints.size() * sizeof(Vec3));
+
+	result = Utils::hashBytes(&checkpointRadius, sizeof(checkpointRadius), result);
+	result = Utils::hashBytes(&bounds, sizeof(bounds), result);
+	result = Utils::hashBytes(drivable.data(), drivable.size() * sizeof(Box), result);
+
+	return result;
+}
+
+TrackDescription TrackDescription::load(const std::string& path) {
+	std::ifstream file(path);
+
+	if (!file) throw std::runtime_error("Could not read track " + path);
+
+	TrackDescription track;
+	bool hasBounds = false;
+	std::string line;
+
+	for (size_t number = 1; std::getline(file, line); ++number) {
+		line = line.substr(0, line.find('#'));
+
+		std::istringstream stream(line);
+		std::string keyword;
+
+		if (!(stream >> keyword)) continue;
+
+		Box box;
+
+		if (keyword == "radius") {
+			stream >> track.checkpointRadius;
+		} else if (keyword == "checkpoint") {
+			Vec3& checkpoint = track.checkpoints.emplace_back();
+			stream >> checkpoint.x >> checkpoint.y >> checkpoint.z;
+		} else if ((keyword == "bounds") || (keyword == "drivable")) {
+			stream >> box.min.x >> box.min.y >> box.min.z >> box.max.x >> box.max.y >> box.max.z;
+
+			if (keyword == "bounds") {
+				track.bounds = box;
+				hasBounds = true;
+			} else {
+				track.drivable.push_back(box);
+			}
+		} else {
+			stream.setstate(std::ios::failbit);
+		}
+
+		std::string rest;
+
+		if (stream.fail() || (stream >> rest)) {
+			throw std::runtime_error(path + ':' + std::to_string(number) + ": can't read \"" + line + '"');
+		}
+	}
+
+	if (!hasBounds || track.checkpoints.empty()) throw std::runtime_error(path + " needs bounds and checkpoints");
+
+	return track;
+}
+
+DistanceField::DistanceField(const TrackDescription& track, const std::string& cacheDirectory,
+                             const DistanceFieldSettings& settings)
+    : header(nullptr), remaining(nullptr), steps(nullptr), cellCount(0) {
+	if (track.checkpoints.empty()) throw std::invalid_argument("Track has no checkpoints");
+	if (!(settings.cellSize > 0.0f)) throw std::invalid_argument("Cell size has to be positive");
+
+	const std::string path = getCachePath(track, cacheDirectory, settings.cellSize);
+	const uint64_t trackHash = track.hash();
+
+	if (open(path, trackHash, settings.cellSize)) return;
+
+	std::filesystem::create_directories(cacheDirectory);
+	build(track, settings, path);
+
+	if (!open(path, trackHash, settings.cellSize)) throw std::runtime_error("Could not read distance field " + path);
+}
+
+uint32_t DistanceField::getLayerCount() const {
+	return header->layers;
+}
+
+const std::string& DistanceField::getPath() const {
+	return file->getPath();
+}
+
+std::string DistanceField::getCachePath(const TrackDescription& track, const std::string& cacheDirectory,
+                                        float cellSize) {
+	const uint64_t key = Utils::hashBytes(&cellSize, sizeof(cellSize), track.hash());
+
+	std::ostringstream stream;
+	stream << std::hex << std::setfill('0') << std::setw(16) << key << ".tmdf";
+
+	return (std::filesystem::path(cacheDirectory) / stream.str()).string();
+}
+
+bool DistanceField::open(const std::string& path, uint64_t trackHash, float cellSize) {
+	if (!std::filesystem::exists(path)) return false;
+
+	std::unique_ptr<TMInterface::Utils::MappedFile> mapped =
+	    std::make_unique<TMInterface::Utils::MappedFile>(path, false, 0, false);
+
+	if (!*mapped || (mapped->size < sizeof(FileHeader))) return false;
+
+	const FileHeader* candidate = reinterpret_cast<const FileHeader*>(mapped->data);
+
+	// Anything else is an old version, an unfinished build or a hash collision, and gets rebuilt
+	if ((candidate->magic != MAGIC) || (candidate->version != VERSION) || (candidate->trackHash != trackHash) ||
+	    (candidate->cellSize != cellSize)) {
+		return false;
+	}
+
+	const size_t cells = static_cast<size_t>(candidate->sizeX) * candidate->sizeY * candidate->sizeZ;
+
+	if (mapped->size != (getStepsOffset(candidate->layers) + (candidate->layers * cells * sizeof(Steps)))) {
+		return false;
+	}
+
+	file = std::move(mapped);
+	header = candidate;
+	remaining = reinterpret_cast<const float*>(file->data + sizeof(FileHeader));
+	steps = reinterpret_cast<const Steps*>(file->data + getStepsOffset(header->layers));
+	cellCount = cells;
+
+	return true;
+}
+
+void DistanceField::build(const TrackDescription& track, const DistanceFieldSettings& settings,
+                          const std::string& path) {
+	const Grid grid = makeGrid(track, settings.cellSize);
+	const size_t cells = grid.getCellCount();
+	const uint32_t layers = static_cast<uint32_t>(track.checkpoints.size());
+	const size_t threads =
+	    (settings.threads != 0) ? settings.threads : std::max(std::thread::hardware_concurrency(), 1u);
+
+	// Built next to the cache and moved there when done, so no one ever maps a half written field
+	const std::string buildPath = path + ".tmp";
+	std::filesystem::remove(buildPath);
+
+	{
+		const size_t size = getStepsOffset(layers) + (layers * cells * sizeof(Steps));
+		TMInterface::Utils::MappedFile output(buildPath, true, size);
+
+		if (!output) throw std::runtime_error("Could not create distance field " + buildPath);
+
+		float* distances = reinterpret_cast<float*>(output.data + sizeof(FileHeader));
+		Steps* layerSteps = reinterpret_cast<Steps*>(output.data + getStepsOffset(layers));
+
+		const std::vector<uint8_t> drivable = getDrivableCells(track, grid);
+		std::vector<std::vector<uint32_t>> checkpointCells(layers);
+
+		for (uint32_t layer = 0; layer < layers; ++layer) {
+			checkpointCells[layer] = getCheckpointCells(track.checkpoints[layer], track.checkpointRadius, grid);
+
+			fillSteps(layerSteps + (layer * cells), grid, drivable, checkpointCells[layer], threads);
+		}
+
+		// From taking a checkpoint to the finish, through the closest cell of the checkpoint to the next one
+		distances[layers - 1] = 0.0f;
+
+		for (uint32_t layer = layers - 1; layer > 0; --layer) {
+			const Steps* next = layerSteps + (layer * cells);
+			Steps closest = UNREACHABLE;
+
+			for (uint32_t cell : checkpointCells[layer - 1]) {
+				closest = std::min(closest, next[cell]);
+			}
+
+			const float gap = ((closest == UNREACHABLE) || (closest == 0))
+			                      ? 0.0f
+			                      : (static_cast<float>(closest - 1) * settings.cellSize);
+
+			distances[layer - 1] = gap + distances[layer];
+		}
+
+		FileHeader header{0,         VERSION,    track.hash(), grid.origin, grid.cellSize,
+		                  grid.sizeX, grid.sizeY, grid.sizeZ,   layers};
+		std::memcpy(output.data, &header, sizeof(header));
+
+		// The magic goes in last and marks the field as complete
+		output.flush(false);
+		std::memcpy(output.data, &MAGIC, sizeof(MAGIC));
+		output.flush(false);
+	}
+
+	std::filesystem::rename(buildPath, path);
+}
+
+}  // namespace TMStar
@@ -0,0 +1,293 @@
+#include "TMStar/ExternalOpenList.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include "TMInterface/Utils/MappedFile.h"
+#include "TMStar/Utils/Hash.h"
+
+namespace TMStar {
+
+ExternalOpenList::ExternalOpenList(NodeArena& nodes, StateStore& states, const SpillSettings& settings)
+    : nodes(nodes),
+      states(states),
+      settings(settings),
+      prefix(makePrefix()),
+      current(0),
+      count(0),
+      pendingCount(0),
+      nextSpill(settings.minRunEntries),
+      runCount(0),
+      prefetch{0, 0, {}} {
+	if (!isEnabled()) return;
+	if (settings.bucketWidth == 0) throw std::invalid_argument("Bucket width has to be positive");
+
+	std::filesystem::create_directories(settings.directory);
+}
+
+ExternalOpenList::~ExternalOpenList() {
+	clear();
+}
+
+bool ExternalOpenList::isEnabled() const {
+	return !settings.directory.empty();
+}
+
+bool ExternalOpenList::empty() const {
+	return count == 0;
+}
+
+size_t ExternalOpenList::size() const {
+	return count;
+}
+
+void ExternalOpenList::push(Key key, NodeArena::Index node) {
+	++count;
+
+	if (!isEnabled()) {
+		head.push(key, node);
+		return;
+	}
+
+	key = std::max(key, head.getLast());
+
+	const uint32_t bucket = key / settings.bucketWidth;
+
+	if (bucket <= current) {
+		head.push(key, node);
+		return;
+	}
+
+	buckets[bucket].entries.emplace_back(key, node);
+	++pendingCount;
+
+	if ((pendingCount >= nextSpill) && (getMemoryInUse() > settings.memoryBytes)) spill();
+}
+
+ExternalOpenList::Entry ExternalOpenList::pop() {
+	refill();
+
+	const Entry entry = head.pop();
+	--count;
+
+	return entry;
+}
+
+ExternalOpenList::Key ExternalOpenList::topKey() {
+	refill();
+
+	return head.topKey();
+}
+
+void ExternalOpenList::clear() {
+	// The reads have to finish before their files go
+	if (prefetch.data.valid()) prefetch.data.wait();
+	prefetch = Prefetch{0, 0, {}};
+
+	for (const std::pair<const uint32_t, Bucket>& bucket : buckets) {
+		for (const std::string& path : bucket.second.runs) {
+			std::error_code error;
+			std::filesystem::remove(path, error);
+		}
+	}
+
+	head.clear();
+	buckets.clear();
+	current = 0;
+	count = 0;
+	pendingCount = 0;
+	nextSpill = settings.minRunEntries;
+	statistics = Statistics{};
+}
+
+size_t ExternalOpenList::getMemoryUsage() const {
+	size_t bytes = head.getMemoryUsage();
+
+	for (const std::pair<const uint32_t, Bucket>& bucket : buckets) {
+		bytes += bucket.second.entries.capacity() * sizeof(Entry);
+	}
+
+	return bytes;
+}
+
+const ExternalOpenList::Statistics& ExternalOpenList::getStatistics() const {
+	return statistics;
+}
+
+void ExternalOpenList::refill() {
+	if (!head.empty()) return;
+	if (buckets.empty()) throw std::out_of_range("ExternalOpenList is empty");
+
+	load(buckets.begin());
+}
+
+void ExternalOpenList::load(std::map<uint32_t, Bucket>::iterator bucket) {
+	const std::vector<std::string>& runs = bucket->second.runs;
+	size_t first = 0;
+
+	current = bucket->first;
+
+	if (prefetch.data.valid() && (prefetch.bucket == current)) {
+		for (const std::vector<uint8_t>& data : prefetch.data.get()) {
+			readRun(data);
+		}
+
+		first = prefetch.runs;
+		statistics.prefetchedRuns += first;
+	}
+
+	// Spilled after the prefetch started
+	for (size_t i = first; i < runs.size(); ++i) {
+		readRun(readFile(runs[i]));
+	}
+
+	for (const std::string& path : runs) {
+		std::error_code error;
+		std::filesystem::remove(path, error);
+	}
+
+	for (const Entry& entry : bucket->second.entries) {
+		head.push(entry.first, entry.second);
+	}
+
+	pendingCount -= bucket->second.entries.size();
+	buckets.erase(bucket);
+
+	startPrefetch();
+}
+
+void ExternalOpenList::startPrefetch() {
+	// One at a time. If a lower bucket came up in the meantime, the prefetch is still good for later
+	if (prefetch.data.valid() || buckets.empty()) return;
+
+	const std::map<uint32_t, Bucket>::const_iterator next = buckets.begin();
+
+	if (next->second.runs.empty()) return;
+
+	prefetch.bucket = next->first;
+	prefetch.runs = next->second.runs.size();
+	prefetch.data = std::async(std::launch::async, &ExternalOpenList::readFiles, next->second.runs);
+}
+
+void ExternalOpenList::spill() {
+	// Down to three quarters of the budget, so spills come in batches
+	const size_t target = settings.memoryBytes - (settings.memoryBytes / 4);
+
+	for (std::map<uint32_t, Bucket>::reverse_iterator bucket = buckets.rbegin();
+	     (bucket != buckets.rend()) && (getMemoryInUse() > target); ++bucket) {
+		if (bucket->second.entries.size() >= settings.minRunEntries) writeRun(bucket->first, bucket->second);
+	}
+
+	// If that wasn't enough, the buckets have to fill up some more first
+	nextSpill = pendingCount + settings.minRunEntries;
+}
+
+void ExternalOpenList::writeRun(uint32_t index, Bucket& bucket) {
+	std::vector<Entry>& entries = bucket.entries;
+
+	std::sort(entries.begin(), entries.end());
+
+	run.clear();
+
+	for (const Entry& entry : entries) {
+		const StateStore::Handle handle = nodes.getState(entry.second);
+		RunRecord record{entry.first, entry.second, 0};
+
+		if (handle != StateStore::NONE) {
+			states.save(handle, state);
+			record.stateSize = static_cast<uint32_t>(state.size());
+		}
+
+		const size_t offset = run.size();
+		run.resize(offset + sizeof(record) + record.stateSize);
+		std::memcpy(run.data() + offset, &record, sizeof(record));
+
+		if (handle == StateStore::NONE) continue;
+
+		std::memcpy(run.data() + offset + sizeof(record), state.data(), record.stateSize);
+
+		states.release(handle);
+		nodes.setState(entry.second, StateStore::NONE);
+	}
+
+	const std::string path = (std::filesystem::path(settings.directory) /
+	                          (prefix + '-' + std::to_string(index) + '-' + std::to_string(runCount++) + ".run"))
+	                             .string();
+
+	{
+		TMInterface::Utils::MappedFile file(path, true, run.size());
+
+		if (!file) throw std::runtime_error("Could not spill open list to " + path);
+
+		std::memcpy(file.data, run.data(), run.size());
+	}
+
+	bucket.runs.push_back(path);
+
+	++statistics.runs;
+	statistics.spilledEntries += entries.size();
+	statistics.spilledBytes += run.size();
+
+	pendingCount -= entries.size();
+	std::vector<Entry>().swap(entries);
+}
+
+void ExternalOpenList::readRun(const std::vector<uint8_t>& data) {
+	size_t offset = 0;
+
+	while (offset < data.size()) {
+		RunRecord record;
+		std::memcpy(&record, data.data() + offset, sizeof(record));
+		offset += sizeof(record);
+
+		const StateStore::Handle handle =
+		    (record.stateSize == 0) ? StateStore::NONE : states.load(data.data() + offset, record.stateSize);
+		offset += record.stateSize;
+
+		nodes.setState(record.node, handle);
+		head.push(record.key, record.node);
+	}
+}
+
+size_t ExternalOpenList::getMemoryInUse() const {
+	return states.getStatistics().storedBytes + head.getMemoryUsage() + (pendingCount * sizeof(Entry));
+}
+
+std::vector<uint8_t> ExternalOpenList::readFile(const std::string& path) {
+	const TMInterface::Utils::MappedFile file(path, false);
+
+	if (!file) throw std::runtime_error("Could not read spilled open list " + path);
+
+	return std::vector<uint8_t>(file.data, file.data + file.size);
+}
+
+std::vector<std::vector<uint8_t>> ExternalOpenList::readFiles(const std::vector<std::string>& paths) {
+	std::vector<std::vector<uint8_t>> data;
+	data.reserve(paths.size());
+
+	for (const std::string& path : paths) {
+		data.push_back(readFile(path));
+	}
+
+	return data;
+}
+
+std::string ExternalOpenList::makePrefix() {
+	static std::atomic<uint64_t> instances{0};
+
+	const uint64_t time = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+	std::ostringstream stream;
+	stream << "open-" << std::hex << std::setfill('0') << std::setw(16) << Utils::combine(time, instances++);
+
+	return stream.str();
+}
+
+}  // namespace TMStar
@@ -0,0 +1,261 @@
+#include "TMStar/InterfaceSimulator.h"
+
+#include <stdexcept>
+
+#include "TMStar/Utils/Hash.h"
+
+namespace TMStar {
+
+using namespace TMInterface;
+
+InterfaceSimulator::InterfaceSimulator(Interface& interface, const std::vector<Action>& actions,
+                                       const InterfaceSimulatorSettings& settings)
+    : interface(interface),
+      actions(actions),
+      settings(settings),
+      inStep(false),
+      goalReached(false),
+      simEnded(false),
+      serverStateKnown(false),
+      planner(settings.rewindToTime),
+      simulatedTicks(0) {}
+
+uint64_t InterfaceSimulator::getSegmentHash(const Action& action) const {
+	// Field by field, the padding of Action isn't initialized
+	uint64_t hash = Utils::mix(settings.ticksPerAction);
+	hash = Utils::combine(hash, action.accelerate);
+	hash = Utils::combine(hash, action.brake);
+
+	return Utils::combine(hash, static_cast<uint32_t>(action.steer));
+}
+
+const std::vector<InterfaceSimulator::Action>& InterfaceSimulator::getActions() const {
+	return actions;
+}
+
+SimulationOutcome InterfaceSimulator::simulate(const SimStateView& from, const Action& action, SimState& to) {
+	if (!inStep) waitForStep();
+
+	// Held for the whole action, so they can go straight into the state instead of the event buffer
+	const SetInputStatesData inputs{0, 0, action.accelerate ? 1 : 0, action.brake ? 1 : 0, action.steer, 0};
+
+	rewind(from, inputs);
+
+	return run(from, settings.ticksPerAction, to);
+}
+
+SimState InterfaceSimulator::getState() {
+	if (!inStep) waitForStep();
+
+	SimState state;
+	readState(state);
+
+	return state;
+}
+
+void InterfaceSimulator::release() {
+	if (!inStep) return;
+
+	acknowledge(Packets::S_ON_SIM_STEP_ID);
+	inStep = false;
+}
+
+uint64_t InterfaceSimulator::getSimulatedTicks() const {
+	return simulatedTicks;
+}
+
+const RewindStatistics& InterfaceSimulator::getRewindStatistics() const {
+	return planner.getStatistics();
+}
+
+std::vector<InterfaceSimulator::Action> InterfaceSimulator::getDefaultActions() {
+	return {
+	    {true, false, -65536}, {true, false, -32768}, {true, false, 0}, {true, false, 32768}, {true, false, 65536},
+	    {false, false, 0},     {false, true, 0},
+	};
+}
+
+void InterfaceSimulator::rewind(const SimStateView& state, const SetInputStatesData& inputs) {
+	RewindPlan plan = planner.plan(state);
+
+	if (plan.byTime) {
+		Packets::C_SIM_REWIND_TO_TIME packet;
+		packet.data.time = plan.time;
+
+		if (tryCall(packet)) {
+			Packets::C_SET_INPUT_STATES setInputs;
+			setInputs.data = inputs;
+
+			call(setInputs);
+			planner.onRewound(plan);
+			serverStateKnown = false;
+
+			return;
+		}
+
+		planner.onRejected();
+		plan.byTime = false;
+	}
+
+	rewindState.data = *state.data;
+	rewindState.cpStates.assign(state.cpStates.begin(), state.cpStates.end());
+	rewindState.cpTimes.assign(state.cpTimes.begin(), state.cpTimes.end());
+
+	SimStateData& data = rewindState.data;
+
+	data.flags |= HAS_INPUT_STATE;
+	data.inputLeftState = inputs.left;
+	data.inputRightState = inputs.right;
+	data.inputAccelerateState = inputs.up;
+	data.inputBrakeState = inputs.down;
+	data.inputSteerState = inputs.steer;
+	data.inputGasState = inputs.gas;
+
+	rewindToState(rewindState.view());
+	planner.onRewound(plan);
+}
+
+void InterfaceSimulator::rewindToState(const SimStateView& state) {
+	const uint32_t chunks = serverStateKnown ? state.diffChunks(serverState.view()) : HAS_ALL;
+
+	Packets::C_SIM_REWIND_TO_STATE packet;
+	packet.state = state;
+	packet.chunks = chunks;
+
+	call(packet);
+
+	const uint32_t applied = state.data->flags & chunks;
+
+	if (serverStateKnown) {
+		serverState.assignChunks(state, applied);
+	} else if (applied == HAS_ALL) {
+		serverState.data = *state.data;
+		serverState.cpStates.assign(state.cpStates.begin(), state.cpStates.end());
+		serverState.cpTimes.assign(state.cpTimes.begin(), state.cpTimes.end());
+		serverStateKnown = true;
+	}
+}
+
+SimulationOutcome InterfaceSimulator::run(const SimStateView& from, uint32_t ticks, SimState& to) {
+	goalReached = false;
+	simEnded = false;
+
+	// Nothing to do in between, every step is just answered
+	for (uint32_t tick = 0; (tick < ticks) && !goalReached && !simEnded; ++tick) {
+		step();
+	}
+
+	SimulationOutcome outcome;
+
+	// The server already started over, there is nothing sensible to read
+	if (simEnded) {
+		outcome.valid = false;
+
+		return outcome;
+	}
+
+	readState(to);
+
+	outcome.cost = static_cast<uint32_t>(to.view().getRaceTime() - from.getRaceTime());
+	outcome.goal = goalReached;
+
+	return outcome;
+}
+
+void InterfaceSimulator::call(const Packet& packet) {
+	if (!tryCall(packet)) {
+		throw std::runtime_error("Server rejected " + std::string(packet.packetName));
+	}
+}
+
+bool InterfaceSimulator::tryCall(const Packet& packet) {
+	interface.sendPacket(packet);
+
+	const Packet* response = receive();
+
+	if ((response == nullptr) || (response->packetId != Packets::S_RESPONSE_ID)) {
+		throw std::runtime_error("Expected S_RESPONSE to " + std::string(packet.packetName));
+	}
+
+	return interface.getLastError() == ErrorCode::NONE;
+}
+
+void InterfaceSimulator::step() {
+	release();
+	waitForStep();
+
+	++simulatedTicks;
+}
+
+void InterfaceSimulator::waitForStep() {
+	while (true) {
+		Packet* packet = receive();
+
+		if (packet == nullptr) continue;
+
+		switch (packet->packetId) {
+		case Packets::S_ON_SIM_STEP_ID:
+			inStep = true;
+			serverStateKnown = false;
+			planner.onStep(static_cast<Packets::S_ON_SIM_STEP*>(packet)->data.time);
+
+			return;
+		case Packets::S_ON_CHECKPOINT_COUNT_CHANGED_ID: {
+			const CallOnCheckpointCountChangedData& data =
+			    static_cast<Packets::S_ON_CHECKPOINT_COUNT_CHANGED*>(packet)->data;
+
+			goalReached = goalReached || ((data.target != 0) && (data.current >= data.target));
+			break;
+		}
+		case Packets::S_ON_SIM_END_ID:
+			simEnded = true;
+			break;
+		case Packets::S_ON_SIM_BEGIN_ID:
+			planner.clear();
+			break;
+		case Packets::S_SHUTDOWN_ID:
+			throw std::runtime_error("Server shut down");
+		default:
+			break;
+		}
+
+		// S_ON_REGISTERED is answered by the default callback already
+		if ((packet->packetId != Packets::S_RESPONSE_ID) && (packet->packetId != Packets::S_ON_REGISTERED_ID)) {
+			acknowledge(packet->packetId);
+		}
+	}
+}
+
+void InterfaceSimulator::acknowledge(int32_t packetId) {
+	Packets::C_PROCESSED_CALL processed;
+	processed.which = packetId;
+
+	interface.sendPacket(processed);
+}
+
+Packet* InterfaceSimulator::receive() {
+	if (!interface.waitForPacket(settings.timeout)) {
+		throw std::runtime_error("Timed out waiting for " + interface.getName());
+	}
+
+	return interface.receivePacket();
+}
+
+void InterfaceSimulator::readState(SimState& state) {
+	call(Packets::C_SIM_GET_STATE{});
+
+	const SimStateView view = SimStateView::read(interface);
+
+	state.data = *view.data;
+	state.cpStates.assign(view.cpStates.begin(), view.cpStates.end());
+	state.cpTimes.assign(view.cpTimes.begin(), view.cpTimes.end());
+
+	planner.onRead(view);
+
+	serverState.data = *view.data;
+	serverState.cpStates.assign(view.cpStates.begin(), view.cpStates.end());
+	serverState.cpTimes.assign(view.cpTimes.begin(), view.cpTimes.end());
+	serverStateKnown = true;
+}
+
+}  // namespace TMStar
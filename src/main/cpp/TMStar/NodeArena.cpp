@@ -0,0 +1,171 @@
+#include "TMStar/NodeArena.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace TMStar {
+
+NodeArena::NodeArena() : base(nullptr), baseCount(0) {}
+
+NodeArena::Index NodeArena::add(Index parent, uint32_t cost, uint32_t heuristic, Action action,
+                                StateStore::Handle state, uint8_t flags) {
+	if (!freeNodes.empty()) {
+		const Index node = freeNodes.back();
+		freeNodes.pop_back();
+
+		if (node < baseCount) {
+			base[node] = Record{parent, cost, heuristic, state, action, flags, 0};
+
+			return node;
+		}
+
+		const size_t column = node - baseCount;
+
+		parents[column] = parent;
+		costs[column] = cost;
+		heuristics[column] = heuristic;
+		states[column] = state;
+		actions[column] = action;
+		this->flags[column] = flags;
+
+		return node;
+	}
+
+	if (size() >= NONE) throw std::length_error("NodeArena is full");
+
+	parents.push_back(parent);
+	costs.push_back(cost);
+	heuristics.push_back(heuristic);
+	states.push_back(state);
+	actions.push_back(action);
+	this->flags.push_back(flags);
+
+	return static_cast<Index>(size() - 1);
+}
+
+void NodeArena::remove(Index node) {
+	if (node < baseCount) {
+		base[node].parent = NONE;
+		base[node].state = StateStore::NONE;
+		base[node].flags = 0;
+	} else {
+		parents[node - baseCount] = NONE;
+		states[node - baseCount] = StateStore::NONE;
+		flags[node - baseCount] = 0;
+	}
+
+	freeNodes.push_back(node);
+}
+
+void NodeArena::reserve(size_t count) {
+	count -= std::min(count, baseCount);
+
+	parents.reserve(count);
+	costs.reserve(count);
+	heuristics.reserve(count);
+	states.reserve(count);
+	actions.reserve(count);
+	flags.reserve(count);
+}
+
+void NodeArena::clear() {
+	base = nullptr;
+	baseCount = 0;
+	baseOwner.reset();
+
+	parents.clear();
+	costs.clear();
+	heuristics.clear();
+	states.clear();
+	actions.clear();
+	flags.clear();
+	freeNodes.clear();
+}
+
+void NodeArena::attach(Record* records, size_t count, std::shared_ptr<void> owner) {
+	if (size() != 0) throw std::logic_error("Records can only be attached to an empty arena");
+	if (count >= NONE) throw std::length_error("NodeArena is full");
+
+	base = records;
+	baseCount = count;
+	baseOwner = std::move(owner);
+}
+
+size_t NodeArena::size() const {
+	return baseCount + parents.size();
+}
+
+size_t NodeArena::getLiveCount() const {
+	return size() - freeNodes.size();
+}
+
+size_t NodeArena::getCapacity() const {
+	return baseCount + parents.capacity();
+}
+
+size_t NodeArena::getMemoryUsage() const {
+	return (baseCount * sizeof(Record)) + (parents.capacity() * BYTES_PER_NODE) +
+	       (freeNodes.capacity() * sizeof(Index));
+}
+
+NodeArena::Index NodeArena::getParent(Index node) const {
+	return (node < baseCount) ? base[node].parent : parents[node - baseCount];
+}
+
+uint32_t NodeArena::getCost(Index node) const {
+	return (node < baseCount) ? base[node].cost : costs[node - baseCount];
+}
+
+uint32_t NodeArena::getHeuristic(Index node) const {
+	return (node < baseCount) ? base[node].heuristic : heuristics[node - baseCount];
+}
+
+uint32_t NodeArena::getEstimate(Index node) const {
+	const uint64_t estimate = static_cast<uint64_t>(getCost(node)) + getHeuristic(node);
+
+	return static_cast<uint32_t>(std::min<uint64_t>(estimate, std::numeric_limits<uint32_t>::max()));
+}
+
+NodeArena::Action NodeArena::getAction(Index node) const {
+	return (node < baseCount) ? base[node].action : actions[node - baseCount];
+}
+
+StateStore::Handle NodeArena::getState(Index node) const {
+	return (node < baseCount) ? base[node].state : states[node - baseCount];
+}
+
+bool NodeArena::hasFlag(Index node, Flags flag) const {
+	return (((node < baseCount) ? base[node].flags : flags[node - baseCount]) & flag) != 0;
+}
+
+void NodeArena::setState(Index node, StateStore::Handle state) {
+	((node < baseCount) ? base[node].state : states[node - baseCount]) = state;
+}
+
+void NodeArena::setFlag(Index node, Flags flag) {
+	((node < baseCount) ? base[node].flags : flags[node - baseCount]) |= flag;
+}
+
+NodeArena::Record NodeArena::getRecord(Index node) const {
+	if (node < baseCount) return base[node];
+
+	const size_t column = node - baseCount;
+
+	return Record{parents[column], costs[column], heuristics[column], states[column],
+	              actions[column], flags[column], 0};
+}
+
+std::vector<NodeArena::Action> NodeArena::getPath(Index node) const {
+	std::vector<Action> path;
+
+	for (; (node != NONE) && (getParent(node) != NONE); node = getParent(node)) {
+		path.push_back(getAction(node));
+	}
+
+	std::reverse(path.begin(), path.end());
+
+	return path;
+}
+
+}  // namespace TMStar
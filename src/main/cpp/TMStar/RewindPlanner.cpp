@@ -0,0 +1,81 @@
+#include "TMStar/RewindPlanner.h"
+
+#include "TMStar/StateHash.h"
+
+namespace TMStar {
+
+using namespace TMInterface;
+
+RewindPlanner::RewindPlanner(bool enabled)
+    : timeOffset(0), offsetKnown(false), currentTime(0), enabled(enabled), statistics() {}
+
+RewindPlan RewindPlanner::plan(const SimStateView& state) const {
+	RewindPlan plan{false, 0, hashState(state)};
+
+	// Without the offset the time of a state is unknown, and so is whether it was ever saved
+	if (!offsetKnown) return plan;
+
+	plan.time = static_cast<uint32_t>(state.getRaceTime() + timeOffset);
+
+	if (enabled) {
+		const std::map<uint32_t, uint64_t>::const_iterator saved = trajectory.find(plan.time);
+
+		plan.byTime = (saved != trajectory.end()) && (saved->second == plan.hash);
+	}
+
+	return plan;
+}
+
+void RewindPlanner::onStep(uint32_t time) {
+	currentTime = time;
+
+	// What was saved at this time before belongs to another trajectory
+	truncate(time);
+	trajectory.erase(time);
+}
+
+void RewindPlanner::onRead(const SimStateView& state) {
+	timeOffset = static_cast<int64_t>(currentTime) - state.getRaceTime();
+	offsetKnown = true;
+
+	trajectory[currentTime] = hashState(state);
+}
+
+void RewindPlanner::onRewound(const RewindPlan& plan) {
+	if (plan.byTime) {
+		++statistics.timeRewinds;
+	} else {
+		++statistics.stateRewinds;
+	}
+
+	if (!offsetKnown) return;
+
+	truncate(plan.time);
+	trajectory[plan.time] = plan.hash;
+}
+
+void RewindPlanner::onRejected() {
+	++statistics.rejected;
+
+	if (statistics.timeRewinds == 0) enabled = false;
+
+	trajectory.clear();
+}
+
+void RewindPlanner::clear() {
+	trajectory.clear();
+}
+
+bool RewindPlanner::isEnabled() const {
+	return enabled;
+}
+
+const RewindStatistics& RewindPlanner::getStatistics() const {
+	return statistics;
+}
+
+void RewindPlanner::truncate(uint32_t time) {
+	trajectory.erase(trajectory.upper_bound(time), trajectory.end());
+}
+
+}  // namespace TMStar
@@ -0,0 +1,273 @@
+#include "TMStar/SimulationCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#include "TMStar/StateStore.h"
+#include "TMStar/Utils/Hash.h"
+
+namespace TMStar {
+
+namespace {
+
+// The data file grows by at least this much, so it is rarely mapped again
+constexpr size_t GROWTH = size_t{64} << 20;
+
+}  // namespace
+
+SimulationCache::SimulationCache(const std::string& directory, size_t initialSlots) : directory(directory) {
+	std::filesystem::create_directories(directory);
+
+	if (open()) return;
+
+	// Power of two, so the slot is just the lower bits of the key
+	size_t slotCount = 1;
+	while (slotCount < initialSlots) slotCount *= 2;
+
+	create(slotCount);
+}
+
+SimulationCache::~SimulationCache() {
+	flush();
+}
+
+uint64_t SimulationCache::getKey(const std::vector<uint8_t>& from, uint64_t segment) {
+	return Utils::combine(Utils::hashBytes(from.data(), from.size()), segment);
+}
+
+bool SimulationCache::find(uint64_t key, const std::vector<uint8_t>& from, SimulationOutcome& outcome,
+                           TMInterface::SimState& to) {
+	const Slot& slot = findSlot(key);
+	const Record* record = (slot.offset != 0) ? getRecord(slot.offset, key) : nullptr;
+
+	if ((record == nullptr) || (record->parentSize != from.size())) {
+		++statistics.misses;
+
+		return false;
+	}
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(record) + sizeof(Record);
+
+	if (record->delta) {
+		result = from;
+		StateStore::applyDelta(bytes, record->encodedSize, result.data());
+	} else {
+		result.assign(bytes, bytes + record->encodedSize);
+	}
+
+	StateStore::deserialize(result, to);
+
+	outcome.cost = record->cost;
+	outcome.goal = record->goal != 0;
+	outcome.valid = record->valid != 0;
+
+	++statistics.hits;
+
+	return true;
+}
+
+void SimulationCache::insert(uint64_t key, const std::vector<uint8_t>& from, const SimulationOutcome& outcome,
+                             const TMInterface::SimStateView& to) {
+	StateStore::serialize(to, result);
+
+	Record record{key,
+	              static_cast<uint32_t>(from.size()),
+	              static_cast<uint32_t>(result.size()),
+	              static_cast<uint32_t>(result.size()),
+	              outcome.cost,
+	              static_cast<uint8_t>(outcome.goal),
+	              static_cast<uint8_t>(outcome.valid),
+	              0,
+	              0};
+
+	// The delta needs room for a few bytes past its capacity
+	encoded.resize(result.size() + 8);
+
+	if (result.size() == from.size()) {
+		const size_t encodedSize = StateStore::encodeDelta(result.data(), from.data(), result.size(), encoded.data(),
+		                                                   result.size() / 2);
+
+		// Nothing changed at all is an empty delta as well
+		if ((encodedSize != 0) || (result == from)) {
+			record.delta = 1;
+			record.encodedSize = static_cast<uint32_t>(encodedSize);
+		}
+	}
+
+	const uint8_t* bytes = record.delta ? encoded.data() : result.data();
+	const size_t offset = getHeader().dataBytes;
+	// Records stay 8 byte aligned
+	const size_t end = (offset + sizeof(Record) + record.encodedSize + 7) & ~size_t{7};
+
+	if ((end > data->size) && !data->resize(std::max(end + GROWTH, data->size * 2))) {
+		throw std::runtime_error("Could not grow " + data->getPath());
+	}
+
+	// The record goes in first, the slot only points to it once it is complete
+	std::memcpy(data->data + offset, &record, sizeof(Record));
+	std::memcpy(data->data + offset + sizeof(Record), bytes, record.encodedSize);
+
+	if (((getHeader().count + 1) * 2) > getHeader().slotCount) grow();
+
+	Slot& slot = findSlot(key);
+
+	// A slot can point to a record that was lost in a crash, it is taken over
+	if (slot.offset == 0) ++getHeader().count;
+
+	slot.key = key;
+	slot.offset = offset;
+	getHeader().dataBytes = end;
+
+	++statistics.inserts;
+	statistics.entries = getHeader().count;
+	statistics.dataBytes = getHeader().dataBytes;
+}
+
+void SimulationCache::flush(bool async) {
+	data->flush(async);
+	index->flush(async);
+}
+
+const SimulationCache::Statistics& SimulationCache::getStatistics() const {
+	return statistics;
+}
+
+bool SimulationCache::open() {
+	const std::string indexPath = getPath("index");
+	const std::string dataPath = getPath("data");
+
+	if (!std::filesystem::exists(indexPath) || !std::filesystem::exists(dataPath)) return false;
+
+	std::unique_ptr<TMInterface::Utils::MappedFile> indexFile =
+	    std::make_unique<TMInterface::Utils::MappedFile>(indexPath, true, 0, false);
+	std::unique_ptr<TMInterface::Utils::MappedFile> dataFile =
+	    std::make_unique<TMInterface::Utils::MappedFile>(dataPath, true, 0, false);
+
+	if (!*indexFile || !*dataFile || (indexFile->size < sizeof(IndexHeader)) ||
+	    (dataFile->size < sizeof(DataHeader))) {
+		return false;
+	}
+
+	const IndexHeader* header = reinterpret_cast<const IndexHeader*>(indexFile->data);
+	const DataHeader* dataHeader = reinterpret_cast<const DataHeader*>(dataFile->data);
+
+	if ((header->magic != MAGIC) || (header->version != VERSION) || (dataHeader->magic != MAGIC) ||
+	    (dataHeader->version != VERSION) ||
+	    (indexFile->size != (sizeof(IndexHeader) + (header->slotCount * sizeof(Slot)))) ||
+	    (dataFile->size < header->dataBytes)) {
+		return false;
+	}
+
+	index = std::move(indexFile);
+	data = std::move(dataFile);
+	statistics.entries = header->count;
+	statistics.dataBytes = header->dataBytes;
+
+	return true;
+}
+
+void SimulationCache::create(size_t slotCount) {
+	index.reset();
+	data.reset();
+
+	for (const char* name : {"index", "data"}) {
+		std::error_code error;
+		std::filesystem::remove(getPath(name), error);
+	}
+
+	index = std::make_unique<TMInterface::Utils::MappedFile>(getPath("index"), true,
+	                                                         sizeof(IndexHeader) + (slotCount * sizeof(Slot)));
+	data = std::make_unique<TMInterface::Utils::MappedFile>(getPath("data"), true, GROWTH);
+
+	if (!*index || !*data) throw std::runtime_error("Could not create simulation cache in " + directory);
+
+	const DataHeader dataHeader{MAGIC, VERSION};
+	std::memcpy(data->data, &dataHeader, sizeof(dataHeader));
+
+	// New files are all zeros, so every slot is empty. The magic goes in last and marks the cache as complete
+	const IndexHeader header{0, VERSION, slotCount, 0, sizeof(DataHeader)};
+	std::memcpy(index->data, &header, sizeof(header));
+	getHeader().magic = MAGIC;
+
+	statistics.entries = 0;
+	statistics.dataBytes = header.dataBytes;
+}
+
+void SimulationCache::grow() {
+	const IndexHeader& header = getHeader();
+	const std::string path = getPath("index");
+	const std::string buildPath = path + ".tmp";
+
+	std::filesystem::remove(buildPath);
+
+	{
+		const uint64_t slotCount = header.slotCount * 2;
+		TMInterface::Utils::MappedFile grown(buildPath, true, sizeof(IndexHeader) + (slotCount * sizeof(Slot)));
+
+		if (!grown) throw std::runtime_error("Could not grow " + path);
+
+		const IndexHeader grownHeader{MAGIC, VERSION, slotCount, header.count, header.dataBytes};
+		std::memcpy(grown.data, &grownHeader, sizeof(grownHeader));
+
+		Slot* slots = reinterpret_cast<Slot*>(grown.data + sizeof(IndexHeader));
+		const Slot* oldSlots = getSlots();
+
+		for (uint64_t i = 0; i < header.slotCount; ++i) {
+			if (oldSlots[i].offset == 0) continue;
+
+			uint64_t position = oldSlots[i].key & (slotCount - 1);
+			while (slots[position].offset != 0) position = (position + 1) & (slotCount - 1);
+
+			slots[position] = oldSlots[i];
+		}
+
+		grown.flush(false);
+	}
+
+	// The files can't be replaced while they are mapped on Windows
+	index.reset();
+	std::filesystem::rename(buildPath, path);
+	index = std::make_unique<TMInterface::Utils::MappedFile>(path, true);
+
+	if (!*index) throw std::runtime_error("Could not open " + path);
+}
+
+SimulationCache::IndexHeader& SimulationCache::getHeader() const {
+	return *reinterpret_cast<IndexHeader*>(index->data);
+}
+
+SimulationCache::Slot* SimulationCache::getSlots() const {
+	return reinterpret_cast<Slot*>(index->data + sizeof(IndexHeader));
+}
+
+SimulationCache::Slot& SimulationCache::findSlot(uint64_t key) const {
+	const uint64_t mask = getHeader().slotCount - 1;
+	Slot* slots = getSlots();
+
+	// Linear probing, the index is at most half full
+	uint64_t position = key & mask;
+	while ((slots[position].offset != 0) && (slots[position].key != key)) position = (position + 1) & mask;
+
+	return slots[position];
+}
+
+const SimulationCache::Record* SimulationCache::getRecord(uint64_t offset, uint64_t key) const {
+	if ((offset + sizeof(Record)) > getHeader().dataBytes) return nullptr;
+
+	const Record* record = reinterpret_cast<const Record*>(data->data + offset);
+
+	if ((record->key != key) || ((offset + sizeof(Record) + record->encodedSize) > getHeader().dataBytes)) {
+		return nullptr;
+	}
+
+	return record;
+}
+
+std::string SimulationCache::getPath(const std::string& name) const {
+	return (std::filesystem::path(directory) / name).string();
+}
+
+}  // namespace TMStar
@@ -0,0 +1,45 @@
+#include "TMStar/StateHash.h"
+
+#include <cstring>
+
+#include "TMStar/Utils/Hash.h"
+
+namespace TMStar {
+
+uint64_t hashState(const TMInterface::SimStateView& state) {
+	uint64_t hash = Utils::hashBytes(state.data, sizeof(TMInterface::SimStateData));
+
+	hash = Utils::hashBytes(state.cpStates.data, state.cpStates.size * sizeof(uint32_t), hash);
+	hash = Utils::hashBytes(state.cpTimes.data, state.cpTimes.size * sizeof(TMInterface::CheckpointTime), hash);
+
+	return hash;
+}
+
+StateQuantizer::StateQuantizer(const QuantizationSettings& settings) : scales{} {
+	for (size_t i = 0; i < 3; ++i) {
+		scales[i] = 1.0f / settings.position;
+		scales[3 + i] = 1.0f / settings.velocity;
+	}
+
+	for (size_t i = 0; i < ORIENTATION_VALUES; ++i) {
+		scales[6 + i] = 1.0f / settings.orientation;
+	}
+}
+
+uint64_t StateQuantizer::hash(const TMInterface::SimStateView& state) const {
+	using TMInterface::SimStateView;
+
+	const unsigned char* physics = state.data->state2.data();
+
+	// The padding has a scale of 0, so it's always 0
+	float values[VALUES] = {};
+	std::memcpy(values, physics + SimStateView::POSITION_OFFSET, 3 * sizeof(float));
+	std::memcpy(values + 3, physics + SimStateView::VELOCITY_OFFSET, 3 * sizeof(float));
+	std::memcpy(values + 6, physics + SimStateView::ORIENTATION_OFFSET, ORIENTATION_VALUES * sizeof(float));
+
+	const uint64_t checkpoints = Utils::hashBytes(state.cpStates.data, state.cpStates.size * sizeof(uint32_t));
+
+	return Utils::hashQuantized(values, scales.data(), VALUES, checkpoints);
+}
+
+}  // namespace TMStar
@@ -0,0 +1,591 @@
+#include "TMStar/StateStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "TMStar/Utils/Hash.h"
+
+namespace TMStar {
+
+namespace {
+
+size_t writeVarint(uint32_t value, uint8_t* out) {
+	size_t length = 0;
+
+	while (value >= 0x80) {
+		out[length++] = static_cast<uint8_t>(value | 0x80);
+		value >>= 7;
+	}
+
+	out[length++] = static_cast<uint8_t>(value);
+
+	return length;
+}
+
+uint32_t readVarint(const uint8_t* data, size_t& offset) {
+	uint32_t value = 0;
+	uint32_t shift = 0;
+
+	while (data[offset] & 0x80) {
+		value |= static_cast<uint32_t>(data[offset++] & 0x7F) << shift;
+		shift += 7;
+	}
+
+	return value | (static_cast<uint32_t>(data[offset++]) << shift);
+}
+
+}  // namespace
+
+StateStore::StateStore() : payloadBytes(0), tracking(false), parentScratchHandle(NONE) {}
+
+StateStore::Handle StateStore::insert(const TMInterface::SimStateView& state, Handle parent) {
+	serialize(state, scratch);
+
+	const Entry* parentEntry = nullptr;
+
+	if (parent != NONE) {
+		parentEntry = &entries.at(parent);
+
+		if (parent != parentScratchHandle) {
+			serialize(parent, parentScratch);
+			parentScratchHandle = parent;
+		}
+	}
+
+	Handle handle;
+
+	if (freeEntries.empty()) {
+		handle = static_cast<Handle>(entries.size());
+		entries.emplace_back();
+		// The emplace may have moved the parent
+		if (parent != NONE) parentEntry = &entries[parent];
+	} else {
+		handle = freeEntries.back();
+		freeEntries.pop_back();
+	}
+
+	Entry& entry = entries[handle];
+	const size_t count = (scratch.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	entry.size = static_cast<uint32_t>(scratch.size());
+	entry.refs = 1;
+	entry.chunks.resize(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		const size_t offset = i * CHUNK_SIZE;
+		const size_t size = std::min(CHUNK_SIZE, scratch.size() - offset);
+
+		ChunkId parentChunk = NONE;
+		const uint8_t* parentData = nullptr;
+
+		if ((parentEntry != nullptr) && (i < parentEntry->chunks.size())) {
+			parentChunk = parentEntry->chunks[i];
+			parentData = parentScratch.data() + offset;
+		}
+
+		entry.chunks[i] = addChunk(scratch.data() + offset, size, parentChunk, parentData);
+	}
+
+	payloadBytes += entry.chunks.capacity() * sizeof(ChunkId);
+
+	if (tracking) writeEntry(handle, changes);
+
+	++statistics.states;
+	statistics.logicalBytes += entry.size;
+
+	return handle;
+}
+
+void StateStore::retain(Handle handle) {
+	++entries.at(handle).refs;
+}
+
+void StateStore::release(Handle handle) {
+	Entry& entry = entries.at(handle);
+
+	if (--entry.refs != 0) return;
+
+	for (ChunkId id : entry.chunks) {
+		releaseChunk(id);
+	}
+
+	--statistics.states;
+	statistics.logicalBytes -= entry.size;
+	payloadBytes -= entry.chunks.capacity() * sizeof(ChunkId);
+
+	std::vector<ChunkId>().swap(entry.chunks);
+	entry.size = 0;
+
+	freeEntries.push_back(handle);
+
+	if (tracking) writeFree(FREE_ENTRY_RECORD, handle, changes);
+
+	// The handle may be reused for another state
+	if (handle == parentScratchHandle) parentScratchHandle = NONE;
+
+	if (statistics.states != 0) return;
+
+	// Nothing refers to any chunk anymore either, so the bookkeeping can go as well. The ids start over, which the
+	// records handle like any other reuse
+	std::vector<Chunk>().swap(chunks);
+	std::vector<ChunkId>().swap(freeChunks);
+	std::unordered_map<uint64_t, ChunkId>().swap(chunksByHash);
+	std::vector<Entry>().swap(entries);
+	std::vector<Handle>().swap(freeEntries);
+	changesOwner.reset();
+}
+
+void StateStore::restore(Handle handle, TMInterface::SimState& state) const {
+	serialize(handle, parentScratch);
+	parentScratchHandle = handle;
+
+	deserialize(parentScratch, state);
+}
+
+TMInterface::SimState StateStore::get(Handle handle) const {
+	TMInterface::SimState state;
+	restore(handle, state);
+
+	return state;
+}
+
+void StateStore::save(Handle handle, std::vector<uint8_t>& out) const {
+	serialize(handle, out);
+}
+
+StateStore::Handle StateStore::load(const uint8_t* data, size_t size) {
+	TMInterface::SimState state;
+
+	scratch.assign(data, data + size);
+	deserialize(scratch, state);
+
+	return insert(state.view());
+}
+
+void StateStore::saveChanges(std::vector<uint8_t>& out) {
+	out.clear();
+
+	if (!tracking) {
+		for (size_t id = 0; id < chunks.size(); ++id) {
+			if (chunks[id].refs != 0) writeChunk(static_cast<ChunkId>(id), out);
+		}
+
+		for (size_t handle = 0; handle < entries.size(); ++handle) {
+			if (entries[handle].refs != 0) writeEntry(static_cast<Handle>(handle), out);
+		}
+
+		tracking = true;
+		return;
+	}
+
+	out.swap(changes);
+}
+
+void StateStore::loadChanges(const uint8_t* data, size_t size, const std::vector<Handle>& handles,
+                             std::shared_ptr<void> owner) {
+	if (!chunks.empty() || !entries.empty()) throw std::logic_error("Changes can only be loaded into an empty store");
+
+	size_t offset = 0;
+
+	// Later records of an id replace earlier ones, it was freed and reused in between
+	while (offset < size) {
+		if (data[offset] == CHUNK_RECORD) {
+			ChunkRecord record;
+			std::memcpy(&record, data + offset, sizeof(record));
+			offset += sizeof(record);
+
+			if (chunks.size() <= record.id) chunks.resize(record.id + 1);
+
+			Chunk& chunk = chunks[record.id];
+			chunk = Chunk{record.hash, data + offset, nullptr, record.base, 0, record.size, record.encodedSize,
+			              record.depth};
+
+			if (!owner) {
+				chunk.owned.reset(new uint8_t[record.encodedSize]);
+				std::copy_n(data + offset, record.encodedSize, chunk.owned.get());
+				chunk.bytes = chunk.owned.get();
+			}
+
+			offset += record.encodedSize;
+		} else if (data[offset] == ENTRY_RECORD) {
+			EntryRecord record;
+			std::memcpy(&record, data + offset, sizeof(record));
+			offset += sizeof(record);
+
+			if (entries.size() <= record.handle) entries.resize(record.handle + 1);
+
+			Entry& entry = entries[record.handle];
+			entry.size = record.size;
+			entry.refs = 0;
+			entry.chunks.resize(record.chunkCount);
+			std::memcpy(entry.chunks.data(), data + offset, record.chunkCount * sizeof(ChunkId));
+			offset += record.chunkCount * sizeof(ChunkId);
+		} else {
+			offset += getRecordSize(data + offset);
+		}
+	}
+
+	for (Handle handle : handles) {
+		Entry& entry = entries.at(handle);
+
+		if (entry.refs++ != 0) continue;
+
+		for (ChunkId id : entry.chunks) {
+			retainLoadedChunk(id);
+		}
+
+		++statistics.states;
+		statistics.logicalBytes += entry.size;
+		payloadBytes += entry.chunks.capacity() * sizeof(ChunkId);
+	}
+
+	// Rehashing while it grows was a fifth of the load
+	chunksByHash.reserve(chunks.size());
+
+	// Everything else was freed after it was written
+	for (size_t id = 0; id < chunks.size(); ++id) {
+		Chunk& chunk = chunks[id];
+
+		if (chunk.refs == 0) {
+			chunk.bytes = nullptr;
+			chunk.owned.reset();
+			freeChunks.push_back(static_cast<ChunkId>(id));
+			continue;
+		}
+
+		chunksByHash.emplace(chunk.hash, static_cast<ChunkId>(id));
+
+		++statistics.chunks;
+		++((chunk.base == NONE) ? statistics.rawChunks : statistics.deltaChunks);
+		payloadBytes += chunk.encodedSize;
+	}
+
+	for (size_t handle = 0; handle < entries.size(); ++handle) {
+		if (entries[handle].refs != 0) continue;
+
+		std::vector<ChunkId>().swap(entries[handle].chunks);
+		entries[handle].size = 0;
+		freeEntries.push_back(static_cast<Handle>(handle));
+	}
+
+	changesOwner = std::move(owner);
+	tracking = true;
+}
+
+StateStore::Statistics StateStore::getStatistics() const {
+	Statistics result = statistics;
+
+	// Rough estimate of the node size of the hash map
+	constexpr size_t hashNodeSize = sizeof(std::pair<uint64_t, ChunkId>) + 2 * sizeof(void*);
+
+	// An empty map reports a bucket it doesn't allocate
+	const size_t hashBuckets = chunksByHash.empty() ? 0 : chunksByHash.bucket_count();
+
+	result.storedBytes = payloadBytes + (chunks.capacity() * sizeof(Chunk)) + (entries.capacity() * sizeof(Entry)) +
+	                     (chunksByHash.size() * hashNodeSize) + (hashBuckets * sizeof(void*)) +
+	                     ((freeChunks.capacity() + freeEntries.capacity()) * sizeof(uint32_t));
+
+	return result;
+}
+
+StateStore::ChunkId StateStore::addChunk(const uint8_t* data, size_t size, ChunkId parentChunk,
+                                         const uint8_t* parentData) {
+	const uint64_t hash = Utils::hashBytes(data, size);
+	const std::unordered_map<uint64_t, ChunkId>::const_iterator existing = chunksByHash.find(hash);
+
+	// Also catches the common case of the chunk being the same as the parent's
+	if ((existing != chunksByHash.end()) && chunkEquals(existing->second, data, size)) {
+		++chunks[existing->second].refs;
+		++statistics.dedupedChunks;
+
+		return existing->second;
+	}
+
+	Chunk chunk{hash, nullptr, nullptr, NONE, 1, static_cast<uint16_t>(size), 0, 0};
+
+	if ((parentChunk != NONE) && (chunks[parentChunk].size == size) &&
+	    (chunks[parentChunk].depth < MAX_DELTA_DEPTH)) {
+		// Deltas that don't save at least half are not worth the extra work when rebuilding
+		uint8_t encoded[CHUNK_SIZE / 2];
+		const size_t encodedSize = encodeDelta(data, parentData, size, encoded, sizeof(encoded));
+
+		if (encodedSize != 0) {
+			chunk.base = parentChunk;
+			chunk.depth = chunks[parentChunk].depth + 1;
+			chunk.owned.reset(new uint8_t[encodedSize]);
+			chunk.encodedSize = static_cast<uint16_t>(encodedSize);
+			std::copy_n(encoded, encodedSize, chunk.owned.get());
+
+			++chunks[parentChunk].refs;
+		}
+	}
+
+	if (chunk.base == NONE) {
+		chunk.owned.reset(new uint8_t[size]);
+		chunk.encodedSize = static_cast<uint16_t>(size);
+		std::copy_n(data, size, chunk.owned.get());
+
+		++statistics.rawChunks;
+	} else {
+		++statistics.deltaChunks;
+	}
+
+	chunk.bytes = chunk.owned.get();
+
+	++statistics.chunks;
+	payloadBytes += chunk.encodedSize;
+
+	ChunkId id;
+
+	if (freeChunks.empty()) {
+		id = static_cast<ChunkId>(chunks.size());
+		chunks.push_back(std::move(chunk));
+	} else {
+		id = freeChunks.back();
+		freeChunks.pop_back();
+		chunks[id] = std::move(chunk);
+	}
+
+	// On a (very unlikely) hash collision the chunk is just not deduplicated
+	if (existing == chunksByHash.end()) chunksByHash.emplace(hash, id);
+
+	if (tracking) writeChunk(id, changes);
+
+	return id;
+}
+
+void StateStore::releaseChunk(ChunkId id) {
+	Chunk& chunk = chunks[id];
+
+	if (--chunk.refs != 0) return;
+
+	const std::unordered_map<uint64_t, ChunkId>::const_iterator registered = chunksByHash.find(chunk.hash);
+	if ((registered != chunksByHash.end()) && (registered->second == id)) chunksByHash.erase(registered);
+
+	--statistics.chunks;
+	--((chunk.base == NONE) ? statistics.rawChunks : statistics.deltaChunks);
+	payloadBytes -= chunk.encodedSize;
+
+	const ChunkId base = chunk.base;
+
+	chunk.bytes = nullptr;
+	chunk.owned.reset();
+	freeChunks.push_back(id);
+
+	if (tracking) writeFree(FREE_CHUNK_RECORD, id, changes);
+
+	if (base != NONE) releaseChunk(base);
+}
+
+void StateStore::retainLoadedChunk(ChunkId id) {
+	// A delta holds one reference to its base, no matter how often it is referenced itself
+	if ((chunks.at(id).refs++ == 0) && (chunks[id].base != NONE)) retainLoadedChunk(chunks[id].base);
+}
+
+void StateStore::writeChunk(ChunkId id, std::vector<uint8_t>& out) const {
+	const Chunk& chunk = chunks[id];
+	const ChunkRecord record{CHUNK_RECORD, chunk.depth, chunk.size, chunk.encodedSize, 0, id, chunk.base, chunk.hash};
+	const size_t offset = out.size();
+
+	out.resize(offset + sizeof(record) + chunk.encodedSize);
+	std::memcpy(out.data() + offset, &record, sizeof(record));
+	std::copy_n(chunk.bytes, chunk.encodedSize, out.data() + offset + sizeof(record));
+}
+
+void StateStore::writeEntry(Handle handle, std::vector<uint8_t>& out) const {
+	const Entry& entry = entries[handle];
+	const EntryRecord record{ENTRY_RECORD, {}, handle, entry.size, static_cast<uint32_t>(entry.chunks.size())};
+	const size_t offset = out.size();
+
+	out.resize(offset + sizeof(record) + (entry.chunks.size() * sizeof(ChunkId)));
+	std::memcpy(out.data() + offset, &record, sizeof(record));
+	std::memcpy(out.data() + offset + sizeof(record), entry.chunks.data(), entry.chunks.size() * sizeof(ChunkId));
+}
+
+void StateStore::writeFree(RecordType type, uint32_t id, std::vector<uint8_t>& out) const {
+	const FreeRecord record{type, {}, id};
+	const size_t offset = out.size();
+
+	out.resize(offset + sizeof(record));
+	std::memcpy(out.data() + offset, &record, sizeof(record));
+}
+
+void StateStore::materialize(ChunkId id, uint8_t* out) const {
+	const Chunk& chunk = chunks[id];
+
+	if (chunk.base == NONE) {
+		std::copy_n(chunk.bytes, chunk.size, out);
+	} else {
+		materialize(chunk.base, out);
+		applyDelta(chunk.bytes, chunk.encodedSize, out);
+	}
+}
+
+bool StateStore::chunkEquals(ChunkId id, const uint8_t* data, size_t size) const {
+	if (chunks[id].size != size) return false;
+
+	uint8_t content[CHUNK_SIZE];
+	materialize(id, content);
+
+	return std::memcmp(content, data, size) == 0;
+}
+
+void StateStore::serialize(Handle handle, std::vector<uint8_t>& out) const {
+	const Entry& entry = entries.at(handle);
+
+	if (entry.refs == 0) throw std::invalid_argument("State handle was already released");
+
+	// Chunks are materialized in place, so leave room for the full last chunk
+	out.resize(entry.chunks.size() * CHUNK_SIZE);
+
+	for (size_t i = 0; i < entry.chunks.size(); ++i) {
+		materialize(entry.chunks[i], out.data() + (i * CHUNK_SIZE));
+	}
+
+	out.resize(entry.size);
+}
+
+void StateStore::deserialize(const std::vector<uint8_t>& data, TMInterface::SimState& state) {
+	const uint8_t* pointer = data.data();
+	uint32_t size;
+
+	std::memcpy(&state.data, pointer, sizeof(state.data));
+	pointer += sizeof(state.data);
+
+	std::memcpy(&size, pointer, sizeof(size));
+	pointer += sizeof(size);
+	state.cpStates.resize(size);
+	std::memcpy(state.cpStates.data(), pointer, size * sizeof(uint32_t));
+	pointer += size * sizeof(uint32_t);
+
+	std::memcpy(&size, pointer, sizeof(size));
+	pointer += sizeof(size);
+	state.cpTimes.resize(size);
+	std::memcpy(state.cpTimes.data(), pointer, size * sizeof(TMInterface::CheckpointTime));
+}
+
+void StateStore::serialize(const TMInterface::SimStateView& state, std::vector<uint8_t>& out) {
+	out.resize(state.getSize());
+
+	uint8_t* pointer = out.data();
+	const uint32_t cpStatesSize = static_cast<uint32_t>(state.cpStates.size);
+	const uint32_t cpTimesSize = static_cast<uint32_t>(state.cpTimes.size);
+
+	std::memcpy(pointer, state.data, sizeof(*state.data));
+	pointer += sizeof(*state.data);
+
+	std::memcpy(pointer, &cpStatesSize, sizeof(cpStatesSize));
+	pointer += sizeof(cpStatesSize);
+	std::memcpy(pointer, state.cpStates.data, cpStatesSize * sizeof(uint32_t));
+	pointer += cpStatesSize * sizeof(uint32_t);
+
+	std::memcpy(pointer, &cpTimesSize, sizeof(cpTimesSize));
+	pointer += sizeof(cpTimesSize);
+	std::memcpy(pointer, state.cpTimes.data, cpTimesSize * sizeof(TMInterface::CheckpointTime));
+}
+
+// Delta format: repeated [varint run of unchanged bytes][varint count of changed bytes][XOR of the changed bytes]
+size_t StateStore::encodeDelta(const uint8_t* data, const uint8_t* base, size_t size, uint8_t* out,
+                               size_t capacity) {
+	size_t length = 0;
+	size_t offset = 0;
+
+	while (offset < size) {
+		size_t same = offset;
+		while ((same < size) && (data[same] == base[same])) ++same;
+
+		if (same == size) break;
+
+		size_t changed = same;
+		while ((changed < size) && (data[changed] != base[changed])) ++changed;
+
+		// Worst case two 2 byte varints plus the literal bytes
+		if ((length + 4 + (changed - same)) > capacity) return 0;
+
+		length += writeVarint(static_cast<uint32_t>(same - offset), out + length);
+		length += writeVarint(static_cast<uint32_t>(changed - same), out + length);
+
+		for (size_t i = same; i < changed; ++i) {
+			out[length++] = data[i] ^ base[i];
+		}
+
+		offset = changed;
+	}
+
+	// An empty delta would mean the chunks are identical, which the deduplication already handles
+	return length;
+}
+
+void StateStore::applyDelta(const uint8_t* delta, size_t deltaSize, uint8_t* inOut) {
+	size_t offset = 0;
+	size_t position = 0;
+
+	while (offset < deltaSize) {
+		position += readVarint(delta, offset);
+		const uint32_t changed = readVarint(delta, offset);
+
+		for (uint32_t i = 0; i < changed; ++i) {
+			inOut[position++] ^= delta[offset++];
+		}
+	}
+}
+
+void StateStore::compactChanges(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+	std::vector<size_t> offsets;
+
+	for (size_t offset = 0; offset < size; offset += getRecordSize(data + offset)) {
+		offsets.push_back(offset);
+	}
+
+	offsets.push_back(size);
+
+	// Going backwards, an id that is freed later is dropped until the record that added it. Ids freed here that were
+	// added before don't matter, loadChanges only keeps what the handles it gets refer to
+	std::unordered_set<uint32_t> freedChunks;
+	std::unordered_set<uint32_t> freedEntries;
+	std::vector<bool> kept(offsets.size() - 1);
+
+	for (size_t i = kept.size(); i-- > 0;) {
+		const uint8_t* record = data + offsets[i];
+
+		if (record[0] == CHUNK_RECORD) {
+			ChunkRecord chunk;
+			std::memcpy(&chunk, record, sizeof(chunk));
+			kept[i] = freedChunks.erase(chunk.id) == 0;
+		} else if (record[0] == ENTRY_RECORD) {
+			EntryRecord entry;
+			std::memcpy(&entry, record, sizeof(entry));
+			kept[i] = freedEntries.erase(entry.handle) == 0;
+		} else {
+			FreeRecord free;
+			std::memcpy(&free, record, sizeof(free));
+			((free.type == FREE_CHUNK_RECORD) ? freedChunks : freedEntries).insert(free.id);
+		}
+	}
+
+	for (size_t i = 0; i < kept.size(); ++i) {
+		if (kept[i]) out.insert(out.end(), data + offsets[i], data + offsets[i + 1]);
+	}
+}
+
+size_t StateStore::getRecordSize(const uint8_t* record) {
+	if (record[0] == CHUNK_RECORD) {
+		ChunkRecord chunk;
+		std::memcpy(&chunk, record, sizeof(chunk));
+
+		return sizeof(chunk) + chunk.encodedSize;
+	}
+
+	if (record[0] == ENTRY_RECORD) {
+		EntryRecord entry;
+		std::memcpy(&entry, record, sizeof(entry));
+
+		return sizeof(entry) + (entry.chunkCount * sizeof(ChunkId));
+	}
+
+	return sizeof(FreeRecord);
+}
+
+}  // namespace TMStar
@@ -0,0 +1,154 @@
+#include "TMStar/Utils/Hash.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TMStar_HAS_SSE2
+#endif
+
+namespace TMStar {
+namespace Utils {
+
+namespace {
+
+// Quantized values are clamped to this, so they always fit into an int32_t
+constexpr float QUANTIZED_LIMIT = 1073741824.0f;
+
+// Only shifts, adds and xors, which SSE2 has for 32 bit lanes
+constexpr uint32_t mixLane(uint32_t lane, uint32_t value) {
+	lane ^= value;
+	lane += lane << 10;
+	lane ^= lane >> 6;
+	lane += lane << 3;
+	lane ^= lane >> 11;
+
+	return lane;
+}
+
+int32_t quantize(float value, float scale) {
+	// Same operand order as _mm_max_ps/_mm_min_ps, so NaNs end up the same as well
+	float scaled = value * scale;
+	scaled = (scaled > -QUANTIZED_LIMIT) ? scaled : -QUANTIZED_LIMIT;
+	scaled = (scaled < QUANTIZED_LIMIT) ? scaled : QUANTIZED_LIMIT;
+
+	// Rounds to nearest even like _mm_cvtps_epi32
+	return static_cast<int32_t>(std::lrintf(scaled));
+}
+
+#ifdef TMStar_HAS_SSE2
+__m128i mixLanes(__m128i lanes, __m128i values) {
+	lanes = _mm_xor_si128(lanes, values);
+	lanes = _mm_add_epi32(lanes, _mm_slli_epi32(lanes, 10));
+	lanes = _mm_xor_si128(lanes, _mm_srli_epi32(lanes, 6));
+	lanes = _mm_add_epi32(lanes, _mm_slli_epi32(lanes, 3));
+	lanes = _mm_xor_si128(lanes, _mm_srli_epi32(lanes, 11));
+
+	return lanes;
+}
+#endif
+
+void initLanes(uint32_t (&lanes)[4], uint64_t seed) {
+	// The lanes get mixed into the seed again at the end, they only need to differ
+	for (uint32_t lane = 0; lane < 4; ++lane) {
+		lanes[lane] = static_cast<uint32_t>(seed ^ (seed >> 32)) ^ (lane * 0x9e3779b9u);
+	}
+}
+
+// Blocks of four values from offset on, the last one padded with zeros
+void mixScalar(uint32_t (&lanes)[4], const float* values, const float* scales, size_t offset, size_t count) {
+	for (; offset < count; offset += 4) {
+		for (size_t lane = 0; lane < 4; ++lane) {
+			const size_t index = offset + lane;
+			const int32_t value = (index < count) ? quantize(values[index], scales[index]) : 0;
+
+			lanes[lane] = mixLane(lanes[lane], static_cast<uint32_t>(value));
+		}
+	}
+}
+
+uint64_t finishLanes(const uint32_t (&lanes)[4], size_t count, uint64_t seed) {
+	const uint64_t hash = combine(seed ^ count, (static_cast<uint64_t>(lanes[1]) << 32) | lanes[0]);
+
+	return combine(hash, (static_cast<uint64_t>(lanes[3]) << 32) | lanes[2]);
+}
+
+}  // namespace
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+	constexpr uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed ^ (size * multiplier);
+
+	// Four independent lanes, so the multiplications can overlap
+	uint64_t lanes[4] = {hash, hash + 1, hash + 2, hash + 3};
+	size_t offset = 0;
+
+	for (; (offset + 32) <= size; offset += 32) {
+		for (size_t lane = 0; lane < 4; ++lane) {
+			uint64_t word;
+			std::memcpy(&word, bytes + offset + (lane * 8), sizeof(word));
+
+			lanes[lane] = (lanes[lane] ^ word) * multiplier;
+			lanes[lane] ^= lanes[lane] >> 29;
+		}
+	}
+
+	hash = combine(combine(lanes[0], lanes[1]), combine(lanes[2], lanes[3]));
+
+	for (; (offset + 8) <= size; offset += 8) {
+		uint64_t word;
+		std::memcpy(&word, bytes + offset, sizeof(word));
+
+		hash = combine(hash, word);
+	}
+
+	if (offset < size) {
+		uint64_t word = 0;
+		std::memcpy(&word, bytes + offset, size - offset);
+
+		hash = combine(hash, word);
+	}
+
+	return mix(hash);
+}
+
+uint64_t hashQuantized(const float* values, const float* scales, size_t count, uint64_t seed) {
+	alignas(16) uint32_t lanes[4];
+	initLanes(lanes, seed);
+
+	size_t offset = 0;
+
+#ifdef TMStar_HAS_SSE2
+	const __m128 high = _mm_set1_ps(QUANTIZED_LIMIT);
+	const __m128 low = _mm_set1_ps(-QUANTIZED_LIMIT);
+	__m128i state = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+
+	for (; (offset + 4) <= count; offset += 4) {
+		__m128 scaled = _mm_mul_ps(_mm_loadu_ps(values + offset), _mm_loadu_ps(scales + offset));
+		scaled = _mm_min_ps(_mm_max_ps(scaled, low), high);
+
+		state = mixLanes(state, _mm_cvtps_epi32(scaled));
+	}
+
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), state);
+#endif
+
+	// Without SSE2 everything goes through here
+	mixScalar(lanes, values, scales, offset, count);
+
+	return finishLanes(lanes, count, seed);
+}
+
+uint64_t hashQuantizedScalar(const float* values, const float* scales, size_t count, uint64_t seed) {
+	uint32_t lanes[4];
+	initLanes(lanes, seed);
+	mixScalar(lanes, values, scales, 0, count);
+
+	return finishLanes(lanes, count, seed);
+}
+
+}  // namespace Utils
+}  // namespace TMStar
@@ -0,0 +1,139 @@
+#include "TMStar/Utils/TranspositionTable.h"
+
+#include <utility>
+
+namespace TMStar {
+namespace Utils {
+
+namespace {
+
+// An all zero slot is empty, so tags are never 0
+constexpr uint64_t getTag(uint64_t key) {
+	const uint64_t tag = key >> 32;
+
+	return (tag != 0) ? tag : 1;
+}
+
+constexpr uint64_t makeSlot(uint64_t tag, uint32_t cost) {
+	return (tag << 32) | cost;
+}
+
+}  // namespace
+
+TranspositionTable::TranspositionTable(size_t bytes)
+    : buckets(nullptr), bucketCount(0), replacements(0), logging(false) {
+	const size_t wanted = bytes / sizeof(Bucket);
+
+	if (wanted == 0) return;
+
+	// Power of two, so the bucket is just the lower bits of the key
+	bucketCount = 1;
+	while ((bucketCount * 2) <= wanted) bucketCount *= 2;
+
+	storage = std::make_unique<Bucket[]>(bucketCount);
+	clear();
+}
+
+bool TranspositionTable::isEnabled() const {
+	return bucketCount != 0;
+}
+
+TranspositionTable::Result TranspositionTable::update(uint64_t key, uint32_t cost) {
+	const size_t index = key & (bucketCount - 1);
+	Bucket& bucket = buckets[index];
+	const uint64_t tag = getTag(key);
+	const uint64_t entry = makeSlot(tag, cost);
+
+	// Only starts over if another thread changed the bucket in between
+	for (;;) {
+		size_t slot = 0;
+		uint64_t current = 0;
+		size_t cheapest = 0;
+		uint64_t cheapestSlot = 0;
+
+		// Slots are filled in order and never emptied, so the key can't come after the first empty slot
+		for (; slot < SLOTS_PER_BUCKET; ++slot) {
+			current = bucket.slots[slot].load(std::memory_order_relaxed);
+
+			if ((current == 0) || ((current >> 32) == tag)) break;
+
+			if ((slot == 0) || (static_cast<uint32_t>(current) < static_cast<uint32_t>(cheapestSlot))) {
+				cheapest = slot;
+				cheapestSlot = current;
+			}
+		}
+
+		if (slot == SLOTS_PER_BUCKET) {
+			if (bucket.slots[cheapest].compare_exchange_strong(cheapestSlot, entry, std::memory_order_relaxed)) {
+				replacements.fetch_add(1, std::memory_order_relaxed);
+				if (logging) changes.push_back(Change{(index * SLOTS_PER_BUCKET) + cheapest, entry});
+
+				return Result::NEW;
+			}
+
+			continue;
+		}
+
+		if ((current != 0) && (static_cast<uint32_t>(current) <= cost)) return Result::DUPLICATE;
+
+		if (bucket.slots[slot].compare_exchange_strong(current, entry, std::memory_order_relaxed)) {
+			if (logging) changes.push_back(Change{(index * SLOTS_PER_BUCKET) + slot, entry});
+
+			return (current == 0) ? Result::NEW : Result::IMPROVED;
+		}
+	}
+}
+
+void TranspositionTable::clear() {
+	if (!storage && (bucketCount != 0)) storage = std::make_unique<Bucket[]>(bucketCount);
+
+	buckets = storage.get();
+	bucketOwner.reset();
+
+	for (size_t i = 0; i < bucketCount; ++i) {
+		for (std::atomic<uint64_t>& slot : buckets[i].slots) {
+			slot.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	replacements = 0;
+	logging = false;
+	changes.clear();
+}
+
+size_t TranspositionTable::getSlotCount() const {
+	return bucketCount * SLOTS_PER_BUCKET;
+}
+
+size_t TranspositionTable::getMemoryUsage() const {
+	return bucketCount * sizeof(Bucket);
+}
+
+uint64_t TranspositionTable::getReplacements() const {
+	return replacements;
+}
+
+void TranspositionTable::logChanges() {
+	logging = true;
+}
+
+void TranspositionTable::saveChanges(std::vector<Change>& out) {
+	out.clear();
+	out.swap(changes);
+}
+
+bool TranspositionTable::attach(uint64_t* slots, size_t count, std::shared_ptr<void> owner) {
+	static_assert(sizeof(Bucket) == (SLOTS_PER_BUCKET * sizeof(uint64_t)), "Buckets are stored as plain slots");
+
+	if ((count != getSlotCount()) || (count == 0)) return false;
+
+	// A slot is a lone word, so plain and atomic ones look the same
+	buckets = reinterpret_cast<Bucket*>(slots);
+	storage.reset();
+	bucketOwner = std::move(owner);
+
+	return true;
+}
+
+}  // namespace Utils
+}  // namespace TMStar
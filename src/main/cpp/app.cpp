@@ -1,40 +1,290 @@
 #include "app.h"
 
-#include <windows.h>
-
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
 #include <iostream>
-#undef interface
+#include <memory>
+#include <string>
 
 #include "TMInterface/Interface.h"
+#include "TMStar/CachedSimulator.h"
+#include "TMStar/DistanceField.h"
+#include "TMStar/IdaEngine.h"
+#include "TMStar/InterfaceSimulator.h"
+#include "TMStar/ParallelEngine.h"
+#include "TMStar/SimulationCache.h"
+#include "TMStar/SmaEngine.h"
+
+namespace {
+
+enum class Mode { ASTAR, SINGLE, SMA, IDA };
+
+// What the states left in the store take up, against keeping them as they are sent
+void printStore(const TMStar::StateStore::Statistics& store) {
+	const size_t states = std::max<size_t>(store.states, 1);
+
+	std::cout << store.states << " states stored in " << (store.storedBytes >> 10) << " KiB, "
+	          << (store.storedBytes / states) << " bytes per state instead of " << (store.logicalBytes / states)
+	          << " (" << store.dedupedChunks << " chunks deduplicated, " << store.deltaChunks << " deltas)"
+	          << std::endl;
+}
+
+// simulator is interface itself or wraps it
+template <typename Engine, typename Simulator, typename Heuristic>
+void runEngine(Simulator& simulator, TMStar::InterfaceSimulator& interface, const TMStar::SearchSettings& settings,
+               const Heuristic& heuristic, bool resume) {
+	Engine engine{simulator, settings, heuristic};
+
+	const TMInterface::SimState start = interface.getState();
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	typename Engine::Result result;
+
+	if constexpr (requires { engine.resume(); }) {
+		result = resume ? engine.resume() : engine.run(start.view());
+	} else {
+		result = engine.run(start.view());
+	}
+
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	const TMStar::SearchStatistics& statistics = result.statistics;
+
+	std::cout << (result.found ? "Found path: " : "No path found: ") << result.cost << "ms, " << result.actions.size()
+	          << " actions, " << statistics.expansions << " expansions in " << elapsed.count() << "s" << std::endl;
+	std::cout << statistics.generated << " generated, " << statistics.pruned << " pruned, " << statistics.evictions
+	          << " evictions, " << statistics.iterations << " iterations, " << (statistics.peakBytes >> 10)
+	          << " KiB at most, " << statistics.spill.spilledEntries << " spilled in " << statistics.spill.runs
+	          << " runs (" << statistics.spill.prefetchedRuns << " prefetched)" << std::endl;
+	printStore(statistics.store);
+	std::cout << statistics.checkpoints << " checkpoints, " << statistics.checkpointPause << "us longest pause"
+	          << std::endl;
+	std::cout << interface.getRewindStatistics().timeRewinds << " rewinds to time, "
+	          << interface.getRewindStatistics().stateRewinds << " rewinds to state" << std::endl;
+}
+
+// Only ParallelEngine uses all interfaces
+template <template <typename...> class Engine, typename Heuristic>
+void runSingle(TMStar::InterfaceSimulator& simulator, TMStar::SimulationCache* cache,
+               const TMStar::SearchSettings& settings, const Heuristic& heuristic, bool resume = false) {
+	using Cached = TMStar::CachedSimulator<TMStar::InterfaceSimulator>;
+
+	if (cache == nullptr) {
+		runEngine<Engine<TMStar::InterfaceSimulator, Heuristic>>(simulator, simulator, settings, heuristic, resume);
+		return;
+	}
+
+	Cached cached{simulator, *cache};
+	runEngine<Engine<Cached, Heuristic>>(cached, simulator, settings, heuristic, resume);
+
+	const TMStar::SimulationCache::Statistics& statistics = cache->getStatistics();
+
+	std::cout << statistics.hits << " cache hits, " << statistics.misses << " misses, " << statistics.entries
+	          << " transitions in " << (statistics.dataBytes >> 20) << " MiB" << std::endl;
+}
+
+// One worker per game instance
+template <typename Heuristic>
+void runParallel(const std::vector<TMStar::InterfaceSimulator*>& workers, const TMStar::SearchSettings& settings,
+                 const Heuristic& heuristic) {
+	using Engine = TMStar::ParallelEngine<TMStar::InterfaceSimulator, Heuristic>;
+
+	Engine engine{workers, settings, heuristic};
+
+	const TMInterface::SimState start = workers.front()->getState();
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	const typename Engine::Result result = engine.run(start.view());
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+	std::cout << (result.found ? "Found path: " : "No path found: ") << result.cost << "ms, " << result.actions.size()
+	          << " actions, " << result.statistics.expansions << " expansions in " << elapsed.count() << "s with "
+	          << workers.size() << " workers ("
+	          << (static_cast<double>(result.statistics.expansions) / std::max(elapsed.count(), 1e-9))
+	          << " expansions/s)" << std::endl;
+	const TMStar::ParallelSearchStatistics statistics = engine.getStatistics();
+
+	std::cout << statistics.generated << " generated, " << statistics.pruned << " pruned, "
+	          << statistics.transpositions << " transpositions, " << statistics.messages << " messages, "
+	          << (static_cast<double>(statistics.rewinds) / std::max<uint64_t>(statistics.expansions, 1))
+	          << " rewinds per expansion" << std::endl;
+	printStore(statistics.store);
+
+	TMStar::RewindStatistics rewinds;
+
+	for (const TMStar::InterfaceSimulator* simulator : workers) {
+		rewinds.timeRewinds += simulator->getRewindStatistics().timeRewinds;
+		rewinds.stateRewinds += simulator->getRewindStatistics().stateRewinds;
+	}
+
+	std::cout << rewinds.timeRewinds << " rewinds to time, " << rewinds.stateRewinds << " rewinds to state"
+	          << std::endl;
+}
+
+void printUsage(const char* name) {
+	std::cerr << "Usage: " << name
+	          << " [--spill <directory> <MiB>] [--checkpoint <directory>] [--resume <directory>] [--sma <MiB>]"
+	          << " [--ida] [--cache <directory>] [--distance-field <track file> <directory> <top speed m/s>]\n"
+	          << "--spill, --checkpoint and --resume only work with the default search, and --spill doesn't work"
+	          << " together with --checkpoint or --resume" << std::endl;
+}
+
+}  // namespace
+
+// app [--spill <directory> <MiB>] [--checkpoint <directory>] [--resume <directory>] [--sma <MiB>] [--ida]
+//     [--cache <directory>] [--distance-field <track file> <directory> <top speed m/s>]
+int main(int argc, char** argv) {
+	Mode mode = Mode::ASTAR;
+	size_t memoryBudget = 0;
+	TMStar::SpillSettings spill;
+	TMStar::CheckpointSettings checkpoint;
+	bool resume = false;
+	std::string cacheDirectory;
+	std::string trackPath;
+	std::string fieldDirectory;
+	float topSpeed = 0.0f;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if ((arg == "--spill") && ((i + 2) < argc)) {
+			spill.directory = argv[++i];
+			spill.memoryBytes = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10)) << 20;
+		} else if (((arg == "--checkpoint") || (arg == "--resume")) && ((i + 1) < argc)) {
+			checkpoint.directory = argv[++i];
+			resume = arg == "--resume";
+		} else if ((arg == "--sma") && ((i + 1) < argc)) {
+			mode = Mode::SMA;
+			memoryBudget = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10)) << 20;
+		} else if (arg == "--ida") {
+			mode = Mode::IDA;
+		} else if ((arg == "--cache") && ((i + 1) < argc)) {
+			cacheDirectory = argv[++i];
+		} else if ((arg == "--distance-field") && ((i + 3) < argc)) {
+			trackPath = argv[++i];
+			fieldDirectory = argv[++i];
+			topSpeed = std::strtof(argv[++i], nullptr);
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Only Engine spills and takes checkpoints, and it can't do both at once. Caught here, before the interfaces are
+	// registered, instead of by Engine in the middle of the run
+	const bool spilling = !spill.directory.empty();
+	const bool checkpointing = !checkpoint.directory.empty();
+
+	if ((spilling && checkpointing) || ((spilling || checkpointing) && (mode != Mode::ASTAR))) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	if (spilling || checkpointing) mode = Mode::SINGLE;
+
+	// The cache isn't thread safe, so it takes a single worker search
+	if (!cacheDirectory.empty() && (mode == Mode::ASTAR)) mode = Mode::SINGLE;
+
+	// Built before registering, the server would time out on us otherwise
+	std::unique_ptr<TMStar::DistanceField> field;
+
+	if (!trackPath.empty()) {
+		if (!(topSpeed > 0.0f)) {
+			std::cerr << "The top speed has to be positive" << std::endl;
+			return 1;
+		}
+
+		try {
+			const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			field = std::make_unique<TMStar::DistanceField>(TMStar::TrackDescription::load(trackPath), fieldDirectory);
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+			std::cout << "Distance field " << field->getPath() << " ready in " << elapsed.count() << "s" << std::endl;
+		} catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<std::shared_ptr<TMInterface::Interface>> interfaces;
+	std::vector<std::unique_ptr<TMStar::InterfaceSimulator>> simulators;
+	std::vector<TMStar::InterfaceSimulator*> workers;
 
-int main() {
 	std::cout << "Active interfaces:\n";
 
 	for (std::shared_ptr<TMInterface::Interface> i : TMInterface::Interface::getActiveInterfaces()) {
 		std::cout << i->getName() << '\n';
+
+		i->sendPacket(TMInterface::Packets::C_REGISTER{});
+
+		if (!i->waitForPacket(std::chrono::seconds(1))) {
+			std::cout << "No answer from " << i->getName() << std::endl;
+			continue;
+		}
+
+		std::cout << i->receivePacket()->packetName << std::endl;
+
+		interfaces.push_back(i);
+		simulators.push_back(std::make_unique<TMStar::InterfaceSimulator>(*i));
+		workers.push_back(simulators.back().get());
+
+		if ((mode != Mode::ASTAR) ||
+		    (workers.size() == TMStar::ParallelEngine<TMStar::InterfaceSimulator>::MAX_WORKERS)) {
+			break;
+		}
 	}
 
-	TMInterface::Packets::S_RESPONSE::registerCallback(
-	    [](std::shared_ptr<TMInterface::Packets::S_RESPONSE> packet, std::unique_ptr<TMInterface::Packet> response) {
-		    std::cout << packet->test << '\n';
-		    std::cout << ((response == nullptr) ? "null" : response->packetName) << '\n';
-		    return response;
-	    });
+	if (workers.empty()) return 1;
 
-	TMInterface::Interface interface{0};
+	TMStar::SearchSettings settings;
+	settings.maxExpansions = 10'000;
+	settings.transpositionBytes = 64 << 20;
+	settings.memoryBudget = memoryBudget;
+	settings.spill = spill;
+	settings.checkpoint = checkpoint;
 
-	interface.sendPacket(TMInterface::Packets::C_REGISTER{});
+	std::unique_ptr<TMStar::SimulationCache> cache;
+	if (!cacheDirectory.empty()) cache = std::make_unique<TMStar::SimulationCache>(cacheDirectory);
 
-	Sleep(1'000);
+	auto search = [&](const auto& heuristic) {
+		if (mode == Mode::SINGLE) {
+			runSingle<TMStar::Engine>(*workers.front(), cache.get(), settings, heuristic, resume);
+		} else if (mode == Mode::SMA) {
+			runSingle<TMStar::SmaEngine>(*workers.front(), cache.get(), settings, heuristic);
+		} else if (mode == Mode::IDA) {
+			runSingle<TMStar::IdaEngine>(*workers.front(), cache.get(), settings, heuristic);
+		} else {
+			runParallel(workers, settings, heuristic);
+		}
+	};
 
-	std::cout << interface.receivePacket()->packetName << std::endl;
+	int result = 0;
 
-	Sleep(10'000);
+	// The interfaces have to be deregistered either way, or the game keeps waiting for us
+	try {
+		if (field) {
+			search(TMStar::DistanceHeuristic{field.get(), topSpeed});
+		} else {
+			search(TMStar::ZeroHeuristic{});
+		}
+	} catch (const std::exception& e) {
+		std::cerr << "Search failed: " << e.what() << std::endl;
+		result = 1;
+	}
 
-	interface.sendPacket(TMInterface::Packets::C_DEREGISTER{});
-	Sleep(1'000);
+	std::cout << interfaces.front()->getName() << ": " << interfaces.front()->getMetrics() << std::endl;
 
-	std::cout << interface.receivePacket()->packetName << std::endl;
+	for (const std::shared_ptr<TMInterface::Interface>& i : interfaces) {
+		// Still inside a simulation step, where the server takes client calls
+		i->sendPacket(TMInterface::Packets::C_DEREGISTER{});
+
+		if (!i->waitForPacket(std::chrono::seconds(1))) {
+			std::cout << "No answer from " << i->getName() << std::endl;
+			continue;
+		}
+
+		const TMInterface::Packet* packet = i->receivePacket();
+		std::cout << ((packet != nullptr) ? packet->packetName : "Unknown packet") << std::endl;
+	}
 
-	return 0;
+	return result;
 }
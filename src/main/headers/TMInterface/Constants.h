@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
 
 namespace TMInterface {
 
 constexpr size_t BUF_SIZE = 16384;
 constexpr size_t MAX_SERVERS = 16;
+// Packet id and error code in front of every payload
+constexpr size_t HEADER_SIZE = sizeof(int32_t) + sizeof(int32_t);
+// Upper bound for packet ids, sizes the flat per packet tables
+constexpr int32_t MAX_PACKET_ID = 63;
 
 enum class ErrorCode : int32_t {
 	NONE = 0,
@@ -15,12 +21,14 @@ enum class ErrorCode : int32_t {
 
 	NO_EVENT_BUFFER,
 
-	NO_PLAYER_INFO
+	NO_PLAYER_INFO,
+
+	NO_SAVED_STATE
 };
 
-inline constexpr std::ostream& operator<<(std::ostream& os, const ErrorCode type) {
+inline std::ostream& operator<<(std::ostream& os, const ErrorCode type) {
 #define ENUMSTR(name)       \
-	case ErrorCode::##name: \
+	case ErrorCode::name:   \
 		os << #name;        \
 		break;
 	switch (type) {
@@ -29,6 +37,7 @@ inline constexpr std::ostream& operator<<(std::ostream& os, const ErrorCode type
 		ENUMSTR(CLIENT_ALREADY_REGISTERED)
 		ENUMSTR(NO_EVENT_BUFFER)
 		ENUMSTR(NO_PLAYER_INFO)
+		ENUMSTR(NO_SAVED_STATE)
 	default:
 		os << "Unknown error code: " << static_cast<int32_t>(type);
 		break;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SimState.h"
+#include "Structs.h"
+
+namespace TMInterface {
+
+// Forward declarations
+class Interface;
+
+// Non owning view of an event buffer, as sent with C_SIM_SET_EVENT_BUFFER and received for C_SIM_GET_EVENT_BUFFER.
+// Views into the buffer stay valid until the next packet is sent or received on that interface.
+// The game still calls S_ON_SIM_STEP every step while it plays the events, and every call has to be answered. So
+// handing it a whole stretch of inputs saves no round trips over putting held inputs into a rewound state, which is
+// what InterfaceSimulator does.
+class EventBufferView {
+public:
+	uint32_t eventsDuration;
+	ArrayView<InputEvent> events;
+
+public:
+	EventBufferView();
+	EventBufferView(uint32_t eventsDuration, ArrayView<InputEvent> events);
+
+	void write(Interface& interface) const;
+	// Views the event buffer at the current position of the interface's buffer
+	static EventBufferView read(Interface& interface);
+};
+
+}  // namespace TMInterface
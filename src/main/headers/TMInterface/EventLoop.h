@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "Interface.h"
+#include "Utils/Task.h"
+
+namespace TMInterface {
+
+// Drives coroutines that talk to many interfaces from a single thread. A coroutine awaiting
+// Interface::request/receive is parked until the peer's packet shows up in that interface's buffer, meanwhile the
+// loop runs every other coroutine that can make progress. So one thread keeps all game instances busy, and whatever a
+// coroutine computes between two requests overlaps with the other instances simulating.
+class EventLoop {
+public:
+	// How long the loop blocks at most when nothing is ready. Blocking happens on the buffer of the interface that
+	// waits the longest, everything else is checked again in between
+	static constexpr std::chrono::microseconds MIN_SLEEP{10};
+	static constexpr std::chrono::microseconds MAX_SLEEP{500};
+
+protected:
+	std::vector<Interface*> interfaces;
+	std::vector<Utils::Task<void>> tasks;
+	bool stopped;
+
+public:
+	EventLoop();
+	~EventLoop();
+
+	// Delete copy stuff
+	EventLoop(const EventLoop&) = delete;
+	EventLoop& operator=(const EventLoop&) = delete;
+
+	// An interface can only be attached to one loop at a time
+	void attach(Interface& interface);
+	void detach(Interface& interface);
+
+	// Starts the task right away. It runs until its first co_await
+	void spawn(Utils::Task<void> task);
+
+	// Runs until every spawned task finished or stop() was called. Rethrows the first exception of a task
+	void run();
+	// Resumes every coroutine whose packet arrived, without blocking. Returns how many were resumed
+	size_t poll();
+	void stop();
+
+	size_t getTaskCount() const;
+
+protected:
+	// Removes finished tasks
+	void collect();
+	// Blocks until a packet might have arrived, at most for timeout
+	void idle(std::chrono::nanoseconds timeout);
+
+	void suspend(Interface& interface, std::coroutine_handle<> handle);
+
+	friend class PacketAwaitable;
+};
+
+}  // namespace TMInterface
@@ -1,29 +1,56 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <coroutine>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "Constants.h"
+#include "Metrics.h"
+#include "PacketAwaitable.h"
 #include "Packets.h"
+#include "Utils/BufferCursor.h"
 #include "Utils/NamedBuffer.h"
+#include "Utils/ReadyFlag.h"
 
 namespace TMInterface {
 
 // Forward declaration
+class EventLoop;
 class Packet;
+class TraceRecorder;
 
 class Interface {
 protected:
 	const std::string name;
 	Utils::NamedBuffer buffer;
-	std::atomic<size_t> bufferOffset;
+	Utils::ReadyFlag ready;
+	Utils::BufferCursor<BUF_SIZE> cursor;
+	// The last received packet and its response live here, so receiving doesn't allocate
+	Packets::PacketStorage receivedPacket;
+	Packets::PacketStorage responsePacket;
+	// Id of the packet we sent last, until the peer answered it
+	std::atomic<int32_t> pendingPacketId;
+	std::atomic<ErrorCode> lastError;
 	std::atomic_bool registered;
+	Metrics metrics;
+
+	// Set while attached to an event loop, and the coroutine waiting for the peer since when
+	EventLoop* loop;
+	std::coroutine_handle<> waiter;
+	std::chrono::steady_clock::time_point waitingSince;
+
+	// Only set while recording
+	std::unique_ptr<TraceRecorder> recorder;
+
+	friend class EventLoop;
+	friend class PacketAwaitable;
 
 public:
-	Interface(const std::string& name, bool printErrors = true);
-	Interface(size_t index = 0, bool printErrors = true);
+	Interface(const std::string& name, bool printErrors = true, const Utils::MappingOptions& options = {});
+	Interface(size_t index = 0, bool printErrors = true, const Utils::MappingOptions& options = {});
 	virtual ~Interface();
 
 	// Delete copy stuff
@@ -31,21 +58,66 @@ public:
 	Interface& operator=(const Interface&) = delete;
 
 	const std::string& getName() const;
+	// Error code of the last received packet
+	ErrorCode getLastError() const;
 	constexpr bool isActive() const;
 	constexpr operator bool() const;
 
 	void sendPacket(const Packet& packet);
-	std::unique_ptr<Packet> receivePacket();
+	// Whether the peer put a packet into the buffer. Never blocks
+	bool hasPacket() const;
+	// Blocks until the peer put a packet into the buffer. Returns false on timeout
+	bool waitForPacket(std::chrono::nanoseconds timeout);
+	// The returned packet stays valid until the next call. Returns nullptr for unknown packets
+	Packet* receivePacket();
+	// Same, but first hands the packet to handler, which is bound at compile time and can be inlined.
+	// handler(ConcretePacket&, ConcretePacket::responsePacket_t*) is called for every packet type it accepts and
+	// returns the response, before the registered callbacks run
+	template <typename Handler>
+	Packet* receivePacket(Handler&& handler);
+
+	// Awaitable versions for coroutines, e.g. Packet* response = co_await interface.request(C_SIM_GET_STATE{});
+	// The interface has to be attached to an EventLoop. packet has to stay alive until the co_await finished
+	PacketAwaitable request(const Packet& packet);
+	// Only waits for the next packet of the peer, e.g. server calls
+	PacketAwaitable receive();
 
 	template <typename T>
 	void writeObj(const T& obj);
 	template <typename T>
 	void readObj(T& obj);
 
-	static std::vector<std::shared_ptr<Interface>> getActiveInterfaces();
+	template <typename T>
+	void writeArray(const T* data, size_t count);
+	// Points into the buffer instead of copying. Stays valid until the next packet is sent or received
+	template <typename T>
+	const T* viewArray(size_t count);
+	// Moves on without touching the bytes in between. While writing they stay zero, and while reading they don't have to
+	// be cleared later
+	void skip(size_t size);
+
+	// Latency percentiles and counters since construction or the last reset. Call on the thread using the interface
+	MetricsSnapshot getMetrics() const;
+	void resetMetrics();
+
+	// Appends every packet sent or received from now on to a trace file, see TraceRecorder. Throws std::runtime_error if
+	// the file can't be created
+	void startRecording(const std::string& path);
+	void stopRecording();
+	bool isRecording() const;
+
+	static std::vector<std::shared_ptr<Interface>> getActiveInterfaces(const Utils::MappingOptions& options = {});
 
 protected:
-	void zero(size_t amount = BUF_SIZE);
+	// Reads the packet from the buffer and prepares its response
+	Packet* readPacket(Packet*& response);
+	// Sends the response (if any) after the callbacks ran
+	void finishPacket(Packet* response);
+
+	// Only clears what was touched since the last call
+	void zero();
+	// Records the last received packet with as much payload as was read of it
+	void finishRecording();
 
 	static std::string getNameFromIndex(size_t index);
 };
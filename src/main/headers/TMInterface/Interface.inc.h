@@ -4,7 +4,8 @@
 
 #ifdef TMInterface_Interface_Proper_Included
 
-#include <algorithm>
+#include <type_traits>
+#include <variant>
 
 namespace TMInterface {
 
@@ -20,24 +21,53 @@ constexpr Interface::operator bool() const {
 // template functions
 template <typename T>
 void Interface::writeObj(const T& obj) {
-	const char* pointer = reinterpret_cast<const char*>(&obj);
-	constexpr size_t size = sizeof(T);
+	cursor.writeObj(obj);
+}
 
-	// TODO: Range check
+template <typename T>
+void Interface::readObj(T& obj) {
+	cursor.readObj(obj);
+}
 
-	std::copy_n(pointer, size, buffer.buffer + bufferOffset);
-	bufferOffset += size;
+template <typename T>
+void Interface::writeArray(const T* data, size_t count) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be written to the buffer");
+
+	cursor.writeBytes(data, count * sizeof(T));
 }
 
 template <typename T>
-void Interface::readObj(T& obj) {
-	char* pointer = reinterpret_cast<char*>(&obj);
-	constexpr size_t size = sizeof(T);
+const T* Interface::viewArray(size_t count) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be viewed in the buffer");
+	static_assert((alignof(T) <= alignof(int32_t)), "The buffer layout only guarantees 4 byte alignment");
+
+	return reinterpret_cast<const T*>(cursor.view(count * sizeof(T)));
+}
+
+template <typename Handler>
+Packet* Interface::receivePacket(Handler&& handler) {
+	Packet* response = nullptr;
+	Packet* packet = readPacket(response);
+
+	if (packet == nullptr) return nullptr;
+
+	response = std::visit(
+	    [&handler, response](auto& concrete) -> Packet* {
+		    using T = std::decay_t<decltype(concrete)>;
+
+		    if constexpr (std::is_same_v<T, std::monostate>) {
+			    return response;
+		    } else if constexpr (std::is_invocable_v<Handler&, T&, typename T::responsePacket_t*>) {
+			    return handler(concrete, static_cast<typename T::responsePacket_t*>(response));
+		    } else {
+			    return response;
+		    }
+	    },
+	    receivedPacket);
 
-	// TODO: Range check
+	finishPacket(packet->callCallbacks(response));
 
-	std::copy_n(buffer.buffer + bufferOffset, size, pointer);
-	bufferOffset += size;
+	return packet;
 }
 
 }  // namespace TMInterface
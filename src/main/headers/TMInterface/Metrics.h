@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "Constants.h"
+#include "Utils/CycleClock.h"
+#include "Utils/Histogram.h"
+
+namespace TMInterface {
+
+struct LatencySummary {
+	int32_t packetId = 0;
+	std::string_view packetName;
+	uint64_t count = 0;
+	// All times in nanoseconds
+	double mean = 0.0;
+	uint64_t min = 0;
+	uint64_t p50 = 0;
+	uint64_t p90 = 0;
+	uint64_t p99 = 0;
+	uint64_t p999 = 0;
+	uint64_t max = 0;
+};
+
+struct MetricsSnapshot {
+	std::chrono::nanoseconds elapsed{0};
+
+	uint64_t packetsSent = 0;
+	uint64_t packetsReceived = 0;
+	uint64_t bytesWritten = 0;
+	uint64_t bytesZeroed = 0;
+	uint64_t simSteps = 0;
+	double simsPerSecond = 0.0;
+
+	// By sent packet id: time until the peer's next packet arrived
+	std::vector<LatencySummary> requestLatency;
+	// By received packet id: time until we sent the next packet, i.e. the client's own processing
+	std::vector<LatencySummary> processingTime;
+};
+
+std::ostream& operator<<(std::ostream& os, const MetricsSnapshot& snapshot);
+
+// Instrumentation of an Interface. Every packet costs one cycle counter read, a histogram increment and a few
+// counters. Histograms record raw ticks, they are only converted to nanoseconds for snapshots. Histograms are only
+// allocated for packet ids that actually show up.
+// Not thread safe, take snapshots on the thread that uses the interface.
+class Metrics {
+protected:
+	using Histograms = std::array<std::unique_ptr<Utils::Histogram>, MAX_PACKET_ID + 1>;
+
+	Histograms requestLatency;
+	Histograms processingTime;
+
+	uint64_t packetsSent;
+	uint64_t packetsReceived;
+	uint64_t bytesWritten;
+	uint64_t bytesZeroed;
+	uint64_t simSteps;
+
+	Utils::CycleClock::Calibration start;
+	uint64_t lastSend;
+	uint64_t lastReceive;
+	int32_t lastSentId;
+	int32_t lastReceivedId;
+
+public:
+	Metrics();
+
+	void onSend(int32_t packetId, size_t bytes);
+	void onReceive(int32_t packetId);
+	void onZero(size_t bytes);
+
+	MetricsSnapshot snapshot() const;
+	void reset();
+
+protected:
+	void record(Histograms& histograms, int32_t packetId, uint64_t ticks);
+
+	static std::vector<LatencySummary> summarize(const Histograms& histograms, double scale);
+};
+
+}  // namespace TMInterface
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <coroutine>
+
+namespace TMInterface {
+
+// Forward declarations
+class Interface;
+class Packet;
+
+// Result of Interface::request and Interface::receive. Awaiting it sends the packet (if any) and suspends the
+// coroutine until the peer answered. The EventLoop the interface is attached to resumes it, and co_await evaluates
+// to the received packet (see Interface::receivePacket).
+class PacketAwaitable {
+protected:
+	Interface& interface;
+	const Packet* packet;
+
+public:
+	PacketAwaitable(Interface& interface, const Packet* packet);
+
+	bool await_ready() const;
+	void await_suspend(std::coroutine_handle<> handle);
+	Packet* await_resume();
+};
+
+}  // namespace TMInterface
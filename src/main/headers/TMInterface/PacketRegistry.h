@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <variant>
+
+namespace TMInterface {
+
+// Forward declaration
+class Packet;
+
+// Compile time list of all packet types. Maps packet ids to types with a flat table, independent of the order of
+// the list, and constructs packets in place inside a variant.
+template <typename... Packets>
+class PacketRegistry {
+public:
+	using Storage = std::variant<std::monostate, Packets...>;
+	using Emplacer = Packet* (*)(Storage&);
+	using Creator = std::unique_ptr<Packet> (*)();
+
+	static constexpr int32_t MAX_ID = std::max({Packets::ID...});
+	static constexpr size_t COUNT = sizeof...(Packets);
+
+protected:
+	static const std::array<Emplacer, MAX_ID + 1> emplacers;
+	static const std::array<Creator, MAX_ID + 1> creators;
+
+public:
+	// Both return nullptr for unknown ids
+	static Packet* emplace(int32_t id, Storage& storage);
+	static std::unique_ptr<Packet> create(int32_t id);
+
+	static constexpr bool isKnown(int32_t id);
+	static constexpr bool hasUniqueIds();
+
+protected:
+	template <typename T>
+	static Packet* emplaceType(Storage& storage);
+	template <typename T>
+	static std::unique_ptr<Packet> createType();
+
+	static constexpr std::array<Emplacer, MAX_ID + 1> makeEmplacers();
+	static constexpr std::array<Creator, MAX_ID + 1> makeCreators();
+};
+
+}  // namespace TMInterface
+
+#define TMInterface_PacketRegistry_Proper_Included
+
+#include "PacketRegistry.inc.h"
+
+#undef TMInterface_PacketRegistry_Proper_Included
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "PacketRegistry.h"
+
+#ifdef TMInterface_PacketRegistry_Proper_Included
+
+namespace TMInterface {
+
+// constexpr functions
+template <typename... Packets>
+constexpr bool PacketRegistry<Packets...>::isKnown(int32_t id) {
+	return (id >= 0) && (id <= MAX_ID) && (makeEmplacers()[id] != nullptr);
+}
+
+template <typename... Packets>
+constexpr bool PacketRegistry<Packets...>::hasUniqueIds() {
+	std::array<size_t, MAX_ID + 1> counts{};
+
+	((++counts[Packets::ID]), ...);
+
+	for (size_t count : counts) {
+		if (count > 1) return false;
+	}
+
+	return true;
+}
+
+template <typename... Packets>
+constexpr std::array<typename PacketRegistry<Packets...>::Emplacer, PacketRegistry<Packets...>::MAX_ID + 1>
+PacketRegistry<Packets...>::makeEmplacers() {
+	std::array<Emplacer, MAX_ID + 1> result{};
+
+	// Indexed by id, so the order of the list doesn't matter
+	((result[Packets::ID] = &emplaceType<Packets>), ...);
+
+	return result;
+}
+
+template <typename... Packets>
+constexpr std::array<typename PacketRegistry<Packets...>::Creator, PacketRegistry<Packets...>::MAX_ID + 1>
+PacketRegistry<Packets...>::makeCreators() {
+	std::array<Creator, MAX_ID + 1> result{};
+
+	((result[Packets::ID] = &createType<Packets>), ...);
+
+	return result;
+}
+
+// template functions
+template <typename... Packets>
+const std::array<typename PacketRegistry<Packets...>::Emplacer, PacketRegistry<Packets...>::MAX_ID + 1>
+    PacketRegistry<Packets...>::emplacers = makeEmplacers();
+
+template <typename... Packets>
+const std::array<typename PacketRegistry<Packets...>::Creator, PacketRegistry<Packets...>::MAX_ID + 1>
+    PacketRegistry<Packets...>::creators = makeCreators();
+
+template <typename... Packets>
+Packet* PacketRegistry<Packets...>::emplace(int32_t id, Storage& storage) {
+	if ((id < 0) || (id > MAX_ID)) return nullptr;
+
+	const Emplacer emplacer = emplacers[id];
+
+	return (emplacer == nullptr) ? nullptr : emplacer(storage);
+}
+
+template <typename... Packets>
+std::unique_ptr<Packet> PacketRegistry<Packets...>::create(int32_t id) {
+	if ((id < 0) || (id > MAX_ID)) return nullptr;
+
+	const Creator creator = creators[id];
+
+	return (creator == nullptr) ? nullptr : creator();
+}
+
+template <typename... Packets>
+template <typename T>
+Packet* PacketRegistry<Packets...>::emplaceType(Storage& storage) {
+	return &storage.template emplace<T>();
+}
+
+template <typename... Packets>
+template <typename T>
+std::unique_ptr<Packet> PacketRegistry<Packets...>::createType() {
+	return std::make_unique<T>();
+}
+
+}  // namespace TMInterface
+
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Constants.h"
+#include "Utils/MappedFile.h"
+
+namespace TMInterface {
+
+enum class TraceDirection : uint8_t { SENT = 0, RECEIVED = 1 };
+
+// Trace files are a TraceFileHeader followed by records. Every record is a TraceRecordHeader and the raw payload
+// (everything after packet id and error code), padded to 8 bytes.
+struct TraceFileHeader {
+	static constexpr std::array<char, 4> MAGIC{'T', 'M', 'T', 'R'};
+	static constexpr uint32_t VERSION = 1;
+
+	std::array<char, 4> magic = MAGIC;
+	uint32_t version = VERSION;
+	// Bytes of complete records after the header. Only advanced once a record is fully written, so the log of a
+	// crashed process can still be read
+	uint64_t length = 0;
+};
+
+struct TraceRecordHeader {
+	// Since the recording started
+	std::chrono::nanoseconds::rep timestamp = 0;
+	int32_t packetId = 0;
+	ErrorCode error = ErrorCode::NONE;
+	uint32_t payloadSize = 0;
+	TraceDirection direction = TraceDirection::SENT;
+	std::array<uint8_t, 3> reserved{};
+};
+
+static_assert(sizeof(TraceRecordHeader) == 24, "Trace records have a fixed layout");
+
+// Appends packets to a memory mapped trace file. Recording a packet is a memcpy into the page cache, the file grows
+// by doubling.
+// Received packets don't carry their length, so they are recorded once the client is done with them (the next packet
+// or the end of the recording), with as many payload bytes as the client read.
+class TraceRecorder {
+public:
+	static constexpr size_t INITIAL_SIZE = 16 * 1024 * 1024;
+
+protected:
+	Utils::MappedFile file;
+	// End of the written records
+	size_t offset;
+	size_t records;
+	std::chrono::steady_clock::time_point start;
+
+	bool pending;
+	TraceRecordHeader pendingHeader;
+
+public:
+	// Throws std::runtime_error if the file can't be created
+	explicit TraceRecorder(const std::string& path);
+	~TraceRecorder();
+
+	// Delete copy stuff
+	TraceRecorder(const TraceRecorder&) = delete;
+	TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+	void recordSent(int32_t packetId, const char* payload, size_t size);
+	void beginReceived(int32_t packetId, ErrorCode error);
+	// Records the packet passed to beginReceived, if there is one
+	void finishReceived(const char* payload, size_t size);
+	bool isPending() const;
+
+	size_t getRecordCount() const;
+	size_t getLength() const;
+
+protected:
+	void append(const TraceRecordHeader& header, const char* payload);
+	TraceFileHeader& getFileHeader();
+	std::chrono::nanoseconds::rep now() const;
+};
+
+// Sequential reader over a trace file. Payloads point into the mapping
+class TraceReader {
+public:
+	struct Record {
+		TraceRecordHeader header;
+		const char* payload = nullptr;
+	};
+
+protected:
+	Utils::MappedFile file;
+	size_t offset;
+	size_t end;
+
+public:
+	// Throws std::runtime_error if the file can't be opened or isn't a trace
+	explicit TraceReader(const std::string& path);
+
+	// Returns false at the end of the trace
+	bool next(Record& record);
+	void rewind();
+};
+
+}  // namespace TMInterface
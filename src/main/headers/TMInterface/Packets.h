@@ -1,11 +1,14 @@
 #pragma once
 
-#include <functional>
-#include <map>
+#include <array>
 #include <memory>
+#include <string_view>
 #include <vector>
 
-#include "Interface.h"
+#include "Constants.h"
+#include "EventBuffer.h"
+#include "PacketRegistry.h"
+#include "SimState.h"
 
 namespace TMInterface {
 
@@ -14,38 +17,54 @@ class Interface;
 
 class Packet {
 public:
-	// Parameters:
-	//   - received packet
-	//   - response packet (may be null)
-	// Returns: response packet (may be null)
-	using callback_t = std::function<std::unique_ptr<Packet>(std::shared_ptr<Packet>, std::unique_ptr<Packet>)>;
+	// Type erased, non owning callback. Doesn't allocate and is called through a single function pointer
+	struct Callback {
+		// Parameters:
+		//   - the callback itself
+		//   - received packet
+		//   - response packet (may be null)
+		// Returns: response packet (may be null)
+		using function_t = Packet* (*)(const Callback& self, Packet& packet, Packet* response);
+
+		function_t function;
+		// Bound object or function, depending on how the callback was registered
+		void* object = nullptr;
+		void (*callback)() = nullptr;
+	};
 
 	const int32_t packetId;
-	const std::string packetName;
+	const std::string_view packetName;
 	const int32_t responsePacketId;
 
 protected:
-	static inline std::map<int32_t, std::function<std::unique_ptr<Packet>()>> registeredPackets{};
-	static std::map<int32_t, std::vector<callback_t>> callbacks;
+	static std::array<std::vector<Callback>, MAX_PACKET_ID + 1> callbacks;
 
 public:
-	Packet(int32_t packetId, const std::string& packetName, int32_t responsePacketId);
+	Packet(int32_t packetId, std::string_view packetName, int32_t responsePacketId);
 	virtual ~Packet();
 
 	virtual void write(Interface& interface) const = 0;
 	virtual void read(Interface& interface) = 0;
 
-	virtual void registerCallback(const callback_t& callback);
-	virtual callback_t::result_type callCallbacks(callback_t::result_type packet);
+	// Runs all callbacks registered for this packet type. Returns the response to send (may be null)
+	Packet* callCallbacks(Packet* response);
+
+	static void addCallback(int32_t packetId, const Callback& callback);
 
-	static int32_t registerPacket(int32_t id, std::function<std::unique_ptr<Packet>()> constructor);
+	// Allocates. Prefer Packets::emplacePacketById
 	static std::unique_ptr<Packet> getPacketById(int32_t id);
+
+protected:
+	template <typename T, typename Response>
+	static Callback bindFunction(Response* (*function)(T&, Response*));
+	template <typename T, typename Response, typename Object>
+	static Callback bindObject(Object& object);
 };
 
 struct EmptyPacket : public Packet {
 	int32_t reserved = 0;
 
-	EmptyPacket(int32_t packetId, const std::string& packetName, int32_t responsePacketId);
+	EmptyPacket(int32_t packetId, std::string_view packetName, int32_t responsePacketId);
 	virtual ~EmptyPacket();
 
 	virtual void write(Interface& interface) const;
@@ -53,94 +72,103 @@ struct EmptyPacket : public Packet {
 };
 
 namespace Packets {
-// Helper variable, to ensure the __COUNTER__ magic works
-constexpr int32_t startCount = __COUNTER__ + 1;
-
 // Little helper declarations for packets that don't have responses
 using NONE = Packet;
 constexpr int32_t NONE_ID = 0;
 
 // Unholy automatic packet declaration macros
-#define ForwardDeclarePacket(name) \
-	class name;                    \
-	extern const int32_t name##_ID;
-
-#define CreateCallback(name, responsePacket)                                                                        \
-	using responsePacket_t = responsePacket;                                                                        \
-	using specializedCallback_t =                                                                                   \
-	    std::function<std::unique_ptr<responsePacket_t>(std::shared_ptr<name>, std::unique_ptr<responsePacket_t>)>; \
-                                                                                                                    \
-	static void registerCallback(const specializedCallback_t& callback);
-#define RegisterPacket(name)         \
-	inline const int32_t name##_ID = \
-	    Packet::registerPacket((__COUNTER__ - startCount) / 2 + 1, [] { return std::make_unique<name>(); });
-
-#define DeclareEmptyPacket(name, responsePacket)                                                       \
-	struct name : public EmptyPacket {                                                                 \
-		inline name() : EmptyPacket((__COUNTER__ - startCount) / 2 + 1, #name, responsePacket##_ID) {} \
-		inline virtual ~name() {}                                                                      \
-                                                                                                       \
-		CreateCallback(name, responsePacket);                                                          \
-	};                                                                                                 \
-	RegisterPacket(name);
-#define DeclarePacket(name, responsePacket, members)                                              \
-	struct name : public Packet {                                                                 \
-		inline name() : Packet((__COUNTER__ - startCount) / 2 + 1, #name, responsePacket##_ID) {} \
-		inline virtual ~name() {}                                                                 \
-		virtual void write(Interface& interface) const;                                           \
-		virtual void read(Interface& interface);                                                  \
-                                                                                                  \
-		CreateCallback(name, responsePacket);                                                     \
-                                                                                                  \
-		members;                                                                                  \
-	};                                                                                            \
-	RegisterPacket(name);
+// The ids are part of the protocol. They are spelled out, so reordering declarations can't change them
+#define ForwardDeclarePacket(name, id) \
+	struct name;                       \
+	constexpr int32_t name##_ID = id;
+
+// Callbacks get the received packet and the prepared response (may be null) and return the response to send
+//   - registerCallback(function) takes plain functions and lambdas without captures
+//   - registerCallback(object) binds any callable by reference. The object has to outlive the registration
+#define CreateCallback(name, responsePacket)                                             \
+	using responsePacket_t = responsePacket;                                             \
+	using callbackFunction_t = responsePacket_t* (*)(name&, responsePacket_t*);          \
+                                                                                         \
+	inline static void registerCallback(callbackFunction_t callback) {                   \
+		Packet::addCallback(ID, Packet::bindFunction<name, responsePacket_t>(callback)); \
+	}                                                                                    \
+	template <typename Object>                                                           \
+	inline static void registerCallback(Object& object) {                                \
+		Packet::addCallback(ID, Packet::bindObject<name, responsePacket_t>(object));     \
+	}
+
+#define DeclareEmptyPacket(name, responsePacket)                       \
+	struct name : public EmptyPacket {                                 \
+		static constexpr int32_t ID = name##_ID;                       \
+                                                                       \
+		inline name() : EmptyPacket(ID, #name, responsePacket##_ID) {} \
+		inline virtual ~name() {}                                      \
+                                                                       \
+		CreateCallback(name, responsePacket);                          \
+	};
+#define DeclarePacket(name, responsePacket, members)              \
+	struct name : public Packet {                                 \
+		static constexpr int32_t ID = name##_ID;                  \
+                                                                  \
+		inline name() : Packet(ID, #name, responsePacket##_ID) {} \
+		inline virtual ~name() {}                                 \
+		virtual void write(Interface& interface) const;           \
+		virtual void read(Interface& interface);                  \
+                                                                  \
+		CreateCallback(name, responsePacket);                     \
+                                                                  \
+		members;                                                  \
+	};
 
 // Forward declarations
-ForwardDeclarePacket(S_RESPONSE);
-ForwardDeclarePacket(S_ON_REGISTERED);
-ForwardDeclarePacket(S_SHUTDOWN);
-ForwardDeclarePacket(S_ON_RUN_STEP);
-ForwardDeclarePacket(S_ON_SIM_BEGIN);
-ForwardDeclarePacket(S_ON_SIM_STEP);
-ForwardDeclarePacket(S_ON_SIM_END);
-ForwardDeclarePacket(S_ON_CHECKPOINT_COUNT_CHANGED);
-ForwardDeclarePacket(S_ON_LAPS_COUNT_CHANGED);
-ForwardDeclarePacket(S_ON_CUSTOM_COMMAND);
-ForwardDeclarePacket(S_ON_BRUTEFORCE_EVALUATE);
-ForwardDeclarePacket(C_REGISTER);
-ForwardDeclarePacket(C_DEREGISTER);
-ForwardDeclarePacket(C_PROCESSED_CALL);
-ForwardDeclarePacket(C_SET_INPUT_STATES);
-ForwardDeclarePacket(C_RESPAWN);
-ForwardDeclarePacket(C_SIM_REWIND_TO_STATE);
-ForwardDeclarePacket(C_SIM_GET_STATE);
-ForwardDeclarePacket(C_SIM_GET_EVENT_BUFFER);
-ForwardDeclarePacket(C_GET_CONTEXT_MODE);
-ForwardDeclarePacket(C_SIM_SET_EVENT_BUFFER);
-ForwardDeclarePacket(C_GET_CHECKPOINT_STATE);
-ForwardDeclarePacket(C_SET_CHECKPOINT_STATE);
-ForwardDeclarePacket(C_SET_GAME_SPEED);
-ForwardDeclarePacket(C_EXECUTE_COMMAND);
-ForwardDeclarePacket(C_SET_EXECUTE_COMMANDS);
-ForwardDeclarePacket(C_SET_TIMEOUT);
-ForwardDeclarePacket(C_REMOVE_STATE_VALIDATION);
-ForwardDeclarePacket(C_PREVENT_SIMULATION_FINISH);
-ForwardDeclarePacket(C_REGISTER_CUSTOM_COMMAND);
-ForwardDeclarePacket(C_LOG);
-ForwardDeclarePacket(ANY);
+ForwardDeclarePacket(S_RESPONSE, 1);
+ForwardDeclarePacket(S_ON_REGISTERED, 2);
+ForwardDeclarePacket(S_SHUTDOWN, 3);
+ForwardDeclarePacket(S_ON_RUN_STEP, 4);
+ForwardDeclarePacket(S_ON_SIM_BEGIN, 5);
+ForwardDeclarePacket(S_ON_SIM_STEP, 6);
+ForwardDeclarePacket(S_ON_SIM_END, 7);
+ForwardDeclarePacket(S_ON_CHECKPOINT_COUNT_CHANGED, 8);
+ForwardDeclarePacket(S_ON_LAPS_COUNT_CHANGED, 9);
+ForwardDeclarePacket(S_ON_CUSTOM_COMMAND, 10);
+ForwardDeclarePacket(S_ON_BRUTEFORCE_EVALUATE, 11);
+ForwardDeclarePacket(C_REGISTER, 12);
+ForwardDeclarePacket(C_DEREGISTER, 13);
+ForwardDeclarePacket(C_PROCESSED_CALL, 14);
+ForwardDeclarePacket(C_SET_INPUT_STATES, 15);
+ForwardDeclarePacket(C_RESPAWN, 16);
+ForwardDeclarePacket(C_SIM_REWIND_TO_STATE, 17);
+ForwardDeclarePacket(C_SIM_GET_STATE, 18);
+ForwardDeclarePacket(C_SIM_GET_EVENT_BUFFER, 19);
+ForwardDeclarePacket(C_GET_CONTEXT_MODE, 20);
+ForwardDeclarePacket(C_SIM_SET_EVENT_BUFFER, 21);
+ForwardDeclarePacket(C_GET_CHECKPOINT_STATE, 22);
+ForwardDeclarePacket(C_SET_CHECKPOINT_STATE, 23);
+ForwardDeclarePacket(C_SET_GAME_SPEED, 24);
+ForwardDeclarePacket(C_EXECUTE_COMMAND, 25);
+ForwardDeclarePacket(C_SET_EXECUTE_COMMANDS, 26);
+ForwardDeclarePacket(C_SET_TIMEOUT, 27);
+ForwardDeclarePacket(C_REMOVE_STATE_VALIDATION, 28);
+ForwardDeclarePacket(C_PREVENT_SIMULATION_FINISH, 29);
+ForwardDeclarePacket(C_REGISTER_CUSTOM_COMMAND, 30);
+ForwardDeclarePacket(C_LOG, 31);
+ForwardDeclarePacket(ANY, 32);
+// Newer than ANY, which keeps the id it always had
+ForwardDeclarePacket(C_SIM_REWIND_TO_TIME, 33);
 
 // Actual declarations
-DeclarePacket(S_RESPONSE, NONE, int32_t test = 0; int32_t test2 = 0;);
+// The payload depends on the call it answers, so nothing is read up front. Read it right after receiving, for
+// example with SimStateView::read or EventBufferView::read
+DeclarePacket(S_RESPONSE, NONE, const char* payload = nullptr;);
 
 DeclareEmptyPacket(S_ON_REGISTERED, C_PROCESSED_CALL);
 DeclareEmptyPacket(S_SHUTDOWN, NONE);
-DeclareEmptyPacket(S_ON_RUN_STEP, NONE);
+DeclarePacket(S_ON_RUN_STEP, NONE, CallOnRunStepData data;);
 DeclareEmptyPacket(S_ON_SIM_BEGIN, NONE);
-DeclareEmptyPacket(S_ON_SIM_STEP, NONE);
-DeclareEmptyPacket(S_ON_SIM_END, NONE);
-DeclareEmptyPacket(S_ON_CHECKPOINT_COUNT_CHANGED, NONE);
-DeclareEmptyPacket(S_ON_LAPS_COUNT_CHANGED, NONE);
+DeclarePacket(S_ON_SIM_STEP, NONE, CallOnSimStepData data;);
+DeclarePacket(S_ON_SIM_END, NONE, CallOnSimEndData data;);
+DeclarePacket(S_ON_CHECKPOINT_COUNT_CHANGED, NONE, CallOnCheckpointCountChangedData data;);
+DeclarePacket(S_ON_LAPS_COUNT_CHANGED, NONE, CallOnLapsCountChangedData data;);
 DeclareEmptyPacket(S_ON_CUSTOM_COMMAND, NONE);
 DeclareEmptyPacket(S_ON_BRUTEFORCE_EVALUATE, NONE);
 DeclareEmptyPacket(C_REGISTER, S_ON_REGISTERED);
@@ -148,13 +176,14 @@ DeclareEmptyPacket(C_DEREGISTER, NONE);
 
 DeclarePacket(C_PROCESSED_CALL, NONE, int32_t which = ANY_ID;);
 
-DeclareEmptyPacket(C_SET_INPUT_STATES, NONE);
+DeclarePacket(C_SET_INPUT_STATES, NONE, SetInputStatesData data;);
 DeclareEmptyPacket(C_RESPAWN, NONE);
-DeclareEmptyPacket(C_SIM_REWIND_TO_STATE, NONE);
+// Only the chunks selected by chunks are sent, see SimStateView::write
+DeclarePacket(C_SIM_REWIND_TO_STATE, NONE, SimStateView state; uint32_t chunks = HAS_ALL;);
 DeclareEmptyPacket(C_SIM_GET_STATE, NONE);
 DeclareEmptyPacket(C_SIM_GET_EVENT_BUFFER, NONE);
 DeclareEmptyPacket(C_GET_CONTEXT_MODE, NONE);
-DeclareEmptyPacket(C_SIM_SET_EVENT_BUFFER, NONE);
+DeclarePacket(C_SIM_SET_EVENT_BUFFER, NONE, EventBufferView buffer;);
 DeclareEmptyPacket(C_GET_CHECKPOINT_STATE, NONE);
 DeclareEmptyPacket(C_SET_CHECKPOINT_STATE, NONE);
 DeclareEmptyPacket(C_SET_GAME_SPEED, NONE);
@@ -166,16 +195,88 @@ DeclareEmptyPacket(C_PREVENT_SIMULATION_FINISH, NONE);
 DeclareEmptyPacket(C_REGISTER_CUSTOM_COMMAND, NONE);
 DeclareEmptyPacket(C_LOG, NONE);
 DeclareEmptyPacket(ANY, NONE);
+// Rewinds to a state the server saved earlier in the current simulation. Answered with an error if it has none for
+// that time
+DeclarePacket(C_SIM_REWIND_TO_TIME, NONE, SimRewindToTimeData data;);
 
 // Remove evil marcos
 #undef ForwardDeclarePacket
 
 #undef CreateCallback
-#undef RegisterPacket
 
 #undef DeclareEmptyPacket
 #undef DeclarePacket
 
+// Every packet the protocol knows. Order doesn't matter, dispatch goes by id
+using Registry = PacketRegistry<S_RESPONSE,
+                                S_ON_REGISTERED,
+                                S_SHUTDOWN,
+                                S_ON_RUN_STEP,
+                                S_ON_SIM_BEGIN,
+                                S_ON_SIM_STEP,
+                                S_ON_SIM_END,
+                                S_ON_CHECKPOINT_COUNT_CHANGED,
+                                S_ON_LAPS_COUNT_CHANGED,
+                                S_ON_CUSTOM_COMMAND,
+                                S_ON_BRUTEFORCE_EVALUATE,
+                                C_REGISTER,
+                                C_DEREGISTER,
+                                C_PROCESSED_CALL,
+                                C_SET_INPUT_STATES,
+                                C_RESPAWN,
+                                C_SIM_REWIND_TO_STATE,
+                                C_SIM_GET_STATE,
+                                C_SIM_GET_EVENT_BUFFER,
+                                C_GET_CONTEXT_MODE,
+                                C_SIM_SET_EVENT_BUFFER,
+                                C_GET_CHECKPOINT_STATE,
+                                C_SET_CHECKPOINT_STATE,
+                                C_SET_GAME_SPEED,
+                                C_EXECUTE_COMMAND,
+                                C_SET_EXECUTE_COMMANDS,
+                                C_SET_TIMEOUT,
+                                C_REMOVE_STATE_VALIDATION,
+                                C_PREVENT_SIMULATION_FINISH,
+                                C_REGISTER_CUSTOM_COMMAND,
+                                C_LOG,
+                                ANY,
+                                C_SIM_REWIND_TO_TIME>;
+using PacketStorage = Registry::Storage;
+
+static_assert(Registry::hasUniqueIds(), "Packet ids have to be unique");
+
+// Constructs the packet with the given id inside storage, without allocating. Returns nullptr for unknown ids
+inline Packet* emplacePacketById(int32_t id, PacketStorage& storage) {
+	return Registry::emplace(id, storage);
+}
+
 }  // namespace Packets
 
+static_assert(Packets::Registry::MAX_ID <= MAX_PACKET_ID, "MAX_PACKET_ID too small");
+
+// template functions
+template <typename T, typename Response>
+Packet::Callback Packet::bindFunction(Response* (*function)(T&, Response*)) {
+	Callback result{[](const Callback& self, Packet& packet, Packet* response) -> Packet* {
+		const auto bound = reinterpret_cast<Response* (*)(T&, Response*)>(self.callback);
+
+		return bound(static_cast<T&>(packet), static_cast<Response*>(response));
+	}};
+
+	result.callback = reinterpret_cast<void (*)()>(function);
+
+	return result;
+}
+
+template <typename T, typename Response, typename Object>
+Packet::Callback Packet::bindObject(Object& object) {
+	Callback result{[](const Callback& self, Packet& packet, Packet* response) -> Packet* {
+		return (*static_cast<Object*>(self.object))(static_cast<T&>(packet), static_cast<Response*>(response));
+	}};
+
+	result.object = static_cast<void*>(&object);
+
+	return result;
+}
+
 }  // namespace TMInterface
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Structs.h"
+
+namespace TMInterface {
+
+// Forward declarations
+class Interface;
+class SimState;
+
+// Non owning array, the parts of std::span we need
+template <typename T>
+struct ArrayView {
+	const T* data = nullptr;
+	size_t size = 0;
+
+	constexpr const T* begin() const;
+	constexpr const T* end() const;
+	constexpr const T& operator[](size_t index) const;
+};
+
+// Part of SimStateData that a SimStateFlags bit selects
+struct SimStateChunk {
+	SimStateFlags flag;
+	size_t offset;
+	size_t size;
+};
+
+// Non owning view of a SimStateData including its checkpoint arrays. Can point straight into the mapped buffer, so
+// states can be inspected without copying them. Views into the buffer stay valid until the next packet is sent or
+// received on that interface. Call toOwned() to keep the state around.
+class SimStateView {
+public:
+	// Where the game keeps things inside the state chunks. The orientation takes 16 bytes, the emulator only uses the
+	// first float as yaw
+	static constexpr size_t RACE_TIME_OFFSET = 0x4;    // timers
+	static constexpr size_t POSITION_OFFSET = 500;     // state2
+	static constexpr size_t VELOCITY_OFFSET = 536;     // state2
+	static constexpr size_t ORIENTATION_OFFSET = 560;  // state2
+
+	// In the order they are laid out, between flags and numRespawns
+	static constexpr std::array<SimStateChunk, 8> CHUNKS{{
+	    {HAS_TIMERS, offsetof(SimStateData, timers), sizeof(SimStateData::timers)},
+	    {HAS_STATE_1, offsetof(SimStateData, state1), sizeof(SimStateData::state1)},
+	    {HAS_STATE_2, offsetof(SimStateData, state2), sizeof(SimStateData::state2)},
+	    {HAS_STATE_3, offsetof(SimStateData, state3), sizeof(SimStateData::state3)},
+	    {HAS_STATE_4, offsetof(SimStateData, state4), sizeof(SimStateData::state4)},
+	    {HAS_CMD_BUFFER_CORE, offsetof(SimStateData, cmdBufferCore), sizeof(SimStateData::cmdBufferCore)},
+	    {HAS_PLAYER_INFO, offsetof(SimStateData, playerInfo), sizeof(SimStateData::playerInfo)},
+	    {HAS_INPUT_STATE, offsetof(SimStateData, inputRunningState), 8 * sizeof(int32_t)},
+	}};
+
+	const SimStateData* data;
+	ArrayView<uint32_t> cpStates;
+	ArrayView<CheckpointTime> cpTimes;
+
+public:
+	SimStateView();
+	SimStateView(const SimState& state);
+
+	bool isValid() const;
+	size_t getSize() const;
+
+	int32_t getRaceTime() const;
+	Vec3 getPosition() const;
+	Vec3 getVelocity() const;
+	// Checkpoints taken so far, in this lap
+	uint32_t getCheckpointCount() const;
+	// Flags of the chunks that differ from the other state
+	uint32_t diffChunks(const SimStateView& other) const;
+
+	SimState toOwned() const;
+
+	void write(Interface& interface) const;
+	// Only writes the chunks that are selected and have their flag set, and sends just those flags. The rest is skipped
+	// and stays zero, so neither side has to write or clear it
+	void write(Interface& interface, uint32_t chunks) const;
+	// Views the state at the current position of the interface's buffer. Chunks without their flag aren't part of the
+	// message and can hold anything
+	static SimStateView read(Interface& interface);
+};
+
+class SimState {
+public:
+	SimStateData data;
+	std::vector<uint32_t> cpStates;
+	std::vector<CheckpointTime> cpTimes;
+
+public:
+	SimStateView view() const;
+	// Takes over the chunks selected by flags and the checkpoint arrays if they match ours in size, like the game does
+	// on a rewind
+	void assignChunks(const SimStateView& state, uint32_t flags);
+};
+
+// constexpr functions
+template <typename T>
+constexpr const T* ArrayView<T>::begin() const {
+	return data;
+}
+
+template <typename T>
+constexpr const T* ArrayView<T>::end() const {
+	return data + size;
+}
+
+template <typename T>
+constexpr const T& ArrayView<T>::operator[](size_t index) const {
+	return data[index];
+}
+
+}  // namespace TMInterface
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace TMInterface {
+
+// Data layouts of the packet payloads, as they appear in the shared buffer
+
+enum class ContextMode : uint32_t { SIMULATION = 0, RUN = 1 };
+
+enum class SimValidationResult : uint32_t { INVALID = 0, VALID = 1, WRONG_SIMULATION = 2 };
+
+struct GetContextModeData {
+	ContextMode mode = ContextMode::RUN;
+};
+
+// TODO: revise this, add gas and fix type of steer (or not)
+struct SetInputStatesData {
+	int32_t left = -1;
+	int32_t right = -1;
+	int32_t up = -1;
+	int32_t down = -1;
+	int32_t steer = std::numeric_limits<int32_t>::max();
+	int32_t gas = std::numeric_limits<int32_t>::max();
+};
+
+struct SimRewindToTimeData {
+	uint32_t time = 0;
+};
+
+struct SetGameSpeedData {
+	double speed = 1.0;
+};
+
+struct SetExecuteCommandsData {
+	bool enable = true;
+};
+
+struct SetTimeoutData {
+	int32_t timeout = -1;
+};
+
+struct CallOnRunStepData {
+	int32_t time = 0;
+};
+
+struct CallOnSimStepData {
+	uint32_t time = 0;
+};
+
+struct CallOnSimEndData {
+	uint32_t result = 0;
+};
+
+struct CallOnCheckpointCountChangedData {
+	uint32_t current = 0;
+	uint32_t target = 0;
+};
+
+struct CallOnLapsCountChangedData {
+	uint32_t current = 0;
+};
+
+enum SimStateFlags : uint32_t {
+	HAS_TIMERS = 0x1,
+	HAS_STATE_1 = 0x2,
+	HAS_STATE_2 = 0x4,
+	HAS_STATE_3 = 0x8,
+	HAS_STATE_4 = 0x10,
+	HAS_CMD_BUFFER_CORE = 0x20,
+	HAS_INPUT_STATE = 0x40,
+	HAS_PLAYER_INFO = 0x80,
+
+	HAS_ALL = 0xFF
+};
+
+struct CheckpointTime {
+	int32_t time = -1;
+	int32_t stuntsScore = 0;
+};
+
+// World coordinates, y is up
+struct Vec3 {
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+struct SimStateData {
+	uint32_t contextMode = 0;
+	uint32_t flags = 0;
+	std::array<unsigned char, 212> timers{};
+	std::array<unsigned char, 820> state1{};
+	std::array<unsigned char, 2180> state2{};
+	std::array<unsigned char, 3056> state3{};
+	std::array<unsigned char, 72> state4{};
+	std::array<unsigned char, 256> cmdBufferCore{};
+	std::array<unsigned char, 944> playerInfo{};
+
+	int32_t inputRunningState = 0;
+	int32_t inputFinishState = 0;
+	int32_t inputAccelerateState = 0;
+	int32_t inputBrakeState = 0;
+	int32_t inputLeftState = 0;
+	int32_t inputRightState = 0;
+	int32_t inputSteerState = 0;
+	int32_t inputGasState = 0;
+	uint32_t numRespawns = 0;
+
+	// uint32_t cpStatesSize;
+	// dynamic: uint32_t[cpStatesSize]
+	// uint32_t cpTimesSize;
+	// dynamic: CheckpointTime[cpTimesSize]
+};
+
+struct CheckpointData {
+	uint32_t currentCpCount = 0;
+	uint32_t currentLapsCount = 0;
+	// uint32_t cpStatesSize;
+	// dynamic: uint32_t[cpStatesSize]
+	// uint32_t cpTimesSize;
+	// dynamic: CheckpointTime[cpTimesSize]
+};
+
+struct SimEventBufferData {
+	uint32_t eventsDuration = 0;
+	// uint32_t eventsSize;
+	// dynamic: InputEvent[eventsSize]
+};
+
+enum class InputType : uint8_t { ACCELERATE = 0, BRAKE = 1, STEER = 2, GAS = 3, LEFT = 4, RIGHT = 5, RESPAWN = 6 };
+
+constexpr size_t INPUT_TYPE_COUNT = 7;
+
+// One entry of the event buffer. The input is applied right before the simulation step at time
+struct InputEvent {
+	uint32_t time = 0;
+	// InputType in the upper 8 bits, the value as signed 24 bit integer in the lower 24 bits
+	uint32_t data = 0;
+
+	constexpr InputType getType() const;
+	constexpr int32_t getValue() const;
+
+	static constexpr InputEvent make(uint32_t time, InputType type, int32_t value);
+};
+
+// constexpr functions
+constexpr InputType InputEvent::getType() const {
+	return static_cast<InputType>(data >> 24);
+}
+
+constexpr int32_t InputEvent::getValue() const {
+	// Sign extend the lower 24 bits
+	return static_cast<int32_t>((data & 0xFFFFFF) ^ 0x800000) - 0x800000;
+}
+
+constexpr InputEvent InputEvent::make(uint32_t time, InputType type, int32_t value) {
+	return InputEvent{time, (static_cast<uint32_t>(type) << 24) | (static_cast<uint32_t>(value) & 0xFFFFFF)};
+}
+
+}  // namespace TMInterface
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Interface.h"
+#include "PacketTrace.h"
+
+namespace TMInterface {
+
+// Plays the received packets of a trace back into a private buffer, without a game on the other side. Everything on
+// top of the interface (callbacks, handlers, SimStateView::read, coroutines) runs like in the recorded session, so the
+// client side can be profiled alone. Whatever the client sends is ignored.
+class TraceReplayer : public Interface {
+protected:
+	TraceReader reader;
+	size_t replayed;
+
+public:
+	explicit TraceReplayer(const std::string& tracePath, const std::string& bufferName = "TMInterfaceReplay");
+
+	// Puts the next received packet of the trace into the buffer, where receivePacket() finds it like a live packet.
+	// Returns false at the end of the trace
+	bool loadNext();
+	// Dispatches all remaining received packets through receivePacket(). Returns how many there were
+	size_t replay();
+	// Starts over at the beginning of the trace
+	void rewind();
+
+	size_t getReplayedCount() const;
+};
+
+}  // namespace TMInterface
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace TMInterface {
+namespace Utils {
+
+// Sequential reader/writer over a raw buffer. Keeps track of the parts of the buffer it touched since the last zero(),
+// so only those need to be cleared again. Parts that were skipped stay untouched.
+template <size_t BUF_SIZE>
+class BufferCursor {
+public:
+	char* buffer;
+
+	// Touched ranges beyond this are merged into the last one
+	static constexpr size_t MAX_SPANS = 16;
+
+protected:
+	struct Span {
+		size_t begin;
+		size_t end;
+	};
+
+	size_t offset;
+	// End of what was touched since the last zero() or rewind()
+	size_t highWater;
+	std::array<Span, MAX_SPANS> spans;
+	size_t spanCount;
+
+public:
+	BufferCursor(char* buffer);
+
+	size_t getOffset() const;
+	size_t getHighWater() const;
+	// Bytes the next zero() clears
+	size_t getDirtySize() const;
+
+	void seek(size_t position);
+	void skip(size_t amount);
+	// Back to the start to read what the peer wrote. Unlike seek(0), the high water mark starts over, so it only
+	// covers what is read from here on. What was touched before is still cleared by the next zero()
+	void rewind();
+
+	// Clears everything touched since the last zero() and rewinds to the start
+	void zero();
+	// Clears the whole buffer, for when the peer could have written past anything we touched
+	void zeroAll();
+
+	template <typename T>
+	void writeObj(const T& obj);
+	template <typename T>
+	void readObj(T& obj);
+
+	// Writes/reads at a fixed position. Overruns are rejected at compile time
+	template <size_t POSITION, typename T>
+	void writeAt(const T& obj);
+	template <size_t POSITION, typename T>
+	void readAt(T& obj);
+
+	void writeBytes(const void* data, size_t size);
+	void readBytes(void* data, size_t size);
+
+	// Pointer to the next size bytes without copying them. Advances the cursor
+	const char* view(size_t size);
+
+protected:
+	void checkRange(size_t position, size_t size) const;
+	void touch(size_t begin, size_t end);
+};
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#define TMInterface_Utils_BufferCursor_Proper_Included
+
+#include "BufferCursor.inc.h"
+
+#undef TMInterface_Utils_BufferCursor_Proper_Included
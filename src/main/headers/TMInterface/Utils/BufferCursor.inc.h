@@ -0,0 +1,194 @@
+#pragma once
+
+#include "BufferCursor.h"
+
+#ifdef TMInterface_Utils_BufferCursor_Proper_Included
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace TMInterface {
+namespace Utils {
+
+template <size_t BUF_SIZE>
+BufferCursor<BUF_SIZE>::BufferCursor(char* buffer)
+    : buffer(buffer), offset(0), highWater(0), spans(), spanCount(0) {}
+
+template <size_t BUF_SIZE>
+size_t BufferCursor<BUF_SIZE>::getOffset() const {
+	return offset;
+}
+
+template <size_t BUF_SIZE>
+size_t BufferCursor<BUF_SIZE>::getHighWater() const {
+	return highWater;
+}
+
+template <size_t BUF_SIZE>
+size_t BufferCursor<BUF_SIZE>::getDirtySize() const {
+	size_t size = 0;
+
+	for (size_t i = 0; i < spanCount; ++i) size += spans[i].end - spans[i].begin;
+
+	return size;
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::seek(size_t position) {
+	checkRange(position, 0);
+
+	offset = position;
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::skip(size_t amount) {
+	seek(offset + amount);
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::rewind() {
+	offset = 0;
+	highWater = 0;
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::zero() {
+	for (size_t i = 0; i < spanCount; ++i) std::fill(buffer + spans[i].begin, buffer + spans[i].end, 0);
+
+	offset = 0;
+	highWater = 0;
+	spanCount = 0;
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::zeroAll() {
+	spanCount = 0;
+	touch(0, BUF_SIZE);
+
+	zero();
+}
+
+template <size_t BUF_SIZE>
+template <typename T>
+void BufferCursor<BUF_SIZE>::writeObj(const T& obj) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be written to the buffer");
+	static_assert(sizeof(T) <= BUF_SIZE, "Object doesn't fit into the buffer");
+
+	writeBytes(&obj, sizeof(T));
+}
+
+template <size_t BUF_SIZE>
+template <typename T>
+void BufferCursor<BUF_SIZE>::readObj(T& obj) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be read from the buffer");
+	static_assert(sizeof(T) <= BUF_SIZE, "Object doesn't fit into the buffer");
+
+	readBytes(&obj, sizeof(T));
+}
+
+template <size_t BUF_SIZE>
+template <size_t POSITION, typename T>
+void BufferCursor<BUF_SIZE>::writeAt(const T& obj) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be written to the buffer");
+	static_assert((POSITION + sizeof(T)) <= BUF_SIZE, "Object doesn't fit into the buffer at this position");
+
+	const char* pointer = reinterpret_cast<const char*>(&obj);
+
+	std::copy_n(pointer, sizeof(T), buffer + POSITION);
+	touch(POSITION, POSITION + sizeof(T));
+}
+
+template <size_t BUF_SIZE>
+template <size_t POSITION, typename T>
+void BufferCursor<BUF_SIZE>::readAt(T& obj) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be read from the buffer");
+	static_assert((POSITION + sizeof(T)) <= BUF_SIZE, "Object doesn't fit into the buffer at this position");
+
+	char* pointer = reinterpret_cast<char*>(&obj);
+
+	std::copy_n(buffer + POSITION, sizeof(T), pointer);
+	touch(POSITION, POSITION + sizeof(T));
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::writeBytes(const void* data, size_t size) {
+	checkRange(offset, size);
+
+	const char* pointer = static_cast<const char*>(data);
+
+	std::copy_n(pointer, size, buffer + offset);
+	offset += size;
+	touch(offset - size, offset);
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::readBytes(void* data, size_t size) {
+	checkRange(offset, size);
+
+	char* pointer = static_cast<char*>(data);
+
+	std::copy_n(buffer + offset, size, pointer);
+	offset += size;
+	touch(offset - size, offset);
+}
+
+template <size_t BUF_SIZE>
+const char* BufferCursor<BUF_SIZE>::view(size_t size) {
+	checkRange(offset, size);
+
+	const char* pointer = buffer + offset;
+
+	offset += size;
+	touch(offset - size, offset);
+
+	return pointer;
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::checkRange(size_t position, size_t size) const {
+	if ((position <= BUF_SIZE) && (size <= (BUF_SIZE - position))) return;
+
+	std::ostringstream stream;
+	stream << "Range " << position << " to " << (position + size) << " out of buffer range 0 to " << BUF_SIZE;
+
+	throw std::out_of_range(stream.str());
+}
+
+template <size_t BUF_SIZE>
+void BufferCursor<BUF_SIZE>::touch(size_t begin, size_t end) {
+	if (begin == end) return;
+
+	highWater = std::max(highWater, end);
+
+	// Newest first, that's where sequential access continues. Reading back what was written goes into the same span,
+	// so it isn't counted twice
+	for (size_t i = spanCount; i > 0; --i) {
+		Span& span = spans[i - 1];
+
+		if ((begin <= span.end) && (end >= span.begin)) {
+			span.begin = std::min(span.begin, begin);
+			span.end = std::max(span.end, end);
+
+			return;
+		}
+	}
+
+	// Out of spans. Clearing a bit more than needed is fine
+	if (spanCount == MAX_SPANS) {
+		Span& last = spans[spanCount - 1];
+
+		last.begin = std::min(last.begin, begin);
+		last.end = std::max(last.end, end);
+
+		return;
+	}
+
+	spans[spanCount++] = Span{begin, end};
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#endif
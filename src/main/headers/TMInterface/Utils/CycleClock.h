@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TMInterface_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TMInterface_HAS_RDTSC
+#endif
+
+namespace TMInterface {
+namespace Utils {
+
+// Cheapest available timestamp. Reads the time stamp counter on x86, which costs a fraction of a steady_clock call.
+// Ticks have no fixed unit, convert them with a Calibration taken over a longer stretch of time.
+struct CycleClock {
+	struct Calibration {
+		uint64_t ticks;
+		std::chrono::steady_clock::time_point time;
+
+		static Calibration now();
+		// Nanoseconds per tick between two calibrations
+		static double getScale(const Calibration& from, const Calibration& to);
+	};
+
+	static uint64_t now();
+};
+
+// inline functions
+inline uint64_t CycleClock::now() {
+#ifdef TMInterface_HAS_RDTSC
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline CycleClock::Calibration CycleClock::Calibration::now() {
+	return Calibration{CycleClock::now(), std::chrono::steady_clock::now()};
+}
+
+inline double CycleClock::Calibration::getScale(const Calibration& from, const Calibration& to) {
+	const double nanoseconds = std::chrono::duration<double, std::nano>(to.time - from.time).count();
+	const double ticks = static_cast<double>(to.ticks - from.ticks);
+
+	return (ticks > 0.0) ? (nanoseconds / ticks) : 1.0;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#undef TMInterface_HAS_RDTSC
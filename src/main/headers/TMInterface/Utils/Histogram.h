@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace TMInterface {
+namespace Utils {
+
+// Log-linear histogram in the style of HdrHistogram. Every power of two is split into 2^SUB_BITS linear sub buckets,
+// which keeps the relative error of every reported value below 2^-SUB_BITS (~3%) at a fixed 8 KiB. Recording is a
+// bit scan and an increment. Values at or above 2^MAX_BITS are clamped.
+class Histogram {
+public:
+	static constexpr uint32_t SUB_BITS = 5;
+	static constexpr uint32_t MAX_BITS = 36;
+	static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BITS;
+	static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+	static constexpr uint64_t MAX_VALUE = (uint64_t{1} << MAX_BITS) - 1;
+
+protected:
+	std::array<uint64_t, BUCKETS> counts;
+	uint64_t total;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+
+public:
+	Histogram();
+
+	void record(uint64_t value);
+	void merge(const Histogram& other);
+	void reset();
+
+	uint64_t getCount() const;
+	uint64_t getMin() const;
+	uint64_t getMax() const;
+	double getMean() const;
+	// Highest value equivalent to the one at the given percentile (0 to 100)
+	uint64_t getPercentile(double percentile) const;
+
+protected:
+	static size_t getIndex(uint64_t value);
+	static uint64_t getHighestValue(size_t index);
+};
+
+// inline functions
+inline size_t Histogram::getIndex(uint64_t value) {
+	if (value > MAX_VALUE) value = MAX_VALUE;
+
+	// Values below 2 * SUB_BUCKETS map one to one
+	if (value < (2 * SUB_BUCKETS)) return static_cast<size_t>(value);
+
+#ifdef _MSC_VER
+	unsigned long highest;
+	_BitScanReverse64(&highest, value);
+#else
+	const uint32_t highest = 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+
+	const uint32_t shift = static_cast<uint32_t>(highest) - SUB_BITS;
+
+	return (shift * SUB_BUCKETS) + static_cast<size_t>(value >> shift);
+}
+
+inline void Histogram::record(uint64_t value) {
+	++counts[getIndex(value)];
+	++total;
+	sum += value;
+
+	if (value < min) min = value;
+	if (value > max) max = value;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Statements below this level are compiled out. 0 = TRACE, 1 = DEBUG, 2 = INFO, 3 = WARNING, 4 = ERROR, 5 = NONE
+#ifndef TMINTERFACE_LOG_LEVEL
+#define TMINTERFACE_LOG_LEVEL 2
+#endif
+
+namespace TMInterface {
+namespace Utils {
+
+enum class LogLevel : uint8_t { TRACE = 0, DEBUG = 1, INFO = 2, WARNING = 3, ERROR = 4, NONE = 5 };
+
+constexpr LogLevel COMPILED_LOG_LEVEL = static_cast<LogLevel>(TMINTERFACE_LOG_LEVEL);
+
+std::ostream& operator<<(std::ostream& os, LogLevel level);
+
+// Copy of a short string, for logging strings that might not outlive the statement. Longer strings are cut off
+class LogString {
+public:
+	static constexpr size_t CAPACITY = 47;
+
+protected:
+	std::array<char, CAPACITY> characters;
+	uint8_t length;
+
+public:
+	LogString(std::string_view string);
+
+	friend std::ostream& operator<<(std::ostream& os, const LogString& string);
+};
+
+// Asynchronous logger. A log statement copies its arguments into a ring buffer owned by the calling thread, and a
+// background thread formats and writes them. The hot path never formats, allocates, locks or flushes. If a ring is
+// full, the statement is dropped and counted.
+// Arguments have to be trivially copyable, std::string is copied into a LogString. Pointers (including const char* and
+// std::string_view) are formatted later, so they have to point to something that lives on, e.g. string literals.
+class Logger {
+public:
+	static constexpr size_t RECORD_SIZE = 128;
+	static constexpr size_t RING_SIZE = 1024;
+
+	using FormatFunction = void (*)(std::ostream& os, const void* arguments);
+
+	struct Record {
+		FormatFunction format;
+		LogLevel level;
+		alignas(8) std::array<unsigned char, RECORD_SIZE - 16> arguments;
+	};
+
+	static_assert(sizeof(Record) == RECORD_SIZE, "Records should fill a slot exactly");
+
+protected:
+	// Single producer (the owning thread), single consumer (the background thread)
+	struct Ring {
+		alignas(64) std::atomic<size_t> head{0};
+		// Set when the owning thread exited. The background thread frees the ring once it wrote the rest
+		std::atomic_bool orphaned{false};
+		alignas(64) std::atomic<size_t> tail{0};
+		alignas(64) std::array<Record, RING_SIZE> records;
+	};
+
+	// Thread local handle of a ring, which orphans it when the thread exits
+	struct RingOwner {
+		std::shared_ptr<Ring> ring;
+
+		~RingOwner();
+	};
+
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::vector<std::shared_ptr<Ring>> rings;
+	std::ostream* output;
+	std::atomic<LogLevel> level;
+	std::atomic<uint64_t> dropped;
+	uint64_t reportedDropped;
+	std::atomic_bool running;
+	std::thread thread;
+
+public:
+	static Logger& getInstance();
+
+	~Logger();
+
+	// Statements below this level are skipped at runtime, on top of TMINTERFACE_LOG_LEVEL
+	void setLevel(LogLevel level);
+	LogLevel getLevel() const;
+	void setOutput(std::ostream& output);
+	// Total number of statements dropped because a ring was full
+	uint64_t getDropped() const;
+	// Rings of running threads, plus those of exited threads that weren't written out yet
+	size_t getRingCount();
+
+	// Blocks until everything logged so far was written
+	void flush();
+
+	template <LogLevel LEVEL, typename... Args>
+	void log(const Args&... args);
+
+protected:
+	Logger();
+
+	Ring& getRing();
+	void run();
+	// Writes out everything in the rings and frees the orphaned ones. Returns whether there was anything
+	bool drain();
+
+	template <typename... Args>
+	static void format(std::ostream& os, const void* arguments);
+};
+
+// Logs the arguments, streamed one after another, if LEVEL is enabled
+template <LogLevel LEVEL, typename... Args>
+void log(const Args&... args);
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#define TMInterface_Utils_Log_Proper_Included
+
+#include "Log.inc.h"
+
+#undef TMInterface_Utils_Log_Proper_Included
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Log.h"
+
+#ifdef TMInterface_Utils_Log_Proper_Included
+
+#include <new>
+#include <tuple>
+#include <type_traits>
+
+namespace TMInterface {
+namespace Utils {
+
+namespace LogDetail {
+
+// std::string can't be stored in a record, everything else is stored as is
+template <typename T>
+struct Stored {
+	using type = T;
+};
+
+template <>
+struct Stored<std::string> {
+	using type = LogString;
+};
+
+template <size_t N>
+struct Stored<char[N]> {
+	using type = const char*;
+};
+
+}  // namespace LogDetail
+
+// template functions
+template <LogLevel LEVEL, typename... Args>
+void Logger::log(const Args&... args) {
+	using Arguments = std::tuple<typename LogDetail::Stored<Args>::type...>;
+
+	static_assert((std::is_trivially_copyable_v<typename LogDetail::Stored<Args>::type> && ...),
+	              "Log arguments have to be trivially copyable");
+	static_assert(std::is_trivially_destructible_v<Arguments>, "Log arguments have to be trivially destructible");
+	static_assert(sizeof(Arguments) <= sizeof(Record::arguments), "Too many log arguments");
+	static_assert(alignof(Arguments) <= 8, "Log arguments are overaligned");
+
+	if (LEVEL < level.load(std::memory_order_relaxed)) return;
+
+	Ring& ring = getRing();
+
+	const size_t head = ring.head.load(std::memory_order_relaxed);
+
+	if ((head - ring.tail.load(std::memory_order_acquire)) >= RING_SIZE) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Record& record = ring.records[head % RING_SIZE];
+	record.format = &format<typename LogDetail::Stored<Args>::type...>;
+	record.level = LEVEL;
+	new (record.arguments.data()) Arguments(args...);
+
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+template <typename... Args>
+void Logger::format(std::ostream& os, const void* arguments) {
+	std::apply([&os](const auto&... values) { (os << ... << values); },
+	           *static_cast<const std::tuple<Args...>*>(arguments));
+}
+
+template <LogLevel LEVEL, typename... Args>
+void log(const Args&... args) {
+	if constexpr ((LEVEL >= COMPILED_LOG_LEVEL) && (LEVEL != LogLevel::NONE)) {
+		Logger::getInstance().log<LEVEL>(args...);
+	}
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#endif
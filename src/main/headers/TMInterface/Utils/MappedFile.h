@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace TMInterface {
+namespace Utils {
+
+// A regular file mapped into memory. Writes go straight to the page cache, so appending to a log or updating an
+// on disk table is a memcpy. The file survives the process.
+class MappedFile {
+public:
+	enum class Mode : uint8_t {
+		READ,
+		// Created if needed
+		WRITE,
+		// Writable in memory, but the file stays as it is. Pages are copied when first written
+		COPY_ON_WRITE,
+	};
+
+	char* data;
+	size_t size;
+
+protected:
+	const std::string path;
+	const Mode mode;
+	bool opened;
+
+#ifdef _WIN32
+	void* hFile;
+	void* hMapFile;
+#else
+	int fd;
+#endif
+
+public:
+	// Writable files are created if needed and grown to at least size bytes. Other files are mapped as a whole
+	MappedFile(const std::string& path, bool writable, size_t size = 0, bool printErrors = true);
+	MappedFile(const std::string& path, Mode mode, size_t size = 0, bool printErrors = true);
+	virtual ~MappedFile();
+
+	constexpr bool isOk() const;
+	constexpr operator bool() const;
+
+	const std::string& getPath() const;
+	bool isWritable() const;
+
+	// Grows or shrinks the file and maps it again, so data moves. Returns false on failure
+	bool resize(size_t size, bool printErrors = true);
+	// Writes dirty pages back to the file. Asynchronously only schedules the write back
+	void flush(bool async = true);
+
+	// Delete copy stuff
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+protected:
+	// Implemented by the platform backends (MappedFileWin32.cpp and MappedFilePosix.cpp)
+	bool open(size_t size, bool printErrors);
+	bool map(bool printErrors);
+	void unmap();
+	void close();
+};
+
+// constexpr functions
+constexpr bool MappedFile::isOk() const {
+	return opened;
+}
+
+constexpr MappedFile::operator bool() const {
+	return isOk();
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
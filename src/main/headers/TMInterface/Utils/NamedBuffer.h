@@ -5,27 +5,55 @@
 namespace TMInterface {
 namespace Utils {
 
+struct MappingOptions {
+	// Create the mapping instead of opening an existing one (server side)
+	bool create = false;
+	// Map all pages up front, so the first packet exchange doesn't take page faults
+	bool prefault = true;
+	// Pin the mapping into physical memory
+	bool lock = false;
+	// Try to back the mapping with huge pages. Silently falls back to regular pages
+	bool hugePages = false;
+};
+
 class NamedBuffer {
 public:
 	size_t buf_size;
 	char* buffer;
 
 protected:
+	const std::string bufferName;
+	const MappingOptions options;
+	// Can be larger than buf_size (huge page rounding)
+	size_t mappedSize;
+
+#ifdef _WIN32
 	void* hMapFile;
+#else
+	int fd;
+#endif
 
 public:
-	NamedBuffer(const std::string& bufferName, size_t buf_size, bool printErrors = true);
+	NamedBuffer(const std::string& bufferName, size_t buf_size, bool printErrors = true,
+	            const MappingOptions& options = {});
 	virtual ~NamedBuffer();
 
 	constexpr bool isOk() const;
 	constexpr operator bool() const;
 
+	const std::string& getName() const;
+	const MappingOptions& getOptions() const;
+
 	// Delete copy stuff
 	NamedBuffer(const NamedBuffer&) = delete;
 	NamedBuffer& operator=(const NamedBuffer&) = delete;
 
 protected:
 	void zero();
+
+	// Implemented by the platform backends (NamedBufferWin32.cpp and NamedBufferPosix.cpp)
+	bool map(bool printErrors);
+	void unmap();
 };
 
 // constexpr functions
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace TMInterface {
+namespace Utils {
+
+// The packet id occupies the first 4 bytes of the buffer and the ready byte overlaps its second byte. All accesses to
+// the ready byte go through that 32 bit word, so it can be used with futexes and proper memory ordering.
+class ReadyFlag {
+public:
+	static constexpr uint32_t READY_MASK = 0xFF00;
+	static constexpr uint32_t ID_MASK = 0x00FF;
+
+	// Tuning of the wait backoff. Spinning is skipped on single core machines, where it only delays the peer
+	static constexpr uint32_t SPIN_COUNT = 2'000;
+	static constexpr std::chrono::microseconds MIN_SLEEP{10};
+	static constexpr std::chrono::microseconds MAX_SLEEP{500};
+
+protected:
+	std::atomic<uint32_t>* word;
+
+public:
+	explicit ReadyFlag(char* buffer);
+
+	// Acquire load. Everything the peer wrote before publishing is visible afterwards
+	uint32_t load() const;
+	bool isReady() const;
+
+	// Release store of the ready byte and wakes up waiters, also in other processes
+	void publish();
+	void consume();
+
+	// Waits until the ready byte is set and predicate(packetId) holds. Spins with pause instructions first, then
+	// blocks on the word (futex on Linux) in growing slices, because the game itself never wakes us up.
+	// Returns false on timeout
+	template <typename Predicate>
+	bool wait(Predicate predicate, std::chrono::nanoseconds timeout) const;
+
+protected:
+	// Blocks while *word == expected, at most for timeout
+	void waitOnValue(uint32_t expected, std::chrono::nanoseconds timeout) const;
+	void wakeAll();
+
+	static uint32_t getSpinCount();
+	static void cpuRelax();
+};
+
+// template functions
+template <typename Predicate>
+bool ReadyFlag::wait(Predicate predicate, std::chrono::nanoseconds timeout) const {
+	auto check = [&predicate](uint32_t value) {
+		return ((value & READY_MASK) == READY_MASK) && predicate(static_cast<int32_t>(value & ID_MASK));
+	};
+
+	uint32_t value = load();
+
+	for (uint32_t i = 0, spinCount = getSpinCount(); (i < spinCount) && !check(value); ++i) {
+		cpuRelax();
+		value = load();
+	}
+
+	if (check(value)) return true;
+
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+	std::chrono::nanoseconds slice = MIN_SLEEP;
+
+	while (!check(value)) {
+		const std::chrono::nanoseconds remaining = deadline - std::chrono::steady_clock::now();
+
+		if (remaining <= std::chrono::nanoseconds::zero()) return false;
+
+		waitOnValue(value, (remaining < slice) ? remaining : slice);
+
+		slice = (slice * 2 < MAX_SLEEP) ? (slice * 2) : std::chrono::nanoseconds{MAX_SLEEP};
+		value = load();
+	}
+
+	return true;
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
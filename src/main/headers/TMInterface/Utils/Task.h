@@ -0,0 +1,91 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+
+namespace TMInterface {
+namespace Utils {
+
+// Forward declarations
+template <typename T>
+class Task;
+
+namespace TaskDetail {
+
+struct PromiseBase {
+	// Resumed once the task finished. Set by whoever awaits the task
+	std::coroutine_handle<> continuation;
+	std::exception_ptr exception;
+
+	struct FinalAwaiter {
+		bool await_ready() const noexcept;
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept;
+		void await_resume() const noexcept;
+	};
+
+	std::suspend_always initial_suspend() const noexcept;
+	FinalAwaiter final_suspend() const noexcept;
+	void unhandled_exception();
+};
+
+template <typename T>
+struct Promise : public PromiseBase {
+	std::optional<T> value;
+
+	Task<T> get_return_object();
+	void return_value(T result);
+};
+
+template <>
+struct Promise<void> : public PromiseBase {
+	Task<void> get_return_object();
+	void return_void() const;
+};
+
+}  // namespace TaskDetail
+
+// Lazy coroutine. Nothing runs until the task is awaited (or started by an EventLoop), and awaiting it resumes the
+// awaiting coroutine right after the task finished, without going through a scheduler. Exceptions are passed on to
+// the awaiting coroutine.
+template <typename T = void>
+class Task {
+public:
+	using promise_type = TaskDetail::Promise<T>;
+	using Handle = std::coroutine_handle<promise_type>;
+
+protected:
+	Handle handle;
+
+public:
+	Task();
+	explicit Task(Handle handle);
+	Task(Task&& other) noexcept;
+	Task& operator=(Task&& other) noexcept;
+	~Task();
+
+	// Delete copy stuff
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+
+	bool isValid() const;
+	bool isDone() const;
+	// Runs the task until it suspends for the first time
+	void start();
+	// Throws the exception the task finished with, if any
+	void rethrow() const;
+
+	auto operator co_await() const& noexcept;
+	auto operator co_await() const&& noexcept;
+};
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#define TMInterface_Utils_Task_Proper_Included
+
+#include "Task.inc.h"
+
+#undef TMInterface_Utils_Task_Proper_Included
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Task.h"
+
+#ifdef TMInterface_Utils_Task_Proper_Included
+
+#include <utility>
+
+namespace TMInterface {
+namespace Utils {
+namespace TaskDetail {
+
+inline bool PromiseBase::FinalAwaiter::await_ready() const noexcept {
+	return false;
+}
+
+template <typename Promise>
+std::coroutine_handle<> PromiseBase::FinalAwaiter::await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+	// Symmetric transfer, so long chains of tasks don't grow the stack
+	const std::coroutine_handle<> continuation = handle.promise().continuation;
+
+	return continuation ? continuation : std::noop_coroutine();
+}
+
+inline void PromiseBase::FinalAwaiter::await_resume() const noexcept {}
+
+inline std::suspend_always PromiseBase::initial_suspend() const noexcept {
+	return {};
+}
+
+inline PromiseBase::FinalAwaiter PromiseBase::final_suspend() const noexcept {
+	return {};
+}
+
+inline void PromiseBase::unhandled_exception() {
+	exception = std::current_exception();
+}
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() {
+	return Task<T>{Task<T>::Handle::from_promise(*this)};
+}
+
+template <typename T>
+void Promise<T>::return_value(T result) {
+	value.emplace(std::move(result));
+}
+
+inline Task<void> Promise<void>::get_return_object() {
+	return Task<void>{Task<void>::Handle::from_promise(*this)};
+}
+
+inline void Promise<void>::return_void() const {}
+
+}  // namespace TaskDetail
+
+template <typename T>
+Task<T>::Task() : handle(nullptr) {}
+
+template <typename T>
+Task<T>::Task(Handle handle) : handle(handle) {}
+
+template <typename T>
+Task<T>::Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+template <typename T>
+Task<T>& Task<T>::operator=(Task&& other) noexcept {
+	if (this != &other) {
+		if (handle) handle.destroy();
+
+		handle = std::exchange(other.handle, nullptr);
+	}
+
+	return *this;
+}
+
+template <typename T>
+Task<T>::~Task() {
+	if (handle) handle.destroy();
+}
+
+template <typename T>
+bool Task<T>::isValid() const {
+	return static_cast<bool>(handle);
+}
+
+template <typename T>
+bool Task<T>::isDone() const {
+	return !handle || handle.done();
+}
+
+template <typename T>
+void Task<T>::start() {
+	if (handle && !handle.done()) handle.resume();
+}
+
+template <typename T>
+void Task<T>::rethrow() const {
+	if (handle && handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+}
+
+template <typename T>
+auto Task<T>::operator co_await() const& noexcept {
+	struct Awaiter {
+		Handle handle;
+
+		bool await_ready() const noexcept {
+			return !handle || handle.done();
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			handle.promise().continuation = awaiting;
+
+			return handle;
+		}
+
+		T await_resume() const {
+			if (handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+
+			if constexpr (!std::is_void_v<T>) {
+				return std::move(*handle.promise().value);
+			}
+		}
+	};
+
+	return Awaiter{handle};
+}
+
+template <typename T>
+auto Task<T>::operator co_await() const&& noexcept {
+	return operator co_await();
+}
+
+}  // namespace Utils
+}  // namespace TMInterface
+
+#endif
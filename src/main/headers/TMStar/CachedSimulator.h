@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Engine.h"
+#include "SimulationCache.h"
+#include "TMInterface/SimState.h"
+
+namespace TMStar {
+
+// Simulator for the engines that answers from a SimulationCache when it can and runs the wrapped one otherwise,
+// putting what it returned into the cache. A hit costs a hash, an index probe and decoding the state, no round trip to
+// the server. Simulator also needs getSegmentHash(action), which has to tell apart everything simulate does
+// differently, like InterfaceSimulator's.
+template <typename Simulator>
+class CachedSimulator {
+public:
+	using Action = typename Simulator::Action;
+
+protected:
+	Simulator& simulator;
+	SimulationCache& cache;
+
+	// The starting state, serialized. Reused for every call
+	std::vector<uint8_t> from;
+
+public:
+	CachedSimulator(Simulator& simulator, SimulationCache& cache);
+
+	const std::vector<Action>& getActions() const;
+	SimulationOutcome simulate(const TMInterface::SimStateView& state, const Action& action, TMInterface::SimState& to);
+
+	// Delete copy stuff
+	CachedSimulator(const CachedSimulator&) = delete;
+	CachedSimulator& operator=(const CachedSimulator&) = delete;
+};
+
+}  // namespace TMStar
+
+#define TMStar_CachedSimulator_Proper_Included
+
+#include "CachedSimulator.inc.h"
+
+#undef TMStar_CachedSimulator_Proper_Included
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CachedSimulator.h"
+
+#ifdef TMStar_CachedSimulator_Proper_Included
+
+#include "StateStore.h"
+
+namespace TMStar {
+
+template <typename Simulator>
+CachedSimulator<Simulator>::CachedSimulator(Simulator& simulator, SimulationCache& cache)
+    : simulator(simulator), cache(cache) {}
+
+template <typename Simulator>
+const std::vector<typename CachedSimulator<Simulator>::Action>& CachedSimulator<Simulator>::getActions() const {
+	return simulator.getActions();
+}
+
+template <typename Simulator>
+SimulationOutcome CachedSimulator<Simulator>::simulate(const TMInterface::SimStateView& state, const Action& action,
+                                                       TMInterface::SimState& to) {
+	StateStore::serialize(state, from);
+
+	const uint64_t key = SimulationCache::getKey(from, simulator.getSegmentHash(action));
+	SimulationOutcome outcome;
+
+	if (cache.find(key, from, outcome, to)) return outcome;
+
+	outcome = simulator.simulate(state, action, to);
+	cache.insert(key, from, outcome, to.view());
+
+	return outcome;
+}
+
+}  // namespace TMStar
+
+#endif
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NodeArena.h"
+#include "StateStore.h"
+#include "TMInterface/Utils/MappedFile.h"
+#include "Utils/TranspositionTable.h"
+
+namespace TMStar {
+
+struct CheckpointSettings {
+	// Directory for the checkpoint files, one search per directory. Empty turns checkpoints off
+	std::string directory;
+	// Expansions between snapshots
+	uint64_t interval = 10'000;
+};
+
+// Crash safe snapshots of a search, in a directory of memory mapped files:
+//   nodes       NodeArena::Record of every node, appended as they come
+//   expanded.N  Nodes expanded since the snapshot before. The snapshot after marks them in nodes
+//   states      What StateStore::saveChanges handed out, compacted and appended
+//   table.T     Image of the transposition table's slots, one of three
+//   manifest    Manifest, followed by the search's statistics
+// The search logs its changes as it goes, and taking a snapshot only swaps those logs for the empty ones of the
+// snapshot before, so the pause doesn't grow with the search. A background task writes them, which only touches what
+// changed.
+// Nothing the last complete snapshot needs is overwritten: N alternates between 0 and 1, and the table image it uses
+// is left alone. The manifest goes in last, written next to the old one and renamed over it, and only counts what was
+// complete by then. Whatever a crash leaves behind past that is ignored.
+// Loading maps the files back in. The node records and the table image are mapped copy on write, so the search uses
+// them in place without changing the files, and the state store points into the state log.
+class Checkpoint {
+public:
+	static constexpr uint32_t MAGIC = 0x4B434D54;  // "TMCK"
+	static constexpr uint32_t VERSION = 2;
+	static constexpr uint32_t TABLE_IMAGES = 3;
+	static constexpr uint32_t NO_IMAGE = std::numeric_limits<uint32_t>::max();
+
+	struct Manifest {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t generation;
+		uint64_t nodeCount;
+		uint64_t expandedCount;
+		uint64_t stateBytes;
+		uint64_t tableSlots;
+		uint32_t tableImage;
+		uint32_t actionCount;
+		uint32_t statisticsSize;
+		uint32_t padding;
+	};
+
+	// What changed since the last snapshot. The search fills one while the background task writes the other
+	struct Snapshot {
+		// In the order they were added
+		std::vector<NodeArena::Record> nodes;
+		std::vector<NodeArena::Index> expanded;
+		std::vector<uint8_t> states;
+		std::vector<Utils::TranspositionTable::Change> table;
+		// Of the whole table, 0 without one
+		uint64_t tableSlots = 0;
+		std::vector<uint8_t> statistics;
+		uint32_t actionCount = 0;
+
+		// Keeps the memory
+		void clear();
+	};
+
+	// The last complete snapshot, mapped. The files stay mapped for as long as something holds on to them
+	struct View {
+		const Manifest* manifest = nullptr;
+		// Copy on write. The expansions since the snapshot before aren't marked yet, those are in expanded
+		NodeArena::Record* nodes = nullptr;
+		const NodeArena::Index* expanded = nullptr;
+		const uint8_t* states = nullptr;
+		// Copy on write as well. Null if there is no image of the table's size
+		uint64_t* table = nullptr;
+		const uint8_t* statistics = nullptr;
+
+		std::shared_ptr<TMInterface::Utils::MappedFile> manifestFile;
+		std::shared_ptr<TMInterface::Utils::MappedFile> nodesFile;
+		std::shared_ptr<TMInterface::Utils::MappedFile> expandedFile;
+		std::shared_ptr<TMInterface::Utils::MappedFile> statesFile;
+		std::shared_ptr<TMInterface::Utils::MappedFile> tableFile;
+	};
+
+protected:
+	static constexpr uint64_t UNKNOWN = std::numeric_limits<uint64_t>::max();
+
+	const CheckpointSettings settings;
+
+	// Only touched by the writer while one is running
+	std::unique_ptr<TMInterface::Utils::MappedFile> nodesFile;
+	std::unique_ptr<TMInterface::Utils::MappedFile> statesFile;
+	std::array<std::unique_ptr<TMInterface::Utils::MappedFile>, TABLE_IMAGES> tableFiles;
+	uint64_t generation;
+	uint64_t nodeCount;
+	uint64_t stateBytes;
+	// Expansions of the last snapshot, which the next one marks in nodes
+	std::vector<NodeArena::Index> expanded;
+	// Reused for compacting the state log
+	std::vector<uint8_t> compacted;
+	// Table changes of the last snapshot, and the generation each image holds (UNKNOWN if it may be half written)
+	std::vector<Utils::TranspositionTable::Change> tableChanges;
+	std::array<uint64_t, TABLE_IMAGES> tableGenerations;
+	uint64_t tableSlots;
+	// Image of the last snapshot, and the one the search maps copy on write. Neither is written to
+	uint32_t tableImage;
+	uint32_t pinnedImage;
+	// Generation at which the table was empty, so an all zero image holds it. UNKNOWN if it never was
+	uint64_t emptyGeneration;
+
+	std::future<void> writer;
+	// Being written, or written already. Goes back to the search empty
+	Snapshot written;
+
+public:
+	explicit Checkpoint(const CheckpointSettings& settings = {});
+	~Checkpoint();
+
+	bool isEnabled() const;
+	// Whether the last snapshot was written, so the next one can be taken. Rethrows if writing it failed
+	bool isReady();
+	// Waits until the last snapshot was written
+	void wait();
+
+	// Writes the changes in the background. They are swapped for the empty buffers of the last snapshot, so this
+	// doesn't copy anything
+	void write(Snapshot& changes);
+	// Maps the last complete snapshot. Returns false if there is none. Its table image is only mapped if it has
+	// tableSlots slots, the table starts out empty otherwise. Snapshots written after it go on from it
+	bool load(View& view, uint64_t tableSlots);
+	// Deletes the files, for a new search
+	void clear();
+
+	// Delete copy stuff
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+
+protected:
+	void writeSnapshot(Snapshot& snapshot);
+	// Brings an image up to the table of the snapshot. Returns the image
+	uint32_t writeTable(const Snapshot& snapshot, uint64_t next);
+	// Writes bytes at offset of the file, which grows in large steps if needed
+	void append(std::unique_ptr<TMInterface::Utils::MappedFile>& file, const std::string& name, size_t offset,
+	            const void* data, size_t size);
+	// Writes a whole file and flushes it
+	void writeFile(const std::string& name, const void* data, size_t size);
+	std::shared_ptr<TMInterface::Utils::MappedFile> map(const std::string& name, size_t size,
+	                                                    TMInterface::Utils::MappedFile::Mode mode);
+	std::string getPath(const std::string& name) const;
+
+	static std::string getSlotName(const char* name, uint64_t generation);
+	static std::string getImageName(uint32_t image);
+};
+
+}  // namespace TMStar
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+#include "TMInterface/Utils/MappedFile.h"
+
+namespace TMStar {
+
+struct Box {
+	TMInterface::Vec3 min;
+	TMInterface::Vec3 max;
+};
+
+// What the distance field needs to know about a track
+struct TrackDescription {
+	// In driving order, the last one is the finish. A checkpoint counts as taken within radius, measured horizontally
+	std::vector<TMInterface::Vec3> checkpoints;
+	float checkpointRadius = 0.0f;
+	// Nothing outside of bounds is drivable
+	Box bounds;
+	// Drivable parts of bounds. Empty means all of it
+	std::vector<Box> drivable;
+
+	uint64_t hash() const;
+
+	// Reads a track file. Every line is a keyword and numbers, # starts a comment:
+	//   radius <r>
+	//   bounds <min x y z> <max x y z>
+	//   drivable <min x y z> <max x y z>    any number of them
+	//   checkpoint <x y z>                  in driving order
+	// Throws std::runtime_error if the file can't be read or has something else in it
+	static TrackDescription load(const std::string& path);
+};
+
+struct DistanceFieldSettings {
+	float cellSize = 4.0f;
+	// Threads for building. 0 uses all cores
+	size_t threads = 0;
+};
+
+// Lower bound of the driving distance to the finish from any point of a track, through the checkpoints still to take.
+// Every checkpoint gets a 3D grid with the number of steps to it, found by a BFS over the drivable cells with 26
+// neighbors. A path of length L only ever visits cells that are at most ceil(L / cellSize) steps apart, so
+// (steps - 1) * cellSize never overestimates. Lookups are a single read from the grid.
+// The grids are built once per track and resolution and cached in a memory mapped file.
+class DistanceField {
+public:
+	using Steps = uint16_t;
+
+	static constexpr Steps UNREACHABLE = std::numeric_limits<Steps>::max();
+	static constexpr uint32_t MAGIC = 0x46444D54;  // "TMDF"
+	static constexpr uint32_t VERSION = 1;
+
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t trackHash;
+		TMInterface::Vec3 origin;
+		float cellSize;
+		uint32_t sizeX;
+		uint32_t sizeY;
+		uint32_t sizeZ;
+		uint32_t layers;
+		// Followed by float remaining[layers] and Steps steps[layers][sizeZ][sizeY][sizeX]
+	};
+
+protected:
+	std::unique_ptr<TMInterface::Utils::MappedFile> file;
+	const FileHeader* header;
+	// Distance from each checkpoint to the finish
+	const float* remaining;
+	const Steps* steps;
+	size_t cellCount;
+
+public:
+	// Maps the cached field for the track, or builds and caches it first. Throws std::runtime_error if the cache can't
+	// be read or written
+	DistanceField(const TrackDescription& track, const std::string& cacheDirectory,
+	              const DistanceFieldSettings& settings = {});
+
+	// Lower bound in meters, given the position and the number of checkpoints already taken
+	float getDistance(const TMInterface::Vec3& position, uint32_t checkpointCount) const;
+
+	uint32_t getLayerCount() const;
+	const std::string& getPath() const;
+
+	// File the field for the track and cell size is cached in
+	static std::string getCachePath(const TrackDescription& track, const std::string& cacheDirectory,
+	                                float cellSize);
+
+	// Delete copy stuff
+	DistanceField(const DistanceField&) = delete;
+	DistanceField& operator=(const DistanceField&) = delete;
+
+protected:
+	bool open(const std::string& path, uint64_t trackHash, float cellSize);
+	static void build(const TrackDescription& track, const DistanceFieldSettings& settings, const std::string& path);
+};
+
+// Turns the distance field into a time bound for the engine. maxSpeed (meters per second) has to be at least the top
+// speed of the car, or the bound isn't admissible anymore.
+// The bound is only consistent up to one cell, which the open list tolerates by clamping.
+struct DistanceHeuristic {
+	const DistanceField* field;
+	float maxSpeed;
+
+	uint32_t operator()(const TMInterface::SimStateView& state) const;
+};
+
+// inline functions
+inline float DistanceField::getDistance(const TMInterface::Vec3& position, uint32_t checkpointCount) const {
+	if (checkpointCount >= header->layers) return 0.0f;
+
+	const float x = (position.x - header->origin.x) / header->cellSize;
+	const float y = (position.y - header->origin.y) / header->cellSize;
+	const float z = (position.z - header->origin.z) / header->cellSize;
+
+	// Outside of the grid, only the checkpoints after the next one are known
+	if ((x < 0.0f) || (y < 0.0f) || (z < 0.0f) || (x >= static_cast<float>(header->sizeX)) ||
+	    (y >= static_cast<float>(header->sizeY)) || (z >= static_cast<float>(header->sizeZ))) {
+		return remaining[checkpointCount];
+	}
+
+	const size_t cell = (((static_cast<size_t>(z) * header->sizeY) + static_cast<size_t>(y)) * header->sizeX) +
+	                    static_cast<size_t>(x);
+	const Steps count = steps[(checkpointCount * cellCount) + cell];
+
+	if ((count == UNREACHABLE) || (count == 0)) return remaining[checkpointCount];
+
+	return (static_cast<float>(count - 1) * header->cellSize) + remaining[checkpointCount];
+}
+
+inline uint32_t DistanceHeuristic::operator()(const TMInterface::SimStateView& state) const {
+	const float distance = field->getDistance(state.getPosition(), state.getCheckpointCount());
+
+	return static_cast<uint32_t>((distance * 1000.0f) / maxSpeed);
+}
+
+}  // namespace TMStar
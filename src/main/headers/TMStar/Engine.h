@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "ExternalOpenList.h"
+#include "NodeArena.h"
+#include "StateHash.h"
+#include "StateStore.h"
+#include "TMInterface/SimState.h"
+#include "Utils/TranspositionTable.h"
+
+namespace TMStar {
+
+// What a simulator reports after applying an action
+struct SimulationOutcome {
+	// Race time the action took, in milliseconds
+	uint32_t cost = 0;
+	// The resulting state finished the race
+	bool goal = false;
+	// False if the resulting state is a dead end (race ended, car got stuck, ...)
+	bool valid = true;
+};
+
+struct SearchSettings {
+	// Give up after this many expansions. 0 means no limit
+	uint64_t maxExpansions = 0;
+	// Nodes estimated to take longer than this are dropped
+	uint32_t maxCost = std::numeric_limits<uint32_t>::max();
+	// Nodes to reserve memory for up front
+	size_t reserveNodes = 1 << 16;
+	// Memory for detecting near duplicate states, see StateQuantizer. 0 turns it off
+	size_t transpositionBytes = 0;
+	QuantizationSettings quantization;
+	// Nodes estimated within this many milliseconds of the best one are expanded together in tree order, so the
+	// simulator mostly carries on from the state it is at instead of rewinding. Found paths cost at most this much more
+	// than the optimum
+	uint32_t batchEpsilon = 0;
+	// Expansions per batch at most
+	size_t batchSize = 32;
+	// Lets Engine's open list spill to disk
+	SpillSettings spill;
+	// Lets Engine take snapshots to resume from. Doesn't work together with spill
+	CheckpointSettings checkpoint;
+	// Bytes SmaEngine may use for nodes, states and its open list. 0 means no limit
+	size_t memoryBudget = 0;
+};
+
+struct SearchStatistics {
+	uint64_t expansions = 0;
+	uint64_t generated = 0;
+	// Children dropped because they were dead ends or too expensive
+	uint64_t pruned = 0;
+	// Children dropped because the transposition table knew a nearly identical state at no higher cost
+	uint64_t transpositions = 0;
+	// Transposition table entries evicted to stay within its memory
+	uint64_t tableReplacements = 0;
+	// Expansions of a node other than the one the simulator was left at, which cost a rewind to a state it isn't at.
+	// Rewinds between siblings aren't counted, every expansion has those
+	uint64_t rewinds = 0;
+	uint64_t batches = 0;
+	uint64_t checkpoints = 0;
+	// Longest the search stood still to take a snapshot, in microseconds
+	uint64_t checkpointPause = 0;
+	// Nodes SmaEngine forgot to stay within its memory budget
+	uint64_t evictions = 0;
+	// Depth first passes of IdaEngine
+	uint64_t iterations = 0;
+	size_t maxOpen = 0;
+	// Most memory the memory bounded engines had in use at once
+	size_t peakBytes = 0;
+	size_t nodeBytes = 0;
+	size_t openBytes = 0;
+	size_t tableBytes = 0;
+	StateStore::Statistics store;
+	ExternalOpenList::Statistics spill;
+};
+
+template <typename Action>
+struct SearchResult {
+	bool found = false;
+	// Race time of the found path
+	uint32_t cost = 0;
+	std::vector<Action> actions;
+	SearchStatistics statistics;
+};
+
+// Admissible for any simulator. Turns the search into uniform cost search
+struct ZeroHeuristic {
+	constexpr uint32_t operator()(const TMInterface::SimStateView&) const;
+};
+
+// A* over simulation states. The engine doesn't know how states are simulated, Simulator provides:
+//   using Action = ...;
+//   const std::vector<Action>& getActions() const;
+//   SimulationOutcome simulate(const TMInterface::SimStateView& from, const Action& action, TMInterface::SimState& to);
+// Heuristic is called as uint32_t(const TMInterface::SimStateView&) and has to return milliseconds. It has to be
+// consistent, the open list relies on popped estimates never decreasing.
+template <typename Simulator, typename Heuristic = ZeroHeuristic>
+class Engine {
+public:
+	using Action = typename Simulator::Action;
+	using Result = SearchResult<Action>;
+
+protected:
+	Simulator& simulator;
+	Heuristic heuristic;
+	const SearchSettings settings;
+
+	NodeArena nodes;
+	StateStore states;
+	// Spills to disk if SearchSettings::spill says so
+	ExternalOpenList open;
+	const StateQuantizer quantizer;
+	Utils::TranspositionTable table;
+	Checkpoint checkpoint;
+	SearchStatistics statistics;
+
+	// Reused for every expansion
+	TMInterface::SimState current;
+	TMInterface::SimState next;
+	std::vector<NodeArena::Index> batch;
+	// Added by the last expansion, in action order
+	std::vector<NodeArena::Index> children;
+	// Node of the state the simulator was left at, if it was kept
+	NodeArena::Index lastChild;
+	// Logged since the last snapshot, if checkpoints are on
+	Checkpoint::Snapshot changes;
+	uint64_t nextCheckpoint;
+
+public:
+	Engine(Simulator& simulator, const SearchSettings& settings = {}, const Heuristic& heuristic = {});
+
+	Result run(const TMInterface::SimStateView& start);
+	// Carries on with the search of the last snapshot in SearchSettings::checkpoint. Throws std::runtime_error if there
+	// is none, or if it was taken with another number of actions
+	Result resume();
+
+	const NodeArena& getNodes() const;
+	const SearchStatistics& getStatistics() const;
+
+protected:
+	void reset();
+	Result search();
+	// Expands the node and everything else in its batch. Returns a goal if one came up within the batch's bound
+	NodeArena::Index expandBatch(NodeArena::Index first);
+	void expand(NodeArena::Index node);
+	// Returns the new node, or NodeArena::NONE if the child was dropped
+	NodeArena::Index addNode(NodeArena::Index parent, NodeArena::Action action, const SimulationOutcome& outcome);
+	bool isExpansionLimitReached() const;
+	// Depth first order, so nodes that share long paths from the root end up next to each other
+	void sortByTree(std::vector<NodeArena::Index>& batch) const;
+	// Whether a nearly identical state was already reached at no higher cost
+	bool isTransposition(const TMInterface::SimStateView& state, uint32_t cost);
+	// Hands what changed since the last snapshot to the background writer, which only swaps buffers
+	void takeCheckpoint();
+	Result makeResult(NodeArena::Index goal);
+};
+
+// constexpr functions
+constexpr uint32_t ZeroHeuristic::operator()(const TMInterface::SimStateView&) const {
+	return 0;
+}
+
+}  // namespace TMStar
+
+#define TMStar_Engine_Proper_Included
+
+#include "Engine.inc.h"
+
+#undef TMStar_Engine_Proper_Included
@@ -0,0 +1,381 @@
+#pragma once
+
+#include "Engine.h"
+
+#ifdef TMStar_Engine_Proper_Included
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace TMStar {
+
+template <typename Simulator, typename Heuristic>
+Engine<Simulator, Heuristic>::Engine(Simulator& simulator, const SearchSettings& settings, const Heuristic& heuristic)
+    : simulator(simulator),
+      heuristic(heuristic),
+      settings(settings),
+      open(nodes, states, settings.spill),
+      quantizer(settings.quantization),
+      table(settings.transpositionBytes),
+      checkpoint(settings.checkpoint),
+      lastChild(NodeArena::NONE),
+      nextCheckpoint(0) {
+	// Snapshots only see the part of the open list that is in memory
+	if (checkpoint.isEnabled() && open.isEnabled()) {
+		throw std::invalid_argument("Checkpoints don't work with a spilling open list");
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+typename Engine<Simulator, Heuristic>::Result Engine<Simulator, Heuristic>::run(
+    const TMInterface::SimStateView& start) {
+	if (simulator.getActions().size() >= NodeArena::NO_ACTION) {
+		throw std::invalid_argument("Too many actions");
+	}
+
+	reset();
+	checkpoint.clear();
+
+	const StateStore::Handle root = states.insert(start);
+	isTransposition(start, 0);
+
+	// The simulator starts out at the start state
+	lastChild = nodes.add(NodeArena::NONE, 0, heuristic(start), NodeArena::NO_ACTION, root);
+	open.push(heuristic(start), lastChild);
+
+	if (checkpoint.isEnabled()) changes.nodes.push_back(nodes.getRecord(lastChild));
+
+	return search();
+}
+
+template <typename Simulator, typename Heuristic>
+typename Engine<Simulator, Heuristic>::Result Engine<Simulator, Heuristic>::resume() {
+	static_assert(std::is_trivially_copyable_v<SearchStatistics>, "Statistics are stored as they are");
+
+	reset();
+
+	Checkpoint::View view;
+
+	if (!checkpoint.load(view, table.getSlotCount())) throw std::runtime_error("No checkpoint to resume from");
+	if (view.manifest->actionCount != simulator.getActions().size()) {
+		throw std::runtime_error("Checkpoint was taken with other actions");
+	}
+	if (view.manifest->statisticsSize != sizeof(SearchStatistics)) {
+		throw std::runtime_error("Checkpoint was taken by another version");
+	}
+
+	// The records are used in place. Mapped copy on write, so the search changes them without touching the file
+	for (size_t i = 0; i < view.manifest->expandedCount; ++i) {
+		view.nodes[view.expanded[i]].state = StateStore::NONE;
+		view.nodes[view.expanded[i]].flags |= NodeArena::EXPANDED;
+	}
+
+	nodes.attach(view.nodes, view.manifest->nodeCount, view.nodesFile);
+
+	std::vector<StateStore::Handle> handles;
+
+	// Everything that wasn't expanded is open. Goals are as well, they have no state though
+	for (NodeArena::Index node = 0; node < nodes.size(); ++node) {
+		if (nodes.hasFlag(node, NodeArena::EXPANDED)) continue;
+
+		open.push(nodes.getEstimate(node), node);
+
+		if (nodes.getState(node) != StateStore::NONE) handles.push_back(nodes.getState(node));
+	}
+
+	states.loadChanges(view.states, view.manifest->stateBytes, handles, view.statesFile);
+
+	// Without an image of its size, the search just finds fewer transpositions
+	if (view.table != nullptr) table.attach(view.table, view.manifest->tableSlots, view.tableFile);
+
+	std::memcpy(&statistics, view.statistics, sizeof(statistics));
+
+	nextCheckpoint = statistics.expansions + settings.checkpoint.interval;
+
+	return search();
+}
+
+template <typename Simulator, typename Heuristic>
+typename Engine<Simulator, Heuristic>::Result Engine<Simulator, Heuristic>::search() {
+	while (!open.empty()) {
+		// Between batches nothing is in flight, every node is either open or done
+		if (checkpoint.isEnabled() && (statistics.expansions >= nextCheckpoint) && checkpoint.isReady()) {
+			takeCheckpoint();
+		}
+
+		const NodeArena::Index node = open.pop().second;
+
+		// Goals are tested when popped, not when generated. Otherwise a cheaper path could still be in the open list
+		if (nodes.hasFlag(node, NodeArena::GOAL)) return makeResult(node);
+
+		if (isExpansionLimitReached()) break;
+
+		const NodeArena::Index goal = expandBatch(node);
+
+		if (goal != NodeArena::NONE) return makeResult(goal);
+	}
+
+	return makeResult(NodeArena::NONE);
+}
+
+template <typename Simulator, typename Heuristic>
+const NodeArena& Engine<Simulator, Heuristic>::getNodes() const {
+	return nodes;
+}
+
+template <typename Simulator, typename Heuristic>
+const SearchStatistics& Engine<Simulator, Heuristic>::getStatistics() const {
+	return statistics;
+}
+
+template <typename Simulator, typename Heuristic>
+void Engine<Simulator, Heuristic>::reset() {
+	nodes.clear();
+	nodes.reserve(settings.reserveNodes);
+	open.clear();
+	states = StateStore{};
+	table.clear();
+	statistics = SearchStatistics{};
+	lastChild = NodeArena::NONE;
+	nextCheckpoint = settings.checkpoint.interval;
+	changes.clear();
+
+	// The logs start out empty, like the store and the table
+	if (checkpoint.isEnabled()) {
+		states.saveChanges(changes.states);
+		table.logChanges();
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+NodeArena::Index Engine<Simulator, Heuristic>::expandBatch(NodeArena::Index first) {
+	++statistics.batches;
+
+	// first has the lowest estimate in the open list, which is a lower bound of the optimum. So is every goal within
+	// epsilon of it good enough
+	const uint64_t bound = static_cast<uint64_t>(nodes.getEstimate(first)) + settings.batchEpsilon;
+
+	batch.clear();
+	batch.push_back(first);
+
+	while ((batch.size() < settings.batchSize) && !open.empty() && (open.topKey() <= bound)) {
+		batch.push_back(open.pop().second);
+	}
+
+	sortByTree(batch);
+
+	// The simulator is at one of them already. Rotating keeps the tree order around it
+	const std::vector<NodeArena::Index>::iterator start = std::find(batch.begin(), batch.end(), lastChild);
+	if (start != batch.end()) std::rotate(batch.begin(), start, batch.end());
+
+	// Used as a stack from here on, which also makes room for the children to go depth first
+	std::reverse(batch.begin(), batch.end());
+
+	size_t expanded = 0;
+
+	while (!batch.empty()) {
+		const NodeArena::Index node = batch.back();
+		batch.pop_back();
+
+		if (nodes.hasFlag(node, NodeArena::GOAL)) return node;
+
+		// Whatever is left over goes back, the open list raises the keys that are too low by now
+		if ((expanded >= settings.batchSize) || isExpansionLimitReached()) {
+			open.push(nodes.getEstimate(node), node);
+			continue;
+		}
+
+		expand(node);
+		++expanded;
+
+		// Children within the bound go next, starting with the one the simulator is at
+		for (NodeArena::Index child : children) {
+			if (child == lastChild) continue;
+
+			if (nodes.getEstimate(child) <= bound) {
+				batch.push_back(child);
+			} else {
+				open.push(nodes.getEstimate(child), child);
+			}
+		}
+
+		if (lastChild != NodeArena::NONE) {
+			if (nodes.getEstimate(lastChild) <= bound) {
+				batch.push_back(lastChild);
+			} else {
+				open.push(nodes.getEstimate(lastChild), lastChild);
+			}
+		}
+	}
+
+	statistics.maxOpen = std::max(statistics.maxOpen, open.size());
+
+	return NodeArena::NONE;
+}
+
+template <typename Simulator, typename Heuristic>
+void Engine<Simulator, Heuristic>::expand(NodeArena::Index node) {
+	++statistics.expansions;
+
+	if (node != lastChild) ++statistics.rewinds;
+
+	states.restore(nodes.getState(node), current);
+
+	const std::vector<Action>& actions = simulator.getActions();
+
+	children.clear();
+
+	// Holding the inputs that lead here tends to give the best child, so it goes last and the simulator stays there
+	const size_t repeated = nodes.getAction(node);
+
+	for (size_t i = 0; i < actions.size(); ++i) {
+		const size_t action = (repeated < actions.size()) ? ((repeated + 1 + i) % actions.size()) : i;
+		const SimulationOutcome outcome = simulator.simulate(current.view(), actions[action], next);
+
+		lastChild = addNode(node, static_cast<NodeArena::Action>(action), outcome);
+
+		if (lastChild != NodeArena::NONE) children.push_back(lastChild);
+	}
+
+	// Every node is expanded once, so the state is only needed as delta base from here on. The store keeps the chunks
+	// the children still reference
+	states.release(nodes.getState(node));
+	nodes.setState(node, StateStore::NONE);
+	nodes.setFlag(node, NodeArena::EXPANDED);
+
+	if (checkpoint.isEnabled()) changes.expanded.push_back(node);
+}
+
+template <typename Simulator, typename Heuristic>
+NodeArena::Index Engine<Simulator, Heuristic>::addNode(NodeArena::Index parent, NodeArena::Action action,
+                                                       const SimulationOutcome& outcome) {
+	++statistics.generated;
+
+	const uint64_t cost = static_cast<uint64_t>(nodes.getCost(parent)) + outcome.cost;
+	const uint32_t estimate = outcome.goal ? 0 : heuristic(next.view());
+
+	if (!outcome.valid || ((cost + estimate) > settings.maxCost)) {
+		++statistics.pruned;
+
+		return NodeArena::NONE;
+	}
+
+	// Goals always make it into the open list
+	if (!outcome.goal && isTransposition(next.view(), static_cast<uint32_t>(cost))) {
+		++statistics.transpositions;
+
+		return NodeArena::NONE;
+	}
+
+	// Goals are never expanded, no need to keep their state
+	const StateStore::Handle state =
+	    outcome.goal ? StateStore::NONE : states.insert(next.view(), nodes.getState(parent));
+	const NodeArena::Index node =
+	    nodes.add(parent, static_cast<uint32_t>(cost), estimate, action, state, outcome.goal ? NodeArena::GOAL : 0);
+
+	// Expanding it later only sets the flag and drops the state, which the snapshot it is expanded in records
+	if (checkpoint.isEnabled()) changes.nodes.push_back(nodes.getRecord(node));
+
+	return node;
+}
+
+template <typename Simulator, typename Heuristic>
+bool Engine<Simulator, Heuristic>::isExpansionLimitReached() const {
+	return (settings.maxExpansions != 0) && (statistics.expansions >= settings.maxExpansions);
+}
+
+template <typename Simulator, typename Heuristic>
+void Engine<Simulator, Heuristic>::sortByTree(std::vector<NodeArena::Index>& batch) const {
+	if (batch.size() < 2) return;
+
+	// Nodes are never removed, so parents always have lower indices than their children. Lifting the higher of the two
+	// meets the other one at their closest common ancestor, which batch members tend to have only a few levels up.
+	// Below it the actions decide, and ancestors go first, like a depth first search visits them
+	std::sort(batch.begin(), batch.end(), [this](NodeArena::Index a, NodeArena::Index b) {
+		NodeArena::Index childA = NodeArena::NONE;
+		NodeArena::Index childB = NodeArena::NONE;
+
+		while (a != b) {
+			if (a > b) {
+				childA = a;
+				a = nodes.getParent(a);
+			} else {
+				childB = b;
+				b = nodes.getParent(b);
+			}
+		}
+
+		if (childB == NodeArena::NONE) return false;
+		if (childA == NodeArena::NONE) return true;
+
+		return nodes.getAction(childA) < nodes.getAction(childB);
+	});
+}
+
+template <typename Simulator, typename Heuristic>
+bool Engine<Simulator, Heuristic>::isTransposition(const TMInterface::SimStateView& state, uint32_t cost) {
+	if (!table.isEnabled()) return false;
+
+	return table.update(quantizer.hash(state), cost) == Utils::TranspositionTable::Result::DUPLICATE;
+}
+
+template <typename Simulator, typename Heuristic>
+void Engine<Simulator, Heuristic>::takeCheckpoint() {
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	// Nodes and expansions are logged as they happen, the store and the table log their own
+	states.saveChanges(changes.states);
+	table.saveChanges(changes.table);
+	changes.tableSlots = table.getSlotCount();
+	changes.actionCount = static_cast<uint32_t>(simulator.getActions().size());
+
+	++statistics.checkpoints;
+
+	changes.statistics.resize(sizeof(statistics));
+	std::memcpy(changes.statistics.data(), &statistics, sizeof(statistics));
+
+	// Swaps changes for the empty buffers of the last snapshot
+	checkpoint.write(changes);
+
+	const std::chrono::microseconds pause = std::chrono::duration_cast<std::chrono::microseconds>(
+	    std::chrono::steady_clock::now() - begin);
+	statistics.checkpointPause = std::max<uint64_t>(statistics.checkpointPause, pause.count());
+
+	nextCheckpoint = statistics.expansions + settings.checkpoint.interval;
+}
+
+template <typename Simulator, typename Heuristic>
+typename Engine<Simulator, Heuristic>::Result Engine<Simulator, Heuristic>::makeResult(NodeArena::Index goal) {
+	Result result;
+
+	// Whatever was found, the last snapshot should be complete
+	checkpoint.wait();
+
+	if (goal != NodeArena::NONE) {
+		const std::vector<Action>& actions = simulator.getActions();
+
+		result.found = true;
+		result.cost = nodes.getCost(goal);
+
+		for (NodeArena::Action action : nodes.getPath(goal)) {
+			result.actions.push_back(actions[action]);
+		}
+	}
+
+	statistics.nodeBytes = nodes.getMemoryUsage();
+	statistics.openBytes = open.getMemoryUsage();
+	statistics.tableBytes = table.getMemoryUsage();
+	statistics.tableReplacements = table.getReplacements();
+	statistics.store = states.getStatistics();
+	statistics.spill = open.getStatistics();
+	result.statistics = statistics;
+
+	return result;
+}
+
+}  // namespace TMStar
+
+#endif
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NodeArena.h"
+#include "StateStore.h"
+#include "Utils/RadixHeap.h"
+
+namespace TMStar {
+
+struct SpillSettings {
+	// Directory for the spilled buckets, one search per directory. Empty keeps the whole open list in memory
+	std::string directory;
+	// Bytes of states and open list entries to keep in memory. Past that the highest buckets are spilled
+	size_t memoryBytes = size_t{1} << 30;
+	// Range of estimates in a bucket, in milliseconds
+	uint32_t bucketWidth = 100;
+	// Buckets with fewer entries stay in memory, so every run is one large sequential write
+	size_t minRunEntries = 4096;
+};
+
+// Open list that grows past RAM. Estimates are grouped into buckets of SpillSettings::bucketWidth. Only the lowest
+// bucket is in a RadixHeap (the head), higher buckets are plain arrays. When the states and entries take up more than
+// SpillSettings::memoryBytes, the highest buckets are sorted and written to disk as runs, together with the states of
+// their nodes, which are released from the store. Each run is a memory mapped file written in one go and read back in
+// one go. When the head runs empty the next bucket is read back into it, and the reads of the bucket after it are
+// started in the background, so they overlap with the expansions.
+// Keys are monotone like for RadixHeap. Popped nodes always have their state in the store again.
+class ExternalOpenList {
+public:
+	using Key = uint32_t;
+	using Entry = std::pair<Key, NodeArena::Index>;
+
+	struct Statistics {
+		uint64_t spilledEntries = 0;
+		uint64_t spilledBytes = 0;
+		uint64_t runs = 0;
+		// Runs that were read by the time their bucket was needed
+		uint64_t prefetchedRuns = 0;
+	};
+
+protected:
+	// Written in front of the state bytes of every entry of a run
+	struct RunRecord {
+		Key key;
+		NodeArena::Index node;
+		// 0 if the node had no state (goals)
+		uint32_t stateSize;
+	};
+
+	struct Bucket {
+		// Entries that are still in memory
+		std::vector<Entry> entries;
+		// Paths of the runs on disk
+		std::vector<std::string> runs;
+	};
+
+	struct Prefetch {
+		uint32_t bucket;
+		// The first this many runs of the bucket are being read
+		size_t runs;
+		std::future<std::vector<std::vector<uint8_t>>> data;
+	};
+
+	NodeArena& nodes;
+	StateStore& states;
+	const SpillSettings settings;
+	// Unique to the instance, runs of different lists never collide
+	const std::string prefix;
+
+	Utils::RadixHeap<NodeArena::Index> head;
+	// Bucket of the entries in head
+	uint32_t current;
+	std::map<uint32_t, Bucket> buckets;
+	size_t count;
+	// Entries in the arrays of the buckets
+	size_t pendingCount;
+	// Spills are only tried again once this many entries are pending
+	size_t nextSpill;
+	uint64_t runCount;
+	Prefetch prefetch;
+	Statistics statistics;
+
+	// Reused for every run
+	std::vector<uint8_t> run;
+	std::vector<uint8_t> state;
+
+public:
+	// The list takes the states of spilled nodes out of states and puts them back in when they are read again
+	ExternalOpenList(NodeArena& nodes, StateStore& states, const SpillSettings& settings = {});
+	~ExternalOpenList();
+
+	bool isEnabled() const;
+	bool empty() const;
+	size_t size() const;
+
+	// Keys below the last popped one are raised to it
+	void push(Key key, NodeArena::Index node);
+	Entry pop();
+	Key topKey();
+
+	// Also deletes the runs
+	void clear();
+	// Only what is in memory
+	size_t getMemoryUsage() const;
+	const Statistics& getStatistics() const;
+
+	// Delete copy stuff
+	ExternalOpenList(const ExternalOpenList&) = delete;
+	ExternalOpenList& operator=(const ExternalOpenList&) = delete;
+
+protected:
+	// Makes sure the head isn't empty
+	void refill();
+	// Moves the bucket into the head, reading its runs back in
+	void load(std::map<uint32_t, Bucket>::iterator bucket);
+	void startPrefetch();
+	// Spills the highest buckets until the memory is below budget again
+	void spill();
+	void writeRun(uint32_t index, Bucket& bucket);
+	void readRun(const std::vector<uint8_t>& data);
+	size_t getMemoryInUse() const;
+
+	static std::vector<uint8_t> readFile(const std::string& path);
+	static std::vector<std::vector<uint8_t>> readFiles(const std::vector<std::string>& paths);
+	static std::string makePrefix();
+};
+
+}  // namespace TMStar
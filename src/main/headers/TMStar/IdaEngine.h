@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Engine.h"
+#include "NodeArena.h"
+#include "StateHash.h"
+#include "StateStore.h"
+#include "TMInterface/SimState.h"
+#include "Utils/TranspositionTable.h"
+
+namespace TMStar {
+
+// Iterative deepening A* (IDA*). Depth first passes that cut off every path whose estimate exceeds a threshold, which
+// starts at the estimate of the start state and is raised to the lowest estimate cut off in the last pass. Only the
+// current path is kept, its states as deltas against their parents, so memory grows with the depth of the search and
+// not with its width. The price is generating the upper levels again in every pass.
+// Backtracking goes to a state on the current path, which the server saved when it simulated it. So every rewind
+// InterfaceSimulator has to do is a rewind to time.
+// Simulator and Heuristic have the same requirements as for Engine, except that the heuristic only has to be
+// admissible. The transposition table only drops states reached again at no lower cost within the same pass.
+template <typename Simulator, typename Heuristic = ZeroHeuristic>
+class IdaEngine {
+public:
+	using Action = typename Simulator::Action;
+	using Result = SearchResult<Action>;
+
+	static constexpr uint32_t INFINITE = std::numeric_limits<uint32_t>::max();
+
+protected:
+	struct Frame {
+		StateStore::Handle state;
+		uint32_t cost;
+		// Action that lead here from the previous frame
+		NodeArena::Action action;
+		// Number of children generated so far
+		NodeArena::Action next;
+	};
+
+	Simulator& simulator;
+	Heuristic heuristic;
+	const SearchSettings settings;
+
+	std::vector<Frame> path;
+	StateStore states;
+	const StateQuantizer quantizer;
+	Utils::TranspositionTable table;
+	SearchStatistics statistics;
+
+	// Reused for every expansion
+	TMInterface::SimState current;
+	TMInterface::SimState next;
+	// Actions of the goal path
+	std::vector<NodeArena::Action> goalActions;
+
+public:
+	IdaEngine(Simulator& simulator, const SearchSettings& settings = {}, const Heuristic& heuristic = {});
+
+	Result run(const TMInterface::SimStateView& start);
+
+	const SearchStatistics& getStatistics() const;
+	// Current path and its states
+	size_t getMemoryUsage() const;
+
+protected:
+	void reset();
+	// One depth first pass. Returns whether a goal was found and sets cost to its cost. Otherwise threshold is raised
+	// to the lowest estimate that was cut off (INFINITE if none was)
+	bool search(const TMInterface::SimStateView& start, uint32_t& threshold, uint32_t& cost);
+	void pop();
+	bool isExpansionLimitReached() const;
+	// Whether a nearly identical state was already reached at no higher cost in this pass
+	bool isTransposition(const TMInterface::SimStateView& state, uint32_t cost);
+	Result makeResult(bool found, uint32_t cost);
+};
+
+}  // namespace TMStar
+
+#define TMStar_IdaEngine_Proper_Included
+
+#include "IdaEngine.inc.h"
+
+#undef TMStar_IdaEngine_Proper_Included
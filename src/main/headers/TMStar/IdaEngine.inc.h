@@ -0,0 +1,207 @@
+#pragma once
+
+#include "IdaEngine.h"
+
+#ifdef TMStar_IdaEngine_Proper_Included
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace TMStar {
+
+template <typename Simulator, typename Heuristic>
+IdaEngine<Simulator, Heuristic>::IdaEngine(Simulator& simulator, const SearchSettings& settings,
+                                           const Heuristic& heuristic)
+    : simulator(simulator),
+      heuristic(heuristic),
+      settings(settings),
+      quantizer(settings.quantization),
+      table(settings.transpositionBytes) {}
+
+template <typename Simulator, typename Heuristic>
+typename IdaEngine<Simulator, Heuristic>::Result IdaEngine<Simulator, Heuristic>::run(
+    const TMInterface::SimStateView& start) {
+	if (simulator.getActions().size() >= NodeArena::NO_ACTION) {
+		throw std::invalid_argument("Too many actions");
+	}
+
+	reset();
+
+	uint32_t threshold = heuristic(start);
+	uint32_t cost = 0;
+
+	while ((threshold <= settings.maxCost) && !isExpansionLimitReached()) {
+		++statistics.iterations;
+
+		if (search(start, threshold, cost)) return makeResult(true, cost);
+
+		if (threshold == INFINITE) break;
+	}
+
+	return makeResult(false, 0);
+}
+
+template <typename Simulator, typename Heuristic>
+const SearchStatistics& IdaEngine<Simulator, Heuristic>::getStatistics() const {
+	return statistics;
+}
+
+template <typename Simulator, typename Heuristic>
+size_t IdaEngine<Simulator, Heuristic>::getMemoryUsage() const {
+	return (path.capacity() * sizeof(Frame)) + states.getStatistics().storedBytes;
+}
+
+template <typename Simulator, typename Heuristic>
+void IdaEngine<Simulator, Heuristic>::reset() {
+	path.clear();
+	states = StateStore{};
+	statistics = SearchStatistics{};
+	goalActions.clear();
+}
+
+template <typename Simulator, typename Heuristic>
+bool IdaEngine<Simulator, Heuristic>::search(const TMInterface::SimStateView& start, uint32_t& threshold,
+                                             uint32_t& cost) {
+	constexpr size_t NOT_RESTORED = std::numeric_limits<size_t>::max();
+
+	const std::vector<Action>& actions = simulator.getActions();
+	uint32_t nextThreshold = INFINITE;
+	// Depth of the frame whose state is in current
+	size_t restored = NOT_RESTORED;
+
+	table.clear();
+	isTransposition(start, 0);
+
+	path.push_back(Frame{states.insert(start), 0, NodeArena::NO_ACTION, 0});
+
+	while (!path.empty()) {
+		const size_t depth = path.size() - 1;
+		Frame& top = path.back();
+
+		if (top.next == actions.size()) {
+			pop();
+			restored = NOT_RESTORED;
+			continue;
+		}
+
+		if (top.next == 0) {
+			if (isExpansionLimitReached()) break;
+
+			++statistics.expansions;
+		}
+
+		// Same order as Engine, the inputs that lead here go last
+		const size_t repeated = top.action;
+		const size_t action = (repeated < actions.size()) ? ((repeated + 1 + top.next) % actions.size()) : top.next;
+
+		++top.next;
+
+		if (restored != depth) {
+			states.restore(top.state, current);
+			restored = depth;
+		}
+
+		const SimulationOutcome outcome = simulator.simulate(current.view(), actions[action], next);
+
+		++statistics.generated;
+
+		const uint64_t childCost = static_cast<uint64_t>(top.cost) + outcome.cost;
+		const uint64_t estimate = childCost + (outcome.goal ? 0 : heuristic(next.view()));
+
+		if (!outcome.valid || (estimate > settings.maxCost)) {
+			++statistics.pruned;
+			continue;
+		}
+
+		if (estimate > threshold) {
+			nextThreshold = static_cast<uint32_t>(std::min<uint64_t>(nextThreshold, estimate));
+			continue;
+		}
+
+		// Nothing cheaper can be left: it would have been within the threshold of the last pass
+		if (outcome.goal) {
+			goalActions.clear();
+
+			for (size_t i = 1; i < path.size(); ++i) {
+				goalActions.push_back(path[i].action);
+			}
+
+			goalActions.push_back(static_cast<NodeArena::Action>(action));
+			cost = static_cast<uint32_t>(childCost);
+
+			while (!path.empty()) pop();
+
+			return true;
+		}
+
+		if (isTransposition(next.view(), static_cast<uint32_t>(childCost))) {
+			++statistics.transpositions;
+			continue;
+		}
+
+		const StateStore::Handle state = states.insert(next.view(), top.state);
+
+		path.push_back(Frame{state, static_cast<uint32_t>(childCost), static_cast<NodeArena::Action>(action), 0});
+
+		// The child is expanded next, and the simulator was left at it
+		std::swap(current, next);
+		restored = depth + 1;
+
+		statistics.peakBytes = std::max(statistics.peakBytes, getMemoryUsage());
+	}
+
+	while (!path.empty()) pop();
+
+	threshold = nextThreshold;
+
+	return false;
+}
+
+template <typename Simulator, typename Heuristic>
+void IdaEngine<Simulator, Heuristic>::pop() {
+	states.release(path.back().state);
+	path.pop_back();
+}
+
+template <typename Simulator, typename Heuristic>
+bool IdaEngine<Simulator, Heuristic>::isExpansionLimitReached() const {
+	return (settings.maxExpansions != 0) && (statistics.expansions >= settings.maxExpansions);
+}
+
+template <typename Simulator, typename Heuristic>
+bool IdaEngine<Simulator, Heuristic>::isTransposition(const TMInterface::SimStateView& state, uint32_t cost) {
+	if (!table.isEnabled()) return false;
+
+	return table.update(quantizer.hash(state), cost) == Utils::TranspositionTable::Result::DUPLICATE;
+}
+
+template <typename Simulator, typename Heuristic>
+typename IdaEngine<Simulator, Heuristic>::Result IdaEngine<Simulator, Heuristic>::makeResult(bool found,
+                                                                                          uint32_t cost) {
+	Result result;
+
+	if (found) {
+		const std::vector<Action>& actions = simulator.getActions();
+
+		result.found = true;
+		result.cost = cost;
+
+		for (NodeArena::Action action : goalActions) {
+			result.actions.push_back(actions[action]);
+		}
+	}
+
+	statistics.nodeBytes = path.capacity() * sizeof(Frame);
+	statistics.tableBytes = table.getMemoryUsage();
+	statistics.tableReplacements = table.getReplacements();
+	statistics.store = states.getStatistics();
+	result.statistics = statistics;
+
+	return result;
+}
+
+}  // namespace TMStar
+
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Engine.h"
+#include "RewindPlanner.h"
+#include "TMInterface/Interface.h"
+
+namespace TMStar {
+
+// Inputs that are held for one search step
+struct InputAction {
+	bool accelerate = false;
+	bool brake = false;
+	// -65536 (full left) to 65536 (full right)
+	int32_t steer = 0;
+};
+
+struct InterfaceSimulatorSettings {
+	// Simulation steps (10ms each) an action is held for
+	uint32_t ticksPerAction = 10;
+	std::chrono::milliseconds timeout{2'000};
+	// Rewind with C_SIM_REWIND_TO_TIME to states the server still has saved
+	bool rewindToTime = true;
+};
+
+// Simulator for Engine that runs the actions on a TMInterface server. The interface has to be registered and the
+// server has to be simulating. Between calls the simulator keeps the current S_ON_SIM_STEP unanswered, since that is
+// the only place where the server accepts rewinds.
+class InterfaceSimulator {
+public:
+	using Action = InputAction;
+
+protected:
+	TMInterface::Interface& interface;
+	const std::vector<Action> actions;
+	const InterfaceSimulatorSettings settings;
+
+	// We are inside an S_ON_SIM_STEP that wasn't answered yet
+	bool inStep;
+	// Set by the server calls received while stepping
+	bool goalReached;
+	bool simEnded;
+	// State with the action's inputs applied, reused for every rewind
+	TMInterface::SimState rewindState;
+	// The state the server is in right now, if we know it. Rewinds only send the chunks that differ from it
+	TMInterface::SimState serverState;
+	bool serverStateKnown;
+	RewindPlanner planner;
+	uint64_t simulatedTicks;
+
+public:
+	InterfaceSimulator(TMInterface::Interface& interface, const std::vector<Action>& actions = getDefaultActions(),
+	                   const InterfaceSimulatorSettings& settings = {});
+
+	const std::vector<Action>& getActions() const;
+	// Identifies what simulate does with the action, for SimulationCache
+	uint64_t getSegmentHash(const Action& action) const;
+	SimulationOutcome simulate(const TMInterface::SimStateView& from, const Action& action, TMInterface::SimState& to);
+
+	// Waits for the next simulation step and returns the state there. This is where searches start
+	TMInterface::SimState getState();
+	// Answers the pending simulation step, so the server carries on
+	void release();
+
+	uint64_t getSimulatedTicks() const;
+	const RewindStatistics& getRewindStatistics() const;
+
+	// Full throttle with five steering angles, plus coasting and braking straight
+	static std::vector<Action> getDefaultActions();
+
+protected:
+	// Gets the server back to the state with the inputs. Rewinds by time if the server still has the state saved, and
+	// sends the whole state otherwise
+	void rewind(const TMInterface::SimStateView& state, const TMInterface::SetInputStatesData& inputs);
+	void rewindToState(const TMInterface::SimStateView& state);
+	// Steps until ticks passed, the goal was reached or the simulation ended, then reads the state
+	SimulationOutcome run(const TMInterface::SimStateView& from, uint32_t ticks, TMInterface::SimState& to);
+	// Sends a client call and waits for its S_RESPONSE
+	void call(const TMInterface::Packet& packet);
+	// Like call, but returns false instead of throwing if the server answered with an error
+	bool tryCall(const TMInterface::Packet& packet);
+	// Answers the current step and runs until the next one
+	void step();
+	// Answers server calls until an S_ON_SIM_STEP comes in
+	void waitForStep();
+	void acknowledge(int32_t packetId);
+	TMInterface::Packet* receive();
+	void readState(TMInterface::SimState& state);
+};
+
+}  // namespace TMStar
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "StateStore.h"
+
+namespace TMStar {
+
+// Search nodes, stored as a structure of arrays and addressed by 32 bit indices. The expansion loop only touches the
+// columns it needs, and a node costs BYTES_PER_NODE bytes instead of a heap allocation with pointers.
+class NodeArena {
+public:
+	using Index = uint32_t;
+	using Action = uint16_t;
+
+	static constexpr Index NONE = std::numeric_limits<Index>::max();
+	static constexpr Action NO_ACTION = std::numeric_limits<Action>::max();
+
+	enum Flags : uint8_t {
+		GOAL = 0x1,
+		EXPANDED = 0x2,
+	};
+
+	static constexpr size_t BYTES_PER_NODE = sizeof(Index) + 2 * sizeof(uint32_t) + sizeof(StateStore::Handle) +
+	                                         sizeof(Action) + sizeof(uint8_t);
+
+	// A whole node in one place, the way checkpoints store them
+	struct Record {
+		Index parent;
+		uint32_t cost;
+		uint32_t heuristic;
+		StateStore::Handle state;
+		Action action;
+		uint8_t flags;
+		uint8_t padding;
+	};
+
+protected:
+	// The first baseCount nodes live in these records instead of the columns, see attach
+	Record* base;
+	size_t baseCount;
+	std::shared_ptr<void> baseOwner;
+
+	std::vector<Index> parents;
+	// Cost so far and estimated cost to go, in milliseconds of race time
+	std::vector<uint32_t> costs;
+	std::vector<uint32_t> heuristics;
+	std::vector<StateStore::Handle> states;
+	// Index into the simulator's action list that lead here from the parent
+	std::vector<Action> actions;
+	std::vector<uint8_t> flags;
+	// Removed nodes, reused by add
+	std::vector<Index> freeNodes;
+
+public:
+	NodeArena();
+
+	Index add(Index parent, uint32_t cost, uint32_t heuristic, Action action, StateStore::Handle state,
+	          uint8_t flags = 0);
+	// For searches that forget nodes. The index is handed out again, so nothing may refer to the node anymore
+	void remove(Index node);
+
+	void reserve(size_t count);
+	void clear();
+	// Makes count records the first nodes of an empty arena, used in place: nothing is copied, and changes to those
+	// nodes are written to the records. owner keeps them alive until clear
+	void attach(Record* records, size_t count, std::shared_ptr<void> owner);
+
+	// Including removed nodes, so every index is below it
+	size_t size() const;
+	size_t getLiveCount() const;
+	// Nodes that fit without reallocating
+	size_t getCapacity() const;
+	size_t getMemoryUsage() const;
+
+	Index getParent(Index node) const;
+	uint32_t getCost(Index node) const;
+	uint32_t getHeuristic(Index node) const;
+	uint32_t getEstimate(Index node) const;
+	Action getAction(Index node) const;
+	StateStore::Handle getState(Index node) const;
+	bool hasFlag(Index node, Flags flag) const;
+
+	void setState(Index node, StateStore::Handle state);
+	void setFlag(Index node, Flags flag);
+
+	Record getRecord(Index node) const;
+
+	// Actions from the root to node, in order
+	std::vector<Action> getPath(Index node) const;
+};
+
+static_assert(NodeArena::BYTES_PER_NODE < 32, "Nodes should stay small");
+static_assert(sizeof(NodeArena::Record) == 20, "Records are stored as they are");
+
+}  // namespace TMStar
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Engine.h"
+#include "NodeArena.h"
+#include "StateStore.h"
+#include "TMInterface/SimState.h"
+#include "Utils/MpscQueue.h"
+#include "Utils/RadixHeap.h"
+#include "Utils/TranspositionTable.h"
+
+namespace TMStar {
+
+struct ParallelSearchStatistics : public SearchStatistics {
+	// Children that were handed to another worker
+	uint64_t messages = 0;
+	size_t workers = 0;
+};
+
+// Hash distributed A* (HDA*). Every simulator gets a worker thread, usually one per active TMInterface instance. Each
+// state is owned by the worker its quantized hash maps to: successors are sent to their owner through a lock-free
+// queue, and the owner looks them up in its own transposition table and puts them into its own open list. Workers
+// never share anything else, so throughput scales with the number of simulators. Like for Engine, duplicates are only
+// detected with SearchSettings::transpositionBytes set, which the workers split between them.
+// Workers keep expanding the child their simulator was left at as long as it is within batchEpsilon of the best node
+// they popped, which saves a rewind each. The open lists are split by hash, so there is no tree order to sort batches
+// by like Engine does. The search stays optimal either way, it only runs until nothing beats the best goal.
+// Simulator and Heuristic have the same requirements as for Engine. Every simulator is only used by its own worker.
+template <typename Simulator, typename Heuristic = ZeroHeuristic>
+class ParallelEngine {
+public:
+	using Action = typename Simulator::Action;
+	using Result = SearchResult<Action>;
+
+	// Nodes are addressed by worker and index into that worker's arena
+	static constexpr uint32_t WORKER_BITS = 4;
+	static constexpr uint32_t MAX_WORKERS = 1 << WORKER_BITS;
+
+protected:
+	struct Message {
+		uint64_t hash = 0;
+		NodeArena::Index parent = NodeArena::NONE;
+		uint32_t cost = 0;
+		uint32_t heuristic = 0;
+		NodeArena::Action action = NodeArena::NO_ACTION;
+		bool goal = false;
+		TMInterface::SimState state;
+	};
+
+	struct alignas(64) Worker {
+		Simulator* simulator;
+		Heuristic heuristic;
+
+		NodeArena nodes;
+		Utils::RadixHeap<NodeArena::Index> open;
+		StateStore states;
+		// Cheapest known cost of the states this worker owns
+		Utils::TranspositionTable table;
+		Utils::MpscQueue<Message> inbox;
+		ParallelSearchStatistics statistics;
+
+		TMInterface::SimState current;
+		TMInterface::SimState next;
+
+		// Node of the state the simulator was left at, if this worker kept it
+		NodeArena::Index lastChild = NodeArena::NONE;
+		// Same, until it was considered for a dive
+		NodeArena::Index diveCandidate = NodeArena::NONE;
+		// Dives go on while nodes stay within this bound, for batchSize expansions at most
+		uint64_t bound = 0;
+		size_t diveLength = 0;
+
+		explicit Worker(size_t tableBytes);
+	};
+
+	const SearchSettings settings;
+	std::vector<std::unique_ptr<Worker>> workers;
+	const StateQuantizer quantizer;
+
+	// Idle workers in the upper half, messages sent but not received yet in the lower half. Kept in one word, so
+	// "everybody idle and nothing in flight" can be observed atomically
+	alignas(64) std::atomic<uint64_t> quiescence;
+	alignas(64) std::atomic<uint64_t> expansions;
+	std::atomic<uint32_t> incumbent;
+	std::atomic_bool stop;
+
+	std::mutex goalMutex;
+	uint32_t goalNode;
+	std::exception_ptr error;
+
+public:
+	ParallelEngine(const std::vector<Simulator*>& simulators, const SearchSettings& settings = {},
+	               const Heuristic& heuristic = {});
+
+	Result run(const TMInterface::SimStateView& start);
+
+	size_t getWorkerCount() const;
+	ParallelSearchStatistics getStatistics() const;
+
+protected:
+	void reset();
+	void work(uint32_t id);
+	// Moves everything from the inbox into the open list. Returns whether there was anything
+	bool receive(Worker& worker);
+	// Returns the new node, or NodeArena::NONE for duplicates
+	NodeArena::Index accept(Worker& worker, Message& message, StateStore::Handle base);
+	// The child the simulator is at if it is good enough, the best node of the open list otherwise
+	NodeArena::Index nextNode(Worker& worker);
+	void expand(uint32_t id, NodeArena::Index node);
+	void send(uint32_t from, Message&& message);
+	void offerGoal(uint32_t id, NodeArena::Index node);
+	bool isTransposition(Worker& worker, uint64_t hash, uint32_t cost);
+	bool isDone() const;
+	Result makeResult();
+
+	uint32_t getOwner(uint64_t hash) const;
+
+	static constexpr uint32_t makeGlobal(uint32_t worker, NodeArena::Index node);
+	static constexpr uint32_t getWorker(uint32_t global);
+	static constexpr NodeArena::Index getLocal(uint32_t global);
+};
+
+// constexpr functions
+template <typename Simulator, typename Heuristic>
+constexpr uint32_t ParallelEngine<Simulator, Heuristic>::makeGlobal(uint32_t worker, NodeArena::Index node) {
+	return (worker << (32 - WORKER_BITS)) | node;
+}
+
+template <typename Simulator, typename Heuristic>
+constexpr uint32_t ParallelEngine<Simulator, Heuristic>::getWorker(uint32_t global) {
+	return global >> (32 - WORKER_BITS);
+}
+
+template <typename Simulator, typename Heuristic>
+constexpr NodeArena::Index ParallelEngine<Simulator, Heuristic>::getLocal(uint32_t global) {
+	return global & ((1u << (32 - WORKER_BITS)) - 1);
+}
+
+}  // namespace TMStar
+
+#define TMStar_ParallelEngine_Proper_Included
+
+#include "ParallelEngine.inc.h"
+
+#undef TMStar_ParallelEngine_Proper_Included
@@ -0,0 +1,390 @@
+#pragma once
+
+#include "ParallelEngine.h"
+
+#ifdef TMStar_ParallelEngine_Proper_Included
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace TMStar {
+
+template <typename Simulator, typename Heuristic>
+ParallelEngine<Simulator, Heuristic>::ParallelEngine(const std::vector<Simulator*>& simulators,
+                                                     const SearchSettings& settings, const Heuristic& heuristic)
+    : settings(settings),
+      quantizer(settings.quantization),
+      quiescence(0),
+      expansions(0),
+      incumbent(0),
+      stop(false),
+      goalNode(NodeArena::NONE) {
+	if (simulators.empty() || (simulators.size() > MAX_WORKERS)) {
+		throw std::invalid_argument("ParallelEngine needs between 1 and 16 simulators");
+	}
+
+	for (Simulator* simulator : simulators) {
+		workers.push_back(std::make_unique<Worker>(settings.transpositionBytes / simulators.size()));
+		workers.back()->simulator = simulator;
+		workers.back()->heuristic = heuristic;
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+ParallelEngine<Simulator, Heuristic>::Worker::Worker(size_t tableBytes) : simulator(nullptr), table(tableBytes) {}
+
+template <typename Simulator, typename Heuristic>
+typename ParallelEngine<Simulator, Heuristic>::Result ParallelEngine<Simulator, Heuristic>::run(
+    const TMInterface::SimStateView& start) {
+	if (workers.front()->simulator->getActions().size() >= NodeArena::NO_ACTION) {
+		throw std::invalid_argument("Too many actions");
+	}
+
+	reset();
+
+	Message root;
+	root.hash = quantizer.hash(start);
+	root.heuristic = workers.front()->heuristic(start);
+	root.state = start.toOwned();
+
+	send(0, std::move(root));
+
+	std::vector<std::thread> threads;
+
+	for (uint32_t id = 1; id < workers.size(); ++id) {
+		threads.emplace_back(&ParallelEngine::work, this, id);
+	}
+
+	work(0);
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	if (error) std::rethrow_exception(error);
+
+	return makeResult();
+}
+
+template <typename Simulator, typename Heuristic>
+size_t ParallelEngine<Simulator, Heuristic>::getWorkerCount() const {
+	return workers.size();
+}
+
+template <typename Simulator, typename Heuristic>
+ParallelSearchStatistics ParallelEngine<Simulator, Heuristic>::getStatistics() const {
+	ParallelSearchStatistics total;
+	total.workers = workers.size();
+
+	for (const std::unique_ptr<Worker>& worker : workers) {
+		const ParallelSearchStatistics& statistics = worker->statistics;
+		const StateStore::Statistics store = worker->states.getStatistics();
+
+		total.expansions += statistics.expansions;
+		total.generated += statistics.generated;
+		total.pruned += statistics.pruned;
+		total.transpositions += statistics.transpositions;
+		total.rewinds += statistics.rewinds;
+		total.batches += statistics.batches;
+		total.messages += statistics.messages;
+		total.maxOpen += statistics.maxOpen;
+		total.tableBytes += worker->table.getMemoryUsage();
+		total.tableReplacements += worker->table.getReplacements();
+		total.nodeBytes += worker->nodes.getMemoryUsage();
+		total.openBytes += worker->open.getMemoryUsage();
+
+		total.store.states += store.states;
+		total.store.chunks += store.chunks;
+		total.store.rawChunks += store.rawChunks;
+		total.store.deltaChunks += store.deltaChunks;
+		total.store.dedupedChunks += store.dedupedChunks;
+		total.store.logicalBytes += store.logicalBytes;
+		total.store.storedBytes += store.storedBytes;
+	}
+
+	return total;
+}
+
+template <typename Simulator, typename Heuristic>
+void ParallelEngine<Simulator, Heuristic>::reset() {
+	for (std::unique_ptr<Worker>& worker : workers) {
+		Message discarded;
+		while (worker->inbox.pop(discarded)) {
+		}
+
+		worker->nodes.clear();
+		worker->nodes.reserve(settings.reserveNodes / workers.size());
+		worker->open.clear();
+		worker->states = StateStore{};
+		worker->table.clear();
+		worker->statistics = ParallelSearchStatistics{};
+		worker->lastChild = NodeArena::NONE;
+		worker->diveCandidate = NodeArena::NONE;
+		worker->bound = 0;
+		worker->diveLength = 0;
+	}
+
+	quiescence = 0;
+	expansions = 0;
+	incumbent = std::numeric_limits<uint32_t>::max();
+	stop = false;
+	goalNode = NodeArena::NONE;
+	error = nullptr;
+}
+
+template <typename Simulator, typename Heuristic>
+void ParallelEngine<Simulator, Heuristic>::work(uint32_t id) {
+	constexpr uint64_t IDLE = uint64_t{1} << 32;
+
+	Worker& worker = *workers[id];
+	bool idle = false;
+
+	try {
+		while (!stop.load(std::memory_order_relaxed)) {
+			if (!worker.inbox.empty()) {
+				// Has to happen before the messages are counted as received, see isDone
+				if (idle) quiescence.fetch_sub(IDLE);
+				idle = false;
+
+				receive(worker);
+			}
+
+			if (!worker.open.empty()) {
+				const NodeArena::Index node = nextNode(worker);
+
+				// Dives leave their nodes in the open list
+				if (worker.nodes.hasFlag(node, NodeArena::EXPANDED)) continue;
+
+				// Messages arrive out of order, so the key isn't reliable. The incumbent only gets better, so anything
+				// that can't beat it is useless for good
+				if (worker.nodes.getEstimate(node) >= incumbent.load(std::memory_order_relaxed)) continue;
+
+				if (worker.nodes.hasFlag(node, NodeArena::GOAL)) {
+					offerGoal(id, node);
+					continue;
+				}
+
+				if ((settings.maxExpansions != 0) && (expansions.fetch_add(1) >= settings.maxExpansions)) {
+					stop = true;
+					break;
+				}
+
+				expand(id, node);
+				continue;
+			}
+
+			if (!idle) quiescence.fetch_add(IDLE);
+			idle = true;
+
+			if (isDone()) {
+				stop = true;
+				break;
+			}
+
+			std::this_thread::yield();
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(goalMutex);
+
+		if (!error) error = std::current_exception();
+		stop = true;
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+bool ParallelEngine<Simulator, Heuristic>::receive(Worker& worker) {
+	Message message;
+	bool received = false;
+
+	while (worker.inbox.pop(message)) {
+		accept(worker, message, StateStore::NONE);
+		quiescence.fetch_sub(1);
+
+		received = true;
+	}
+
+	return received;
+}
+
+template <typename Simulator, typename Heuristic>
+NodeArena::Index ParallelEngine<Simulator, Heuristic>::accept(Worker& worker, Message& message,
+                                                              StateStore::Handle base) {
+	// Goals always make it into the open list
+	if (!message.goal && isTransposition(worker, message.hash, message.cost)) {
+		++worker.statistics.transpositions;
+
+		return NodeArena::NONE;
+	}
+
+	if (worker.nodes.size() >= getLocal(NodeArena::NONE)) throw std::length_error("NodeArena is full");
+
+	// Goals are never expanded, no need to keep their state
+	const StateStore::Handle state =
+	    message.goal ? StateStore::NONE : worker.states.insert(message.state.view(), base);
+	const NodeArena::Index node = worker.nodes.add(message.parent, message.cost, message.heuristic, message.action,
+	                                               state, message.goal ? NodeArena::GOAL : 0);
+
+	worker.open.push(worker.nodes.getEstimate(node), node);
+	worker.statistics.maxOpen = std::max(worker.statistics.maxOpen, worker.open.size());
+
+	return node;
+}
+
+template <typename Simulator, typename Heuristic>
+NodeArena::Index ParallelEngine<Simulator, Heuristic>::nextNode(Worker& worker) {
+	const NodeArena::Index child = worker.diveCandidate;
+	worker.diveCandidate = NodeArena::NONE;
+
+	// Carrying on from the state the simulator is at saves a rewind. The node stays in the open list and is skipped
+	// when it comes up there
+	if ((child != NodeArena::NONE) && (worker.diveLength < settings.batchSize) &&
+	    !worker.nodes.hasFlag(child, NodeArena::GOAL) && (worker.nodes.getEstimate(child) <= worker.bound)) {
+		++worker.diveLength;
+
+		return child;
+	}
+
+	const auto [key, node] = worker.open.pop();
+
+	++worker.statistics.batches;
+	worker.bound = static_cast<uint64_t>(key) + settings.batchEpsilon;
+	worker.diveLength = 1;
+
+	return node;
+}
+
+template <typename Simulator, typename Heuristic>
+void ParallelEngine<Simulator, Heuristic>::expand(uint32_t id, NodeArena::Index node) {
+	Worker& worker = *workers[id];
+
+	++worker.statistics.expansions;
+
+	if (node != worker.lastChild) ++worker.statistics.rewinds;
+
+	const StateStore::Handle parentState = worker.nodes.getState(node);
+	worker.states.restore(parentState, worker.current);
+
+	const std::vector<Action>& actions = worker.simulator->getActions();
+
+	// Same order as Engine, the inputs that lead here go last
+	const size_t repeated = worker.nodes.getAction(node);
+
+	for (size_t i = 0; i < actions.size(); ++i) {
+		const size_t action = (repeated < actions.size()) ? ((repeated + 1 + i) % actions.size()) : i;
+		const SimulationOutcome outcome =
+		    worker.simulator->simulate(worker.current.view(), actions[action], worker.next);
+
+		++worker.statistics.generated;
+
+		// The simulator is at this child now, which is only of use if we keep it
+		worker.lastChild = NodeArena::NONE;
+
+		const uint64_t cost = static_cast<uint64_t>(worker.nodes.getCost(node)) + outcome.cost;
+		const uint32_t estimate = outcome.goal ? 0 : worker.heuristic(worker.next.view());
+
+		if (!outcome.valid || ((cost + estimate) > settings.maxCost) ||
+		    ((cost + estimate) >= incumbent.load(std::memory_order_relaxed))) {
+			++worker.statistics.pruned;
+
+			continue;
+		}
+
+		Message message;
+		message.hash = quantizer.hash(worker.next.view());
+		message.parent = makeGlobal(id, node);
+		message.cost = static_cast<uint32_t>(cost);
+		message.heuristic = estimate;
+		message.action = static_cast<NodeArena::Action>(action);
+		message.goal = outcome.goal;
+		std::swap(message.state, worker.next);
+
+		if (getOwner(message.hash) == id) {
+			// Our own children can be stored as delta against the parent
+			worker.lastChild = accept(worker, message, parentState);
+		} else {
+			send(id, std::move(message));
+		}
+	}
+
+	worker.states.release(parentState);
+	worker.nodes.setState(node, StateStore::NONE);
+	worker.nodes.setFlag(node, NodeArena::EXPANDED);
+
+	worker.diveCandidate = worker.lastChild;
+}
+
+template <typename Simulator, typename Heuristic>
+void ParallelEngine<Simulator, Heuristic>::send(uint32_t from, Message&& message) {
+	++workers[from]->statistics.messages;
+
+	// Counted before it becomes visible, so it is never missed by isDone
+	quiescence.fetch_add(1);
+	workers[getOwner(message.hash)]->inbox.push(std::move(message));
+}
+
+template <typename Simulator, typename Heuristic>
+void ParallelEngine<Simulator, Heuristic>::offerGoal(uint32_t id, NodeArena::Index node) {
+	std::lock_guard<std::mutex> lock(goalMutex);
+
+	const uint32_t cost = workers[id]->nodes.getCost(node);
+
+	if (cost < incumbent) {
+		incumbent = cost;
+		goalNode = makeGlobal(id, node);
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+bool ParallelEngine<Simulator, Heuristic>::isTransposition(Worker& worker, uint64_t hash, uint32_t cost) {
+	if (!worker.table.isEnabled()) return false;
+
+	return worker.table.update(hash, cost) == Utils::TranspositionTable::Result::DUPLICATE;
+}
+
+template <typename Simulator, typename Heuristic>
+bool ParallelEngine<Simulator, Heuristic>::isDone() const {
+	// Idle workers only wake up for messages, so once all of them are idle with nothing in flight nobody ever will
+	return quiescence.load() == (static_cast<uint64_t>(workers.size()) << 32);
+}
+
+template <typename Simulator, typename Heuristic>
+typename ParallelEngine<Simulator, Heuristic>::Result ParallelEngine<Simulator, Heuristic>::makeResult() {
+	Result result;
+
+	if (goalNode != NodeArena::NONE) {
+		const std::vector<Action>& actions = workers.front()->simulator->getActions();
+
+		result.found = true;
+		result.cost = incumbent;
+
+		for (uint32_t global = goalNode;;) {
+			const NodeArena& nodes = workers[getWorker(global)]->nodes;
+			const NodeArena::Index node = getLocal(global);
+
+			if (nodes.getParent(node) == NodeArena::NONE) break;
+
+			result.actions.push_back(actions[nodes.getAction(node)]);
+			global = nodes.getParent(node);
+		}
+
+		std::reverse(result.actions.begin(), result.actions.end());
+	}
+
+	result.statistics = getStatistics();
+
+	return result;
+}
+
+template <typename Simulator, typename Heuristic>
+uint32_t ParallelEngine<Simulator, Heuristic>::getOwner(uint64_t hash) const {
+	// The transposition tables take the bucket from the lowest bits and the tag from the upper half. The top of the lower
+	// half is left, so every worker's table still sees all buckets and tags
+	return static_cast<uint32_t>(((hash & 0xFFFFFFFF) * workers.size()) >> 32);
+}
+
+}  // namespace TMStar
+
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+#include "TMInterface/SimState.h"
+
+namespace TMStar {
+
+struct RewindStatistics {
+	// C_SIM_REWIND_TO_TIME, 4 bytes each
+	uint64_t timeRewinds = 0;
+	// C_SIM_REWIND_TO_STATE, the whole state each
+	uint64_t stateRewinds = 0;
+	// Rewinds to time the server couldn't serve, which were repeated by state
+	uint64_t rejected = 0;
+};
+
+struct RewindPlan {
+	bool byTime;
+	// Step time (the one S_ON_SIM_STEP reports) of the target state
+	uint32_t time;
+	uint64_t hash;
+};
+
+// Keeps track of the states the server saved on its current trajectory, so rewinds to them only need their time.
+// The server saves the state of every step it enters and of every state it is rewound to, and drops everything after
+// that time whenever it does. Only states we read (or sent) ourselves are known by hash, which is all a search needs,
+// since its nodes are exactly those states.
+class RewindPlanner {
+protected:
+	// Step time -> hash of the state the server saved there
+	std::map<uint32_t, uint64_t> trajectory;
+	// Step time minus race time, learned from the states read
+	int64_t timeOffset;
+	bool offsetKnown;
+	uint32_t currentTime;
+	bool enabled;
+	RewindStatistics statistics;
+
+public:
+	explicit RewindPlanner(bool enabled = true);
+
+	// How to get the server back to the state
+	RewindPlan plan(const TMInterface::SimStateView& state) const;
+
+	// The server entered a step and saved a state we know nothing about yet
+	void onStep(uint32_t time);
+	// The state of the current step was read
+	void onRead(const TMInterface::SimStateView& state);
+	// The plan was carried out
+	void onRewound(const RewindPlan& plan);
+	// The server refused a rewind to time. Turns time rewinds off if none ever worked
+	void onRejected();
+	// The server started a new simulation and forgot all states
+	void clear();
+
+	bool isEnabled() const;
+	const RewindStatistics& getStatistics() const;
+
+	// Delete copy stuff
+	RewindPlanner(const RewindPlanner&) = delete;
+	RewindPlanner& operator=(const RewindPlanner&) = delete;
+
+protected:
+	// Forgets everything after time, like the server does
+	void truncate(uint32_t time);
+};
+
+}  // namespace TMStar
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Engine.h"
+#include "TMInterface/SimState.h"
+#include "TMInterface/Utils/MappedFile.h"
+
+namespace TMStar {
+
+// Results of simulations that were run before, kept on disk across searches. A transition is addressed by the hash of
+// the exact state it started from and the hash of the input segment applied to it (see InterfaceSimulator's
+// getSegmentHash). Two memory mapped files:
+//   index  IndexHeader and an open addressing table of Slots, from the transition's key to its record
+//   data   DataHeader and the Records, appended. Each is followed by the resulting state, encoded as a
+//          StateStore::encodeDelta against the state it started from if that is smaller
+// The resulting state includes the checkpoint times, so a hit gives everything the server would have told us.
+// Use one directory per map, nothing else about the track is in the key. Not thread safe.
+class SimulationCache {
+public:
+	static constexpr uint32_t MAGIC = 0x43534D54;  // "TMSC"
+	static constexpr uint32_t VERSION = 1;
+
+	struct Statistics {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t inserts = 0;
+		// Transitions on disk
+		uint64_t entries = 0;
+		uint64_t dataBytes = 0;
+	};
+
+	struct IndexHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t slotCount;
+		uint64_t count;
+		// Of the data file, including its header
+		uint64_t dataBytes;
+	};
+
+	struct Slot {
+		uint64_t key;
+		// Into the data file, 0 if the slot is empty
+		uint64_t offset;
+	};
+
+	struct DataHeader {
+		uint32_t magic;
+		uint32_t version;
+	};
+
+	struct Record {
+		uint64_t key;
+		uint32_t parentSize;
+		uint32_t resultSize;
+		uint32_t encodedSize;
+		uint32_t cost;
+		uint8_t goal;
+		uint8_t valid;
+		uint8_t delta;
+		uint8_t padding;
+	};
+
+protected:
+	const std::string directory;
+	std::unique_ptr<TMInterface::Utils::MappedFile> index;
+	std::unique_ptr<TMInterface::Utils::MappedFile> data;
+	Statistics statistics;
+
+	// Reused for every lookup and insert
+	std::vector<uint8_t> result;
+	std::vector<uint8_t> encoded;
+
+public:
+	// Opens the cache in directory, or starts a new one if there is none (or one of another version)
+	explicit SimulationCache(const std::string& directory, size_t initialSlots = size_t{1} << 20);
+	~SimulationCache();
+
+	// from is the starting state as StateStore::serialize writes it
+	static uint64_t getKey(const std::vector<uint8_t>& from, uint64_t segment);
+
+	// Returns false on a miss, and leaves outcome and to alone
+	bool find(uint64_t key, const std::vector<uint8_t>& from, SimulationOutcome& outcome, TMInterface::SimState& to);
+	void insert(uint64_t key, const std::vector<uint8_t>& from, const SimulationOutcome& outcome,
+	            const TMInterface::SimStateView& to);
+
+	// Writes dirty pages back to the files. Asynchronously only schedules the write back
+	void flush(bool async = true);
+	const Statistics& getStatistics() const;
+
+	// Delete copy stuff
+	SimulationCache(const SimulationCache&) = delete;
+	SimulationCache& operator=(const SimulationCache&) = delete;
+
+protected:
+	bool open();
+	void create(size_t slotCount);
+	// Doubles the index, built next to it and moved there when done
+	void grow();
+	IndexHeader& getHeader() const;
+	Slot* getSlots() const;
+	// The slot of key, or the empty one where it would go
+	Slot& findSlot(uint64_t key) const;
+	// Record at offset if it is complete and for key
+	const Record* getRecord(uint64_t offset, uint64_t key) const;
+	std::string getPath(const std::string& name) const;
+};
+
+}  // namespace TMStar
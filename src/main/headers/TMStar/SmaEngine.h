@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "Engine.h"
+#include "NodeArena.h"
+#include "StateStore.h"
+#include "TMInterface/SimState.h"
+
+namespace TMStar {
+
+// Simplified memory bounded A* (SMA*). Searches like Engine until SearchSettings::memoryBudget is used up, then forgets
+// the worst leaves (highest estimate, shallowest first). Their parent remembers the best estimate it forgot and goes
+// (back) into the open list with it, to generate the forgotten children again once that is the best estimate. So no
+// path is lost for good. Estimates are backed up from the children to their parents, which keeps the expansion order
+// A*'s. The result is optimal as long as the optimal path fits into the budget, otherwise the search gives up.
+// Simulator and Heuristic have the same requirements as for Engine, except that the heuristic only has to be
+// admissible. There is no transposition table, since a forgotten node has to be generated again at the same cost.
+template <typename Simulator, typename Heuristic = ZeroHeuristic>
+class SmaEngine {
+public:
+	using Action = typename Simulator::Action;
+	using Result = SearchResult<Action>;
+
+	static constexpr uint32_t INFINITE = std::numeric_limits<uint32_t>::max();
+
+protected:
+	struct OpenEntry {
+		uint32_t estimate;
+		uint32_t depth;
+		NodeArena::Index node;
+
+		// Best estimate first, deeper first among equal ones. The worst leaf ends up last
+		bool operator<(const OpenEntry& other) const;
+	};
+
+	// Tree structure and backed up estimates, next to the NodeArena columns
+	struct Links {
+		NodeArena::Index firstChild;
+		NodeArena::Index nextSibling;
+		NodeArena::Index previousSibling;
+		// Best estimate of the children that were forgotten
+		uint32_t forgotten;
+		// Lowest estimate of any path through the node that is known
+		uint32_t estimate;
+		uint32_t depth;
+	};
+
+	// Red-black tree node around the entry
+	static constexpr size_t OPEN_ENTRY_BYTES = sizeof(OpenEntry) + (4 * sizeof(void*));
+
+	Simulator& simulator;
+	Heuristic heuristic;
+	const SearchSettings settings;
+
+	NodeArena nodes;
+	std::vector<Links> links;
+	std::set<OpenEntry> open;
+	StateStore states;
+	SearchStatistics statistics;
+	// Most a single expansion added to the states and the open list so far
+	size_t expansionBytes;
+	// Actions of the children a node still has, reused for every expansion
+	std::vector<bool> present;
+
+	// Reused for every expansion
+	TMInterface::SimState current;
+	TMInterface::SimState next;
+
+public:
+	SmaEngine(Simulator& simulator, const SearchSettings& settings = {}, const Heuristic& heuristic = {});
+
+	Result run(const TMInterface::SimStateView& start);
+
+	const NodeArena& getNodes() const;
+	const SearchStatistics& getStatistics() const;
+	// Nodes, links, states and the open list
+	size_t getMemoryUsage() const;
+
+protected:
+	void reset();
+	// Generates the children the node doesn't have (all of them for a leaf)
+	void expand(NodeArena::Index node);
+	// Children are estimated at least at bound
+	NodeArena::Index addNode(NodeArena::Index parent, NodeArena::Action action, const SimulationOutcome& outcome,
+	                         uint32_t bound);
+	// Recomputes the estimates of the node and its ancestors from their children
+	void backUp(NodeArena::Index node);
+	// Forgets leaves until the next expansion fits into the budget. Returns false if there is nothing left to forget
+	bool shrink();
+	// What the next expansion may add: as much as any expansion did so far, and the arena if it has to grow
+	size_t getHeadroom() const;
+	// Removes a leaf and updates its parent
+	void forget(NodeArena::Index node);
+	// Leaves are in the open list with their estimate, other nodes with the best estimate they forgot, if any
+	uint32_t getOpenKey(NodeArena::Index node) const;
+	void pushOpen(NodeArena::Index node);
+	void popOpen(NodeArena::Index node);
+	bool isExpansionLimitReached() const;
+	Result makeResult(NodeArena::Index goal);
+};
+
+}  // namespace TMStar
+
+#define TMStar_SmaEngine_Proper_Included
+
+#include "SmaEngine.inc.h"
+
+#undef TMStar_SmaEngine_Proper_Included
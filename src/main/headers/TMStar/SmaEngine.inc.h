@@ -0,0 +1,329 @@
+#pragma once
+
+#include "SmaEngine.h"
+
+#ifdef TMStar_SmaEngine_Proper_Included
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace TMStar {
+
+template <typename Simulator, typename Heuristic>
+bool SmaEngine<Simulator, Heuristic>::OpenEntry::operator<(const OpenEntry& other) const {
+	if (estimate != other.estimate) return estimate < other.estimate;
+	if (depth != other.depth) return depth > other.depth;
+
+	return node < other.node;
+}
+
+template <typename Simulator, typename Heuristic>
+SmaEngine<Simulator, Heuristic>::SmaEngine(Simulator& simulator, const SearchSettings& settings,
+                                           const Heuristic& heuristic)
+    : simulator(simulator), heuristic(heuristic), settings(settings), expansionBytes(0) {}
+
+template <typename Simulator, typename Heuristic>
+typename SmaEngine<Simulator, Heuristic>::Result SmaEngine<Simulator, Heuristic>::run(
+    const TMInterface::SimStateView& start) {
+	if (simulator.getActions().size() >= NodeArena::NO_ACTION) {
+		throw std::invalid_argument("Too many actions");
+	}
+
+	reset();
+
+	const NodeArena::Index root =
+	    nodes.add(NodeArena::NONE, 0, heuristic(start), NodeArena::NO_ACTION, states.insert(start));
+
+	links.resize(root + 1);
+	links[root] = Links{NodeArena::NONE, NodeArena::NONE, NodeArena::NONE, INFINITE, nodes.getEstimate(root), 0};
+	pushOpen(root);
+
+	while (!open.empty()) {
+		// Room for the next expansion up front, so the budget also holds at the peak
+		if ((settings.memoryBudget != 0) && !shrink()) break;
+
+		const NodeArena::Index node = open.begin()->node;
+
+		if (open.begin()->estimate == INFINITE) break;
+
+		// Goals are tested when popped, not when generated. Otherwise a cheaper path could still be in the open list
+		if (nodes.hasFlag(node, NodeArena::GOAL)) return makeResult(node);
+
+		if (isExpansionLimitReached()) break;
+
+		// The arena grows in steps, getHeadroom() accounts for that
+		const size_t before = states.getStatistics().storedBytes + (open.size() * OPEN_ENTRY_BYTES);
+
+		expand(node);
+
+		const size_t after = states.getStatistics().storedBytes + (open.size() * OPEN_ENTRY_BYTES);
+
+		if (after > before) expansionBytes = std::max(expansionBytes, after - before);
+
+		statistics.peakBytes = std::max(statistics.peakBytes, getMemoryUsage());
+		statistics.maxOpen = std::max(statistics.maxOpen, open.size());
+	}
+
+	return makeResult(NodeArena::NONE);
+}
+
+template <typename Simulator, typename Heuristic>
+const NodeArena& SmaEngine<Simulator, Heuristic>::getNodes() const {
+	return nodes;
+}
+
+template <typename Simulator, typename Heuristic>
+const SearchStatistics& SmaEngine<Simulator, Heuristic>::getStatistics() const {
+	return statistics;
+}
+
+template <typename Simulator, typename Heuristic>
+size_t SmaEngine<Simulator, Heuristic>::getMemoryUsage() const {
+	return nodes.getMemoryUsage() + (links.capacity() * sizeof(Links)) + states.getStatistics().storedBytes +
+	       (open.size() * OPEN_ENTRY_BYTES);
+}
+
+template <typename Simulator, typename Heuristic>
+void SmaEngine<Simulator, Heuristic>::reset() {
+	constexpr size_t bytesPerNode = NodeArena::BYTES_PER_NODE + sizeof(Links);
+
+	nodes.clear();
+	links.clear();
+	open.clear();
+	states = StateStore{};
+	statistics = SearchStatistics{};
+	expansionBytes = 0;
+
+	// A small part of the budget at most, the states need most of it
+	const size_t reserve = (settings.memoryBudget == 0)
+	                           ? settings.reserveNodes
+	                           : std::min(settings.reserveNodes, settings.memoryBudget / (8 * bytesPerNode));
+
+	nodes.reserve(reserve);
+	links.reserve(reserve);
+}
+
+template <typename Simulator, typename Heuristic>
+void SmaEngine<Simulator, Heuristic>::expand(NodeArena::Index node) {
+	++statistics.expansions;
+
+	// A lower bound for every child that is generated
+	const uint32_t bound = getOpenKey(node);
+	const std::vector<Action>& actions = simulator.getActions();
+
+	popOpen(node);
+	states.restore(nodes.getState(node), current);
+
+	present.assign(actions.size(), false);
+
+	for (NodeArena::Index child = links[node].firstChild; child != NodeArena::NONE; child = links[child].nextSibling) {
+		present[nodes.getAction(child)] = true;
+	}
+
+	// Everything that was forgotten is generated again
+	links[node].forgotten = INFINITE;
+
+	// Same order as Engine, the inputs that lead here go last
+	const size_t repeated = nodes.getAction(node);
+
+	for (size_t i = 0; i < actions.size(); ++i) {
+		const size_t action = (repeated < actions.size()) ? ((repeated + 1 + i) % actions.size()) : i;
+
+		if (present[action]) continue;
+
+		const SimulationOutcome outcome = simulator.simulate(current.view(), actions[action], next);
+		const NodeArena::Index child = addNode(node, static_cast<NodeArena::Action>(action), outcome, bound);
+
+		if (child != NodeArena::NONE) pushOpen(child);
+	}
+
+	nodes.setFlag(node, NodeArena::EXPANDED);
+
+	if (links[node].firstChild == NodeArena::NONE) {
+		// Dead end
+		links[node].estimate = INFINITE;
+		forget(node);
+	} else {
+		backUp(node);
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+NodeArena::Index SmaEngine<Simulator, Heuristic>::addNode(NodeArena::Index parent, NodeArena::Action action,
+                                                          const SimulationOutcome& outcome, uint32_t bound) {
+	++statistics.generated;
+
+	const uint64_t cost = static_cast<uint64_t>(nodes.getCost(parent)) + outcome.cost;
+	const uint32_t estimate = outcome.goal ? 0 : heuristic(next.view());
+
+	if (!outcome.valid || ((cost + estimate) > settings.maxCost)) {
+		++statistics.pruned;
+
+		return NodeArena::NONE;
+	}
+
+	// Goals are never expanded, no need to keep their state
+	const StateStore::Handle state =
+	    outcome.goal ? StateStore::NONE : states.insert(next.view(), nodes.getState(parent));
+	const NodeArena::Index child =
+	    nodes.add(parent, static_cast<uint32_t>(cost), estimate, action, state, outcome.goal ? NodeArena::GOAL : 0);
+
+	if (links.size() <= child) links.resize(child + 1);
+
+	Links& parentLinks = links[parent];
+
+	// A child can't be estimated lower than its parent was backed up to, that path was already looked at
+	links[child] = Links{NodeArena::NONE,
+	                     parentLinks.firstChild,
+	                     NodeArena::NONE,
+	                     INFINITE,
+	                     std::max(bound, nodes.getEstimate(child)),
+	                     parentLinks.depth + 1};
+
+	if (parentLinks.firstChild != NodeArena::NONE) links[parentLinks.firstChild].previousSibling = child;
+	parentLinks.firstChild = child;
+
+	return child;
+}
+
+template <typename Simulator, typename Heuristic>
+void SmaEngine<Simulator, Heuristic>::backUp(NodeArena::Index node) {
+	for (; node != NodeArena::NONE; node = nodes.getParent(node)) {
+		uint32_t best = links[node].forgotten;
+
+		for (NodeArena::Index child = links[node].firstChild; child != NodeArena::NONE;
+		     child = links[child].nextSibling) {
+			best = std::min(best, links[child].estimate);
+		}
+
+		if (best == links[node].estimate) break;
+
+		links[node].estimate = best;
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+bool SmaEngine<Simulator, Heuristic>::shrink() {
+	while ((getMemoryUsage() + getHeadroom()) > settings.memoryBudget) {
+		typename std::set<OpenEntry>::const_iterator worst = std::prev(open.end());
+
+		// Only leaves can be forgotten. The best entry stays, the path to it has to fit
+		while ((worst != open.begin()) && (links[worst->node].firstChild != NodeArena::NONE)) --worst;
+
+		if (worst == open.begin()) return false;
+
+		forget(worst->node);
+		++statistics.evictions;
+	}
+
+	return true;
+}
+
+template <typename Simulator, typename Heuristic>
+size_t SmaEngine<Simulator, Heuristic>::getHeadroom() const {
+	const size_t capacity = nodes.getCapacity();
+
+	// Growing doubles the capacity of the arena and the links
+	if ((nodes.getLiveCount() + simulator.getActions().size()) <= capacity) return expansionBytes;
+
+	return expansionBytes + (capacity * (NodeArena::BYTES_PER_NODE + sizeof(Links)));
+}
+
+template <typename Simulator, typename Heuristic>
+void SmaEngine<Simulator, Heuristic>::forget(NodeArena::Index node) {
+	const NodeArena::Index parent = nodes.getParent(node);
+	const Links& nodeLinks = links[node];
+
+	popOpen(node);
+
+	if (parent != NodeArena::NONE) {
+		Links& parentLinks = links[parent];
+
+		// Its key changes
+		popOpen(parent);
+
+		if (nodeLinks.previousSibling != NodeArena::NONE) {
+			links[nodeLinks.previousSibling].nextSibling = nodeLinks.nextSibling;
+		} else {
+			parentLinks.firstChild = nodeLinks.nextSibling;
+		}
+
+		if (nodeLinks.nextSibling != NodeArena::NONE) {
+			links[nodeLinks.nextSibling].previousSibling = nodeLinks.previousSibling;
+		}
+
+		parentLinks.forgotten = std::min(parentLinks.forgotten, nodeLinks.estimate);
+	}
+
+	if (nodes.getState(node) != StateStore::NONE) states.release(nodes.getState(node));
+	nodes.remove(node);
+
+	if (parent == NodeArena::NONE) return;
+
+	if (links[parent].firstChild != NodeArena::NONE) {
+		// Only changes anything if the node was a dead end
+		backUp(parent);
+		pushOpen(parent);
+	} else if (links[parent].forgotten == INFINITE) {
+		links[parent].estimate = INFINITE;
+		forget(parent);
+	} else {
+		// A leaf again, to be expanded once its best forgotten child is the best node
+		links[parent].estimate = links[parent].forgotten;
+		backUp(nodes.getParent(parent));
+		pushOpen(parent);
+	}
+}
+
+template <typename Simulator, typename Heuristic>
+uint32_t SmaEngine<Simulator, Heuristic>::getOpenKey(NodeArena::Index node) const {
+	return (links[node].firstChild == NodeArena::NONE) ? links[node].estimate : links[node].forgotten;
+}
+
+template <typename Simulator, typename Heuristic>
+void SmaEngine<Simulator, Heuristic>::pushOpen(NodeArena::Index node) {
+	const uint32_t key = getOpenKey(node);
+
+	// Nothing to generate again
+	if ((links[node].firstChild != NodeArena::NONE) && (key == INFINITE)) return;
+
+	open.insert(OpenEntry{key, links[node].depth, node});
+}
+
+template <typename Simulator, typename Heuristic>
+void SmaEngine<Simulator, Heuristic>::popOpen(NodeArena::Index node) {
+	open.erase(OpenEntry{getOpenKey(node), links[node].depth, node});
+}
+
+template <typename Simulator, typename Heuristic>
+bool SmaEngine<Simulator, Heuristic>::isExpansionLimitReached() const {
+	return (settings.maxExpansions != 0) && (statistics.expansions >= settings.maxExpansions);
+}
+
+template <typename Simulator, typename Heuristic>
+typename SmaEngine<Simulator, Heuristic>::Result SmaEngine<Simulator, Heuristic>::makeResult(NodeArena::Index goal) {
+	Result result;
+
+	if (goal != NodeArena::NONE) {
+		const std::vector<Action>& actions = simulator.getActions();
+
+		result.found = true;
+		result.cost = nodes.getCost(goal);
+
+		for (NodeArena::Action action : nodes.getPath(goal)) {
+			result.actions.push_back(actions[action]);
+		}
+	}
+
+	statistics.nodeBytes = nodes.getMemoryUsage() + (links.capacity() * sizeof(Links));
+	statistics.openBytes = open.size() * OPEN_ENTRY_BYTES;
+	statistics.store = states.getStatistics();
+	result.statistics = statistics;
+
+	return result;
+}
+
+}  // namespace TMStar
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "TMInterface/SimState.h"
+
+namespace TMStar {
+
+// Hash of the whole state, including the checkpoint arrays. Equal states hash equal
+uint64_t hashState(const TMInterface::SimStateView& state);
+
+// Grid the physics of a state are snapped to before hashing. Differences below a step don't tell states apart
+struct QuantizationSettings {
+	// Meters
+	float position = 0.05f;
+	// Meters per second
+	float velocity = 0.1f;
+	// Of the orientation values, radians for the emulator's yaw
+	float orientation = 0.01f;
+};
+
+// Hashes position, velocity and orientation from state2 on a grid, plus the checkpoints taken. States reached by
+// different inputs that ended up (nearly) in the same place at the same speed hash equal, regardless of race time.
+class StateQuantizer {
+public:
+	static constexpr size_t ORIENTATION_VALUES = 4;
+	// Position, velocity and orientation, padded to whole SIMD blocks
+	static constexpr size_t VALUES = 12;
+
+protected:
+	std::array<float, VALUES> scales;
+
+public:
+	explicit StateQuantizer(const QuantizationSettings& settings = {});
+
+	uint64_t hash(const TMInterface::SimStateView& state) const;
+};
+
+}  // namespace TMStar
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+
+namespace TMStar {
+
+// Compact storage for simulation states. States are serialized like they are sent over the wire and cut into fixed
+// size chunks. Identical chunks are stored once (content addressed), and chunks that differ from the chunk at the same
+// position in the parent state are stored as an XOR/RLE delta against it.
+// Not thread safe. Every search worker owns its own store.
+class StateStore {
+public:
+	using Handle = uint32_t;
+
+	static constexpr Handle NONE = std::numeric_limits<Handle>::max();
+	static constexpr size_t CHUNK_SIZE = 256;
+	// Longest chain of deltas that has to be applied to rebuild a chunk
+	static constexpr uint32_t MAX_DELTA_DEPTH = 8;
+
+	struct Statistics {
+		size_t states = 0;
+		size_t chunks = 0;
+		size_t rawChunks = 0;
+		size_t deltaChunks = 0;
+		// Chunks that were found in the store instead of being added
+		size_t dedupedChunks = 0;
+		// Bytes the states would take up uncompressed
+		size_t logicalBytes = 0;
+		// Bytes actually used, including bookkeeping
+		size_t storedBytes = 0;
+	};
+
+protected:
+	using ChunkId = uint32_t;
+
+	struct Chunk {
+		uint64_t hash;
+		// Raw bytes if base is NONE, encoded delta against base otherwise. Point into owned, or into the changes
+		// loadChanges used in place
+		const uint8_t* bytes;
+		std::unique_ptr<uint8_t[]> owned;
+		ChunkId base;
+		uint32_t refs;
+		uint16_t size;
+		uint16_t encodedSize;
+		uint8_t depth;
+	};
+
+	struct Entry {
+		std::vector<ChunkId> chunks;
+		uint32_t size;
+		uint32_t refs;
+	};
+
+	enum RecordType : uint8_t {
+		CHUNK_RECORD,
+		ENTRY_RECORD,
+		// Only kept until compactChanges
+		FREE_CHUNK_RECORD,
+		FREE_ENTRY_RECORD,
+	};
+
+	// Followed by encodedSize bytes
+	struct ChunkRecord {
+		uint8_t type;
+		uint8_t depth;
+		uint16_t size;
+		uint16_t encodedSize;
+		uint16_t padding;
+		ChunkId id;
+		ChunkId base;
+		uint64_t hash;
+	};
+
+	// Followed by chunkCount ChunkIds
+	struct EntryRecord {
+		uint8_t type;
+		uint8_t padding[3];
+		Handle handle;
+		uint32_t size;
+		uint32_t chunkCount;
+	};
+
+	struct FreeRecord {
+		uint8_t type;
+		uint8_t padding[3];
+		uint32_t id;
+	};
+
+	std::vector<Chunk> chunks;
+	std::vector<ChunkId> freeChunks;
+	std::unordered_map<uint64_t, ChunkId> chunksByHash;
+
+	std::vector<Entry> entries;
+	std::vector<Handle> freeEntries;
+
+	Statistics statistics;
+	// Bytes held by chunks and entries
+	size_t payloadBytes;
+	// Records of what was added and freed since the last saveChanges, once it was called
+	bool tracking;
+	std::vector<uint8_t> changes;
+	// Keeps the changes alive that loadChanges used in place
+	std::shared_ptr<void> changesOwner;
+	// Reused serialization buffers
+	mutable std::vector<uint8_t> scratch;
+	// Bytes of the state restored or used as parent last. Searches restore a node and then insert its children, so
+	// those don't have to rebuild it through its delta chains again
+	mutable std::vector<uint8_t> parentScratch;
+	mutable Handle parentScratchHandle;
+
+public:
+	StateStore();
+
+	// The new state starts with a reference count of 1. Cheapest right after restoring parent
+	Handle insert(const TMInterface::SimStateView& state, Handle parent = NONE);
+	void retain(Handle handle);
+	void release(Handle handle);
+
+	// Rebuilds the full state, e.g. for C_SIM_REWIND_TO_STATE. Reuses the memory of state
+	void restore(Handle handle, TMInterface::SimState& state) const;
+	TMInterface::SimState get(Handle handle) const;
+
+	// Flat bytes of the state, e.g. to keep it on disk while it isn't needed
+	void save(Handle handle, std::vector<uint8_t>& out) const;
+	// Inserts a state written by save
+	Handle load(const uint8_t* data, size_t size);
+
+	// For checkpoints: replaces out with records of the chunks and states added and freed since the last call. The
+	// first call writes everything there is, from then on the records are written as things are added, and a call only
+	// swaps buffers with out. Chunks go as they are stored, deltas included
+	void saveChanges(std::vector<uint8_t>& out);
+	// Rebuilds an empty store from everything saveChanges wrote, keeping only the states in handles (with a reference
+	// each). saveChanges carries on from there. With an owner, which is kept until the store is emptied, the chunks
+	// point into data instead of copying it
+	void loadChanges(const uint8_t* data, size_t size, const std::vector<Handle>& handles,
+	                 std::shared_ptr<void> owner = nullptr);
+
+	Statistics getStatistics() const;
+
+	// The flat format save writes
+	static void serialize(const TMInterface::SimStateView& state, std::vector<uint8_t>& out);
+	static void deserialize(const std::vector<uint8_t>& data, TMInterface::SimState& state);
+	// XOR/RLE delta of data against base. Returns 0 if it takes more than capacity bytes, out needs 8 bytes more than
+	// that. Also returns 0 if the two are the same
+	static size_t encodeDelta(const uint8_t* data, const uint8_t* base, size_t size, uint8_t* out, size_t capacity);
+	static void applyDelta(const uint8_t* delta, size_t deltaSize, uint8_t* inOut);
+	// Appends the records of changes to out, leaving out what was freed again later within them and the records of
+	// frees. loadChanges needs neither
+	static void compactChanges(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+protected:
+	ChunkId addChunk(const uint8_t* data, size_t size, ChunkId parentChunk, const uint8_t* parentData);
+	void releaseChunk(ChunkId id);
+	// Counts a reference to a chunk that loadChanges put in place
+	void retainLoadedChunk(ChunkId id);
+	void writeChunk(ChunkId id, std::vector<uint8_t>& out) const;
+	void writeEntry(Handle handle, std::vector<uint8_t>& out) const;
+	void writeFree(RecordType type, uint32_t id, std::vector<uint8_t>& out) const;
+	// Writes the content of the chunk to out, which needs CHUNK_SIZE bytes of space
+	void materialize(ChunkId id, uint8_t* out) const;
+	bool chunkEquals(ChunkId id, const uint8_t* data, size_t size) const;
+
+	void serialize(Handle handle, std::vector<uint8_t>& out) const;
+
+	static size_t getRecordSize(const uint8_t* record);
+};
+
+}  // namespace TMStar
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace TMStar {
+namespace Utils {
+
+// Fast non cryptographic 64 bit hash. Good enough for hash tables and content addressing
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+// Rounds every values[i] * scales[i] to the nearest integer and hashes those, so values that round the same hash the
+// same. Four values at a time with SSE2 where available, with the same results as without
+uint64_t hashQuantized(const float* values, const float* scales, size_t count, uint64_t seed = 0);
+// hashQuantized without SIMD, to check the two against each other
+uint64_t hashQuantizedScalar(const float* values, const float* scales, size_t count, uint64_t seed = 0);
+
+constexpr uint64_t mix(uint64_t value);
+constexpr uint64_t combine(uint64_t hash, uint64_t value);
+
+// constexpr functions
+constexpr uint64_t mix(uint64_t value) {
+	// Finalizer of MurmurHash3
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+
+	return value;
+}
+
+constexpr uint64_t combine(uint64_t hash, uint64_t value) {
+	return mix(hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2)));
+}
+
+}  // namespace Utils
+}  // namespace TMStar
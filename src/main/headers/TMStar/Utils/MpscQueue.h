@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+namespace TMStar {
+namespace Utils {
+
+// Unbounded lock-free multi producer, single consumer queue (Vyukov). push never waits for other producers or the
+// consumer; pop may only be called from one thread.
+template <typename T>
+class MpscQueue {
+protected:
+	struct Node {
+		std::atomic<Node*> next{nullptr};
+		T value;
+	};
+
+	// Producers append here
+	alignas(64) std::atomic<Node*> head;
+	// Consumer side. Always points at the node whose value was consumed last
+	alignas(64) Node* tail;
+
+public:
+	MpscQueue();
+	~MpscQueue();
+
+	// Delete copy stuff
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	void push(T value);
+	// Returns false if the queue is empty. A push that is still in progress may not be visible yet
+	bool pop(T& value);
+	bool empty() const;
+};
+
+}  // namespace Utils
+}  // namespace TMStar
+
+#define TMStar_Utils_MpscQueue_Proper_Included
+
+#include "MpscQueue.inc.h"
+
+#undef TMStar_Utils_MpscQueue_Proper_Included
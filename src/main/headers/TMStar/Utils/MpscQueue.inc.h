@@ -0,0 +1,55 @@
+#pragma once
+
+#include "MpscQueue.h"
+
+#ifdef TMStar_Utils_MpscQueue_Proper_Included
+
+#include <utility>
+
+namespace TMStar {
+namespace Utils {
+
+template <typename T>
+MpscQueue<T>::MpscQueue() : head(new Node), tail(head.load(std::memory_order_relaxed)) {}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue() {
+	while (tail != nullptr) {
+		Node* next = tail->next.load(std::memory_order_relaxed);
+		delete tail;
+		tail = next;
+	}
+}
+
+template <typename T>
+void MpscQueue<T>::push(T value) {
+	Node* node = new Node;
+	node->value = std::move(value);
+
+	Node* previous = head.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+}
+
+template <typename T>
+bool MpscQueue<T>::pop(T& value) {
+	Node* next = tail->next.load(std::memory_order_acquire);
+
+	if (next == nullptr) return false;
+
+	value = std::move(next->value);
+
+	delete tail;
+	tail = next;
+
+	return true;
+}
+
+template <typename T>
+bool MpscQueue<T>::empty() const {
+	return tail->next.load(std::memory_order_acquire) == nullptr;
+}
+
+}  // namespace Utils
+}  // namespace TMStar
+
+#endif
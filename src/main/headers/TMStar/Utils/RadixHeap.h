@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace TMStar {
+namespace Utils {
+
+// Monotone priority queue for unsigned 32 bit keys. Popped keys never decrease, which is what A* with a consistent
+// heuristic needs. Push and pop are amortized O(log C) where C is the key range, with no comparisons between
+// arbitrary elements. Entries are 8 bytes (key + value).
+template <typename Value>
+class RadixHeap {
+public:
+	using Key = uint32_t;
+	using Entry = std::pair<Key, Value>;
+
+	static constexpr size_t BUCKETS = 33;
+
+protected:
+	// Bucket i holds keys that differ from last in bit i - 1 as their highest bit
+	std::array<std::vector<Entry>, BUCKETS> buckets;
+	Key last;
+	size_t count;
+
+public:
+	RadixHeap();
+
+	bool empty() const;
+	size_t size() const;
+	// Smallest key that can still be pushed
+	Key getLast() const;
+
+	// Keys below getLast() are raised to it
+	void push(Key key, const Value& value);
+	Entry pop();
+	Key topKey();
+
+	void clear();
+	size_t getMemoryUsage() const;
+
+protected:
+	// Makes sure bucket 0 isn't empty
+	void refill();
+
+	static size_t getBucket(Key key, Key last);
+};
+
+}  // namespace Utils
+}  // namespace TMStar
+
+#define TMStar_Utils_RadixHeap_Proper_Included
+
+#include "RadixHeap.inc.h"
+
+#undef TMStar_Utils_RadixHeap_Proper_Included
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "RadixHeap.h"
+
+#ifdef TMStar_Utils_RadixHeap_Proper_Included
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace TMStar {
+namespace Utils {
+
+template <typename Value>
+RadixHeap<Value>::RadixHeap() : last(0), count(0) {}
+
+template <typename Value>
+bool RadixHeap<Value>::empty() const {
+	return count == 0;
+}
+
+template <typename Value>
+size_t RadixHeap<Value>::size() const {
+	return count;
+}
+
+template <typename Value>
+typename RadixHeap<Value>::Key RadixHeap<Value>::getLast() const {
+	return last;
+}
+
+template <typename Value>
+void RadixHeap<Value>::push(Key key, const Value& value) {
+	key = std::max(key, last);
+
+	buckets[getBucket(key, last)].emplace_back(key, value);
+	++count;
+}
+
+template <typename Value>
+typename RadixHeap<Value>::Entry RadixHeap<Value>::pop() {
+	refill();
+
+	Entry entry = buckets[0].back();
+	buckets[0].pop_back();
+	--count;
+
+	return entry;
+}
+
+template <typename Value>
+typename RadixHeap<Value>::Key RadixHeap<Value>::topKey() {
+	refill();
+
+	return last;
+}
+
+template <typename Value>
+void RadixHeap<Value>::clear() {
+	for (std::vector<Entry>& bucket : buckets) {
+		bucket.clear();
+	}
+
+	last = 0;
+	count = 0;
+}
+
+template <typename Value>
+size_t RadixHeap<Value>::getMemoryUsage() const {
+	size_t bytes = 0;
+
+	for (const std::vector<Entry>& bucket : buckets) {
+		bytes += bucket.capacity() * sizeof(Entry);
+	}
+
+	return bytes;
+}
+
+template <typename Value>
+void RadixHeap<Value>::refill() {
+	if (!buckets[0].empty()) return;
+	if (count == 0) throw std::out_of_range("RadixHeap is empty");
+
+	size_t index = 1;
+
+	while (buckets[index].empty()) {
+		++index;
+	}
+
+	std::vector<Entry>& bucket = buckets[index];
+
+	last = std::min_element(bucket.begin(), bucket.end(), [](const Entry& lhs, const Entry& rhs) {
+		       return lhs.first < rhs.first;
+	       })->first;
+
+	// Every entry lands in a lower bucket, so this only touches each entry O(log C) times in total
+	for (const Entry& entry : bucket) {
+		buckets[getBucket(entry.first, last)].push_back(entry);
+	}
+
+	bucket.clear();
+}
+
+template <typename Value>
+size_t RadixHeap<Value>::getBucket(Key key, Key last) {
+	const Key difference = key ^ last;
+
+	if (difference == 0) return 0;
+
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, difference);
+
+	return index + 1;
+#else
+	return 32 - __builtin_clz(difference);
+#endif
+}
+
+}  // namespace Utils
+}  // namespace TMStar
+
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace TMStar {
+namespace Utils {
+
+// Lock-free map from 64 bit keys to the lowest cost seen for them, with a fixed memory budget. Buckets are one cache
+// line of 8 slots, each slot is a single word holding the upper half of the key and the cost, so every update is one
+// CAS. When a bucket is full, its cheapest entry makes room: the search front only moves to higher costs, so cheap
+// entries are the least likely to be hit again.
+// Only the upper 32 bits of the key are stored. Two keys in the same bucket that agree in those are taken for the
+// same, which happens about once in 2^32 lookups.
+class TranspositionTable {
+public:
+	static constexpr size_t SLOTS_PER_BUCKET = 8;
+
+	enum class Result : uint8_t {
+		// Not known before (or got evicted)
+		NEW,
+		// Known, but only at a higher cost
+		IMPROVED,
+		// Known at the same or a lower cost
+		DUPLICATE,
+	};
+
+	// A slot that was written, for checkpoints. Applying the changes in order to a copy of the slots gives the table
+	struct Change {
+		// Bucket times SLOTS_PER_BUCKET plus the slot within it
+		uint64_t slot;
+		uint64_t value;
+	};
+
+protected:
+	struct alignas(64) Bucket {
+		std::array<std::atomic<uint64_t>, SLOTS_PER_BUCKET> slots;
+	};
+
+	// Either storage, or the slots given to attach
+	Bucket* buckets;
+	std::unique_ptr<Bucket[]> storage;
+	std::shared_ptr<void> bucketOwner;
+	size_t bucketCount;
+	std::atomic<uint64_t> replacements;
+	// Slots written since the last saveChanges, once logChanges was called
+	bool logging;
+	std::vector<Change> changes;
+
+public:
+	// Uses at most bytes of memory. Less than a bucket turns the table off
+	explicit TranspositionTable(size_t bytes = 0);
+
+	bool isEnabled() const;
+
+	// Records cost for key, unless the table already knows a cost at least as low. Safe to call concurrently, unless
+	// changes are logged
+	Result update(uint64_t key, uint32_t cost);
+	// Empties the table and stops logging. Not safe to call concurrently with anything else
+	void clear();
+
+	size_t getSlotCount() const;
+	size_t getMemoryUsage() const;
+	// Entries evicted to make room for new ones
+	uint64_t getReplacements() const;
+
+	// For checkpoints: logs every slot update from here on
+	void logChanges();
+	// Hands the updates logged since the last call to out, by swapping buffers with it
+	void saveChanges(std::vector<Change>& out);
+	// Uses count slots in place of its own memory until clear, e.g. a copy on write mapping of a checkpoint. owner
+	// keeps them alive. Returns false, and leaves the table alone, if it has another size
+	bool attach(uint64_t* slots, size_t count, std::shared_ptr<void> owner);
+
+	// Delete copy stuff
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+};
+
+static_assert(sizeof(TranspositionTable::Change) == 16, "Changes are stored as they are");
+
+}  // namespace Utils
+}  // namespace TMStar
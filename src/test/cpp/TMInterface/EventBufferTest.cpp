@@ -0,0 +1,62 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TMInterface/EventBuffer.h"
+#include "TMInterface/Interface.h"
+#include "Test/Peer.h"
+#include "Test/Test.h"
+
+namespace {
+
+using namespace TMInterface;
+
+std::vector<InputEvent> makeEvents() {
+	return {
+	    InputEvent::make(1'000, InputType::ACCELERATE, 1),
+	    InputEvent::make(1'000, InputType::STEER, -65'536),
+	    InputEvent::make(1'100, InputType::STEER, 32'768),
+	    InputEvent::make(1'200, InputType::BRAKE, 1),
+	};
+}
+
+}  // namespace
+
+TEST(InputEvent_packsTypeAndValue) {
+	const std::vector<InputEvent> events = makeEvents();
+
+	CHECK(events[1].getType() == InputType::STEER);
+	CHECK_EQ(events[1].getValue(), -65'536);
+	CHECK_EQ(events[1].time, uint32_t{1'000});
+	CHECK(events[3].getType() == InputType::BRAKE);
+	CHECK_EQ(events[3].getValue(), 1);
+
+	// Signed 24 bit, the extremes survive
+	CHECK_EQ(InputEvent::make(0, InputType::RESPAWN, -(1 << 23)).getValue(), -(1 << 23));
+	CHECK_EQ(InputEvent::make(0, InputType::RESPAWN, (1 << 23) - 1).getValue(), (1 << 23) - 1);
+	CHECK(InputEvent::make(0, InputType::RESPAWN, -1).getType() == InputType::RESPAWN);
+}
+
+TEST(EventBufferView_roundTripsThroughTheServer) {
+	Test::Peer peer;
+	Interface client(peer.getName());
+	const std::vector<InputEvent> events = makeEvents();
+
+	Packets::C_SIM_SET_EVENT_BUFFER set;
+	set.buffer = EventBufferView{500, {events.data(), events.size()}};
+
+	CHECK_EQ(Test::exchange(client, set)->packetId, Packets::S_RESPONSE_ID);
+	CHECK(client.getLastError() == ErrorCode::NONE);
+
+	CHECK_EQ(Test::exchange(client, Packets::C_SIM_GET_EVENT_BUFFER{})->packetId, Packets::S_RESPONSE_ID);
+
+	const EventBufferView received = EventBufferView::read(client);
+
+	CHECK_EQ(received.eventsDuration, uint32_t{500});
+	CHECK_EQ(received.events.size, events.size());
+
+	for (size_t i = 0; i < received.events.size; ++i) {
+		CHECK_EQ(received.events.data[i].time, events[i].time);
+		CHECK_EQ(received.events.data[i].data, events[i].data);
+	}
+}
@@ -0,0 +1,85 @@
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "TMInterface/EventLoop.h"
+#include "Test/Peer.h"
+#include "Test/Test.h"
+
+namespace {
+
+using namespace TMInterface;
+
+constexpr size_t REQUESTS = 200;
+
+Utils::Task<void> requestStates(Interface& interface, size_t id, std::vector<size_t>& answers) {
+	const Packets::C_SIM_GET_STATE getState;
+
+	for (size_t i = 0; i < REQUESTS; ++i) {
+		Packet* packet = co_await interface.request(getState);
+
+		if ((packet == nullptr) || (packet->packetId != Packets::S_RESPONSE_ID)) throw std::runtime_error("No state");
+
+		answers.push_back(id);
+	}
+}
+
+Utils::Task<void> throwAfterRequest(Interface& interface) {
+	co_await interface.request(Packets::C_SIM_GET_STATE{});
+
+	throw std::runtime_error("From the task");
+}
+
+}  // namespace
+
+TEST(EventLoop_multiplexesInterfaces) {
+	Test::Peer first;
+	Test::Peer second;
+	Interface a(first.getName());
+	Interface b(second.getName());
+	std::vector<size_t> answers;
+
+	EventLoop loop;
+	loop.attach(a);
+	loop.attach(b);
+	loop.spawn(requestStates(a, 0, answers));
+	loop.spawn(requestStates(b, 1, answers));
+
+	CHECK_EQ(loop.getTaskCount(), size_t{2});
+
+	loop.run();
+
+	CHECK_EQ(loop.getTaskCount(), size_t{0});
+	CHECK_EQ(answers.size(), 2 * REQUESTS);
+
+	// Both servers worked at the same time, neither task waited for the other one to finish
+	size_t firstDone = 0;
+	size_t secondDone = 0;
+
+	for (size_t i = 0; i < answers.size(); ++i) {
+		if (answers[i] == 0) firstDone = i;
+		if (answers[i] == 1) secondDone = i;
+	}
+
+	CHECK(firstDone > REQUESTS);
+	CHECK(secondDone > REQUESTS);
+}
+
+TEST(EventLoop_rethrowsFromTasks) {
+	Test::Peer peer;
+	Interface interface(peer.getName());
+
+	EventLoop loop;
+	loop.attach(interface);
+	loop.spawn(throwAfterRequest(interface));
+
+	bool thrown = false;
+
+	try {
+		loop.run();
+	} catch (const std::runtime_error&) {
+		thrown = true;
+	}
+
+	CHECK(thrown);
+}
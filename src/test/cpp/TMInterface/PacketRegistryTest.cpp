@@ -0,0 +1,70 @@
+#include <cstdint>
+#include <memory>
+#include <variant>
+
+#include "TMInterface/Packets.h"
+#include "Test/Test.h"
+
+using namespace TMInterface;
+
+namespace {
+
+// Both ways of making a packet give the type registered for id
+template <typename T>
+void checkRoundTrip() {
+	Packets::PacketStorage storage;
+	Packet* emplaced = Packets::Registry::emplace(T::ID, storage);
+
+	CHECK(emplaced != nullptr);
+	CHECK_EQ(emplaced->packetId, T::ID);
+	CHECK(std::holds_alternative<T>(storage));
+	CHECK(emplaced == &std::get<T>(storage));
+
+	const std::unique_ptr<Packet> created = Packets::Registry::create(T::ID);
+
+	CHECK(created != nullptr);
+	CHECK_EQ(created->packetId, T::ID);
+	CHECK(dynamic_cast<T*>(created.get()) != nullptr);
+	CHECK_EQ(created->responsePacketId, emplaced->responsePacketId);
+
+	CHECK(Packets::Registry::isKnown(T::ID));
+}
+
+}  // namespace
+
+TEST(PacketRegistry_mapsIdsToTheirTypes) {
+	using namespace Packets;
+
+	checkRoundTrip<S_RESPONSE>();
+	checkRoundTrip<S_ON_REGISTERED>();
+	checkRoundTrip<S_ON_SIM_STEP>();
+	checkRoundTrip<C_PROCESSED_CALL>();
+	checkRoundTrip<C_SET_INPUT_STATES>();
+	checkRoundTrip<C_SIM_REWIND_TO_STATE>();
+	checkRoundTrip<C_SIM_SET_EVENT_BUFFER>();
+	checkRoundTrip<ANY>();
+	// Declared after ANY, but dispatch goes by id
+	checkRoundTrip<C_SIM_REWIND_TO_TIME>();
+
+	CHECK_EQ(Registry::MAX_ID, C_SIM_REWIND_TO_TIME_ID);
+	CHECK_EQ(S_ON_REGISTERED{}.responsePacketId, C_PROCESSED_CALL_ID);
+}
+
+TEST(PacketRegistry_rejectsUnknownIds) {
+	Packets::PacketStorage storage;
+
+	for (const int32_t id : {-1, 0, Packets::Registry::MAX_ID + 1, 1 << 20}) {
+		CHECK(!Packets::Registry::isKnown(id));
+		CHECK(Packets::Registry::emplace(id, storage) == nullptr);
+		CHECK(Packets::Registry::create(id) == nullptr);
+		CHECK(Packet::getPacketById(id) == nullptr);
+	}
+
+	// Left alone
+	CHECK(std::holds_alternative<std::monostate>(storage));
+
+	// Every id in between is known
+	for (int32_t id = 1; id <= Packets::Registry::MAX_ID; ++id) CHECK(Packets::Registry::isKnown(id));
+
+	static_assert(Packets::Registry::COUNT == static_cast<size_t>(Packets::Registry::MAX_ID));
+}
@@ -0,0 +1,164 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "TMInterface/EventBuffer.h"
+#include "TMInterface/Interface.h"
+#include "TMInterface/PacketTrace.h"
+#include "TMInterface/TraceReplayer.h"
+#include "Test/Peer.h"
+#include "Test/Test.h"
+
+using namespace TMInterface;
+
+namespace {
+
+constexpr size_t STEPS = 20;
+
+// Callbacks can't be removed, so this one stays registered for the other tests and only counts while active
+struct StepCounter {
+	bool active = false;
+	std::vector<uint32_t> times;
+
+	Packets::S_ON_SIM_STEP::responsePacket_t* operator()(Packets::S_ON_SIM_STEP& packet,
+	                                                     Packets::S_ON_SIM_STEP::responsePacket_t* response) {
+		if (active) times.push_back(packet.data.time);
+
+		return response;
+	}
+};
+
+StepCounter& getStepCounter() {
+	static StepCounter counter;
+	static const bool registered = (Packets::S_ON_SIM_STEP::registerCallback(counter), true);
+
+	static_cast<void>(registered);
+
+	return counter;
+}
+
+}  // namespace
+
+TEST(PacketTrace_recordsOnlyWhatWasRead) {
+	Test::Peer peer;
+	Interface client(peer.getName());
+	const std::string path = (std::filesystem::temp_directory_path() / (peer.getName() + ".trace")).string();
+
+	// Much larger than the empty S_RESPONSE it gets, which lands on top of it in the buffer
+	std::vector<InputEvent> events;
+	for (uint32_t time = 0; time < 10'000; time += 10) {
+		events.push_back(InputEvent::make(time, InputType::STEER, static_cast<int32_t>(time)));
+	}
+
+	Packets::C_SIM_SET_EVENT_BUFFER set;
+	set.buffer = EventBufferView{10'000, {events.data(), events.size()}};
+
+	client.startRecording(path);
+	Test::exchange(client, set);
+	Test::exchange(client, set);
+	client.stopRecording();
+
+	std::vector<TraceReader::Record> records;
+
+	{
+		TraceReader reader(path);
+		TraceReader::Record record;
+
+		while (reader.next(record)) records.push_back(record);
+
+		CHECK_EQ(records.size(), size_t{4});
+
+		for (size_t i = 0; i < records.size(); i += 2) {
+			CHECK(records[i].header.direction == TraceDirection::SENT);
+			CHECK_EQ(records[i].header.packetId, Packets::C_SIM_SET_EVENT_BUFFER_ID);
+			CHECK(records[i].header.payloadSize > (events.size() * sizeof(InputEvent)));
+
+			CHECK(records[i + 1].header.direction == TraceDirection::RECEIVED);
+			CHECK_EQ(records[i + 1].header.packetId, Packets::S_RESPONSE_ID);
+			CHECK_EQ(records[i + 1].header.payloadSize, uint32_t{0});
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST(TraceReplayer_replaysRecordedSession) {
+	Test::Peer peer;
+	const std::string path = (std::filesystem::temp_directory_path() / (peer.getName() + ".trace")).string();
+	std::vector<int32_t> received;
+	std::vector<uint32_t> times;
+
+	{
+		Interface client(peer.getName());
+
+		// Notes down every packet the client receives, and the times of the steps
+		auto note = [&received, &times](Packet* packet) {
+			received.push_back(packet->packetId);
+
+			if (packet->packetId == Packets::S_ON_SIM_STEP_ID) {
+				times.push_back(static_cast<Packets::S_ON_SIM_STEP*>(packet)->data.time);
+			}
+
+			return packet;
+		};
+
+		client.startRecording(path);
+
+		// Acknowledged by the default callback, the server starts simulating right after
+		note(Test::exchange(client, Packets::C_REGISTER{}));
+
+		Packets::C_PROCESSED_CALL processed;
+
+		while (times.size() < STEPS) {
+			processed.which = note(Test::waitAndReceive(client))->packetId;
+			client.sendPacket(processed);
+		}
+
+		// The server only takes client calls while it waits for an answer to one of its calls
+		note(Test::waitAndReceive(client));
+		note(Test::exchange(client, Packets::C_DEREGISTER{}));
+
+		client.stopRecording();
+	}
+
+	CHECK(times.size() >= STEPS);
+	CHECK(times.back() > times.front());
+
+	{
+		StepCounter& counter = getStepCounter();
+		TraceReplayer replayer(path, peer.getName() + "Replay");
+
+		CHECK(replayer);
+
+		counter.active = true;
+		counter.times.clear();
+
+		// Every received packet comes back, and the callback gets the steps with the times the server sent
+		const size_t replayed = replayer.replay();
+
+		CHECK_EQ(replayed, received.size());
+		CHECK_EQ(replayer.getReplayedCount(), received.size());
+		CHECK(counter.times == times);
+
+		// Packet by packet, in the recorded order
+		replayer.rewind();
+
+		for (const int32_t packetId : received) {
+			CHECK(replayer.loadNext());
+
+			const Packet* packet = replayer.receivePacket();
+
+			CHECK(packet != nullptr);
+			CHECK_EQ(packet->packetId, packetId);
+		}
+
+		CHECK(!replayer.loadNext());
+		CHECK_EQ(counter.times.size(), 2 * times.size());
+
+		counter.active = false;
+	}
+
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,159 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "TMInterface/Utils/BufferCursor.h"
+#include "Test/Test.h"
+
+using TMInterface::Utils::BufferCursor;
+
+namespace {
+
+constexpr size_t SIZE = 256;
+constexpr char GARBAGE = 0x55;
+
+using Cursor = BufferCursor<SIZE>;
+
+// Stands in for the shared buffer, with everything the cursor never touched recognizable
+struct Buffer {
+	std::array<char, SIZE> bytes;
+
+	Buffer() {
+		bytes.fill(GARBAGE);
+	}
+
+	size_t count(char value, size_t begin = 0, size_t end = SIZE) const {
+		size_t result = 0;
+
+		for (size_t i = begin; i < end; ++i) {
+			if (bytes[i] == value) ++result;
+		}
+
+		return result;
+	}
+};
+
+template <typename Function>
+bool throwsOutOfRange(Function&& function) {
+	try {
+		function();
+	} catch (const std::out_of_range&) {
+		return true;
+	}
+
+	return false;
+}
+
+}  // namespace
+
+TEST(BufferCursor_rejectsOverruns) {
+	Buffer buffer;
+	Cursor cursor(buffer.bytes.data());
+
+	cursor.seek(SIZE - 2);
+
+	int32_t value = 7;
+
+	CHECK(throwsOutOfRange([&cursor, &value]() { cursor.writeObj(value); }));
+	CHECK(throwsOutOfRange([&cursor, &value]() { cursor.readObj(value); }));
+	CHECK(throwsOutOfRange([&cursor]() { cursor.view(3); }));
+	CHECK(throwsOutOfRange([&cursor]() { cursor.skip(3); }));
+	CHECK(throwsOutOfRange([&cursor]() { cursor.seek(SIZE + 1); }));
+	// Close to SIZE_MAX, so position + size would wrap around
+	CHECK(throwsOutOfRange([&cursor]() { cursor.view(~size_t{0}); }));
+
+	// Nothing moved or was written
+	CHECK_EQ(cursor.getOffset(), SIZE - 2);
+	CHECK_EQ(cursor.getDirtySize(), size_t{0});
+	CHECK_EQ(buffer.count(GARBAGE), SIZE);
+
+	// Right up to the end is fine
+	int16_t last = 3;
+	cursor.writeObj(last);
+
+	CHECK_EQ(cursor.getOffset(), SIZE);
+	CHECK_EQ(cursor.getHighWater(), SIZE);
+}
+
+TEST(BufferCursor_zeroesOnlyWhatWasTouched) {
+	Buffer buffer;
+	Cursor cursor(buffer.bytes.data());
+
+	// A send: header, a gap left alone, then the payload
+	const int64_t header = -1;
+	cursor.writeObj(header);
+	cursor.skip(24);
+	cursor.writeObj(header);
+
+	CHECK_EQ(cursor.getOffset(), size_t{40});
+	CHECK_EQ(cursor.getHighWater(), size_t{40});
+	CHECK_EQ(cursor.getDirtySize(), size_t{16});
+
+	// The answer is read from the start, the high water mark starts over but what was written stays dirty. Reading it
+	// back doesn't count it twice
+	cursor.rewind();
+
+	int32_t id = 0;
+	cursor.readObj(id);
+
+	CHECK_EQ(id, -1);
+	CHECK_EQ(cursor.getHighWater(), sizeof(id));
+	CHECK_EQ(cursor.getDirtySize(), size_t{16});
+
+	// Written at a fixed position past everything else
+	cursor.writeAt<100>(header);
+
+	CHECK_EQ(cursor.getHighWater(), size_t{108});
+	CHECK_EQ(cursor.getDirtySize(), size_t{24});
+
+	// Like the start of the next send
+	cursor.zero();
+
+	CHECK_EQ(cursor.getOffset(), size_t{0});
+	CHECK_EQ(cursor.getHighWater(), size_t{0});
+	CHECK_EQ(cursor.getDirtySize(), size_t{0});
+
+	CHECK_EQ(buffer.count(0, 0, 8), size_t{8});
+	CHECK_EQ(buffer.count(GARBAGE, 8, 32), size_t{24});
+	CHECK_EQ(buffer.count(0, 32, 40), size_t{8});
+	CHECK_EQ(buffer.count(GARBAGE, 40, 100), size_t{60});
+	CHECK_EQ(buffer.count(0, 100, 108), size_t{8});
+	CHECK_EQ(buffer.count(GARBAGE, 108, SIZE), SIZE - 108);
+
+	cursor.zeroAll();
+
+	CHECK_EQ(buffer.count(0), SIZE);
+}
+
+TEST(BufferCursor_mergesSpansPastTheLimit) {
+	Buffer buffer;
+	Cursor cursor(buffer.bytes.data());
+
+	const char byte = 1;
+
+	// Every other byte, so no two writes are next to each other
+	for (size_t i = 0; i < Cursor::MAX_SPANS; ++i) {
+		cursor.writeObj(byte);
+		cursor.skip(1);
+	}
+
+	CHECK_EQ(cursor.getDirtySize(), size_t{Cursor::MAX_SPANS});
+
+	// Out of spans, the last one grows over the gaps up to the new write
+	constexpr size_t LAST = (2 * Cursor::MAX_SPANS) + 10;
+
+	cursor.seek(LAST);
+	cursor.writeObj(byte);
+
+	constexpr size_t MERGED = (Cursor::MAX_SPANS - 1) + (LAST + 1 - (2 * (Cursor::MAX_SPANS - 1)));
+
+	CHECK_EQ(cursor.getDirtySize(), MERGED);
+
+	cursor.zero();
+
+	// Clears a bit too much, but never misses a write
+	CHECK_EQ(buffer.count(byte), size_t{0});
+	CHECK_EQ(buffer.count(0, 0, LAST + 1), MERGED);
+	CHECK_EQ(buffer.count(GARBAGE, LAST + 1, SIZE), SIZE - (LAST + 1));
+}
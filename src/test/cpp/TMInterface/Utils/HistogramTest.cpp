@@ -0,0 +1,95 @@
+#include <cstdint>
+#include <limits>
+
+#include "TMInterface/Utils/Histogram.h"
+#include "Test/Test.h"
+
+using TMInterface::Utils::Histogram;
+
+namespace {
+
+// Highest value of the bucket value goes into. The second value is large enough to be in another bucket, and keeps the
+// result from being clamped to the maximum
+uint64_t getBucketEnd(uint64_t value) {
+	Histogram histogram;
+	histogram.record(value);
+	histogram.record(Histogram::MAX_VALUE);
+
+	return histogram.getPercentile(50.0);
+}
+
+}  // namespace
+
+TEST(Histogram_recordsSmallValuesExactly) {
+	for (uint64_t value = 0; value < (2 * Histogram::SUB_BUCKETS); ++value) {
+		CHECK_EQ(getBucketEnd(value), value);
+	}
+}
+
+TEST(Histogram_splitsPowersOfTwoIntoSubBuckets) {
+	// From 64 on two values share a bucket, from 128 on four
+	CHECK_EQ(getBucketEnd(64), uint64_t{65});
+	CHECK_EQ(getBucketEnd(65), uint64_t{65});
+	CHECK_EQ(getBucketEnd(66), uint64_t{67});
+	CHECK_EQ(getBucketEnd(127), uint64_t{127});
+	CHECK_EQ(getBucketEnd(128), uint64_t{131});
+	CHECK_EQ(getBucketEnd(132), uint64_t{135});
+
+	for (uint64_t value = 1; value < (uint64_t{1} << 34); value = (value * 3) + 1) {
+		const uint64_t end = getBucketEnd(value);
+
+		// Every bucket ends right before the next one starts, and is at most 1/32 of its values wide
+		CHECK_LE(value, end);
+		CHECK_LE(end - value, value >> Histogram::SUB_BITS);
+		CHECK_EQ(getBucketEnd(end), end);
+		CHECK(getBucketEnd(end + 1) > end);
+	}
+}
+
+TEST(Histogram_clampsLargeValues) {
+	Histogram histogram;
+	histogram.record(Histogram::MAX_VALUE + 1000);
+	histogram.record(std::numeric_limits<uint64_t>::max());
+
+	CHECK_EQ(histogram.getCount(), uint64_t{2});
+	CHECK_EQ(histogram.getPercentile(0.0), Histogram::MAX_VALUE);
+	CHECK_EQ(histogram.getPercentile(100.0), Histogram::MAX_VALUE);
+	CHECK_EQ(getBucketEnd(Histogram::MAX_VALUE), Histogram::MAX_VALUE);
+}
+
+TEST(Histogram_reportsPercentiles) {
+	Histogram low;
+	Histogram high;
+
+	// 1 to 10000, split in two to merge
+	for (uint64_t value = 1; value <= 10000; ++value) {
+		((value <= 5000) ? low : high).record(value);
+	}
+
+	Histogram all;
+	all.merge(low);
+	all.merge(high);
+
+	CHECK_EQ(all.getCount(), uint64_t{10000});
+	CHECK_EQ(all.getMin(), uint64_t{1});
+	CHECK_EQ(all.getMax(), uint64_t{10000});
+	CHECK_EQ(all.getMean(), 5000.5);
+
+	// Within the width of a bucket above the exact value
+	const uint64_t p50 = all.getPercentile(50.0);
+	const uint64_t p99 = all.getPercentile(99.0);
+
+	CHECK_LE(uint64_t{5000}, p50);
+	CHECK_LE(p50, uint64_t{5000 + (5000 >> Histogram::SUB_BITS)});
+	CHECK_LE(uint64_t{9900}, p99);
+	CHECK_LE(p99, uint64_t{9900 + (9900 >> Histogram::SUB_BITS)});
+
+	// The ends are exact
+	CHECK_EQ(all.getPercentile(0.0), uint64_t{1});
+	CHECK_EQ(all.getPercentile(100.0), uint64_t{10000});
+
+	all.reset();
+
+	CHECK_EQ(all.getCount(), uint64_t{0});
+	CHECK_EQ(all.getPercentile(50.0), uint64_t{0});
+}
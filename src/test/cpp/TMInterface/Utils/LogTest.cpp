@@ -0,0 +1,71 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TMInterface/Utils/Log.h"
+#include "Test/Test.h"
+
+using namespace TMInterface::Utils;
+
+TEST(Logger_flushesManyThreads) {
+	constexpr size_t THREADS = 16;
+	// Less than a ring holds, so nothing is dropped even if the background thread doesn't get to run
+	constexpr uint32_t MESSAGES = 1'000;
+
+	Logger& logger = Logger::getInstance();
+	std::ostringstream output;
+
+	logger.flush();
+	logger.setOutput(output);
+
+	const size_t ringCount = logger.getRingCount();
+	const uint64_t dropped = logger.getDropped();
+
+	for (size_t round = 0; round < 3; ++round) {
+		std::vector<std::thread> threads;
+
+		for (size_t i = 0; i < THREADS; ++i) {
+			threads.emplace_back([i] {
+				for (uint32_t message = 0; message < MESSAGES; ++message) {
+					log<LogLevel::WARNING>("thread ", i, " message ", message);
+				}
+			});
+		}
+
+		for (std::thread& thread : threads) thread.join();
+
+		logger.flush();
+
+		// The rings of the exited threads were written out and freed
+		CHECK_EQ(logger.getRingCount(), ringCount);
+	}
+
+	logger.setOutput(std::cout);
+
+	CHECK_EQ(logger.getDropped(), dropped);
+
+	// Every message once, and in order within its thread
+	std::vector<uint32_t> next(THREADS, 0);
+	std::istringstream lines(output.str());
+	std::string line;
+	size_t count = 0;
+
+	while (std::getline(lines, line)) {
+		size_t thread;
+		uint32_t message;
+
+		CHECK(std::sscanf(line.c_str(), "[WARNING] thread %zu message %u", &thread, &message) == 2);
+		CHECK(thread < THREADS);
+		CHECK_EQ(message, next[thread] % MESSAGES);
+
+		++next[thread];
+		++count;
+	}
+
+	CHECK_EQ(count, 3 * THREADS * MESSAGES);
+}
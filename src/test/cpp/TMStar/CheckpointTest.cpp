@@ -0,0 +1,113 @@
+#include <stdexcept>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/Engine.h"
+#include "Test/GridSimulator.h"
+#include "Test/TemporaryDirectory.h"
+#include "Test/Test.h"
+
+using namespace TMStar;
+
+using GridEngine = Engine<Test::GridSimulator>;
+
+TEST(Engine_resumesFromCheckpoint) {
+	Test::TemporaryDirectory directory("TMStarCheckpoint");
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+
+	SearchSettings settings;
+	settings.transpositionBytes = 1 << 16;
+
+	Test::GridSimulator uninterrupted;
+	const GridEngine::Result expected = GridEngine(uninterrupted, settings).run(start.view());
+
+	CHECK(expected.found);
+
+	settings.checkpoint.directory = directory.path.string();
+	settings.checkpoint.interval = 100;
+
+	// Stops like after a crash, some way past its last snapshot
+	settings.maxExpansions = 1234;
+
+	{
+		Test::GridSimulator simulator;
+		const GridEngine::Result stopped = GridEngine(simulator, settings).run(start.view());
+
+		CHECK(!stopped.found);
+		// The later ones are skipped while the last one is still being written
+		CHECK(stopped.statistics.checkpoints > 0);
+	}
+
+	settings.maxExpansions = 0;
+
+	Test::GridSimulator simulator;
+	const GridEngine::Result resumed = GridEngine(simulator, settings).resume();
+
+	CHECK(resumed.found);
+	CHECK_EQ(resumed.cost, expected.cost);
+	CHECK(resumed.actions == expected.actions);
+	// Carried on where the snapshot left off, as if there had been no crash
+	CHECK_EQ(resumed.statistics.expansions, expected.statistics.expansions);
+	CHECK(simulator.getSimulations() < uninterrupted.getSimulations());
+}
+
+TEST(Engine_resumesMoreThanOnce) {
+	Test::TemporaryDirectory directory("TMStarCheckpoint");
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+
+	SearchSettings settings;
+	settings.transpositionBytes = 1 << 16;
+
+	Test::GridSimulator uninterrupted;
+	const GridEngine::Result expected = GridEngine(uninterrupted, settings).run(start.view());
+
+	CHECK(expected.statistics.expansions > 1600);
+
+	settings.checkpoint.directory = directory.path.string();
+	settings.checkpoint.interval = 100;
+	settings.maxExpansions = 800;
+
+	{
+		Test::GridSimulator simulator;
+		GridEngine(simulator, settings).run(start.view());
+	}
+
+	// Snapshots after a resume go on from the mapped one, and the search changes the mapped records and table
+	// without changing the files under it
+	settings.maxExpansions = 1600;
+
+	{
+		Test::GridSimulator simulator;
+		const GridEngine::Result stopped = GridEngine(simulator, settings).resume();
+
+		CHECK(!stopped.found);
+		CHECK_EQ(stopped.statistics.expansions, uint64_t{1600});
+	}
+
+	settings.maxExpansions = 0;
+
+	Test::GridSimulator simulator;
+	const GridEngine::Result resumed = GridEngine(simulator, settings).resume();
+
+	CHECK(resumed.found);
+	CHECK_EQ(resumed.cost, expected.cost);
+	CHECK(resumed.actions == expected.actions);
+	CHECK_EQ(resumed.statistics.expansions, expected.statistics.expansions);
+}
+
+TEST(Engine_resumeNeedsCheckpoint) {
+	Test::TemporaryDirectory directory("TMStarCheckpoint");
+
+	SearchSettings settings;
+	settings.checkpoint.directory = directory.path.string();
+
+	Test::GridSimulator simulator;
+	bool thrown = false;
+
+	try {
+		GridEngine(simulator, settings).resume();
+	} catch (const std::runtime_error&) {
+		thrown = true;
+	}
+
+	CHECK(thrown);
+}
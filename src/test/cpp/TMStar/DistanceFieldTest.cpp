@@ -0,0 +1,160 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "TMStar/DistanceField.h"
+#include "Test/TemporaryDirectory.h"
+#include "Test/Test.h"
+
+namespace {
+
+using TMInterface::Vec3;
+using namespace TMStar;
+
+constexpr float CELL_SIZE = 2.0f;
+constexpr float RADIUS = 4.0f;
+
+// Open box with a checkpoint halfway and the finish at x = 100, all on the line z = 10
+TrackDescription makeStraight() {
+	TrackDescription track;
+	track.checkpoints = {{50.0f, 1.0f, 10.0f}, {100.0f, 1.0f, 10.0f}};
+	track.checkpointRadius = RADIUS;
+	track.bounds = {{0.0f, 0.0f, 0.0f}, {120.0f, 4.0f, 20.0f}};
+
+	return track;
+}
+
+// L shaped: along x from 0 to 100, then along z up to the finish at z = 95
+TrackDescription makeCorner() {
+	TrackDescription track;
+	track.checkpoints = {{90.0f, 1.0f, 95.0f}};
+	track.checkpointRadius = RADIUS;
+	track.bounds = {{0.0f, 0.0f, 0.0f}, {100.0f, 4.0f, 100.0f}};
+	track.drivable = {{{0.0f, 0.0f, 0.0f}, {100.0f, 4.0f, 20.0f}}, {{80.0f, 0.0f, 0.0f}, {100.0f, 4.0f, 100.0f}}};
+
+	return track;
+}
+
+float getLength(float x, float z) {
+	return std::sqrt((x * x) + (z * z));
+}
+
+}  // namespace
+
+TEST(DistanceField_isAdmissibleOnAStraight) {
+	Test::TemporaryDirectory directory("TMStarDistanceField");
+	const DistanceField field(makeStraight(), directory.path.string(), {CELL_SIZE, 2});
+
+	CHECK_EQ(field.getLayerCount(), uint32_t{2});
+
+	// On the line the shortest path goes straight to the edge of the finish, through the checkpoint
+	for (float x = 0.5f; x < 96.0f; x += 1.0f) {
+		const float exact = 100.0f - RADIUS - x;
+		const Vec3 position{x, 1.0f, 10.0f};
+
+		// Before the checkpoint there are two layers to go, past it only the last one. The way through the checkpoint
+		// isn't known, so its diameter is left out on top of the rounding to cells
+		if (x < 46.0f) {
+			CHECK_LE(field.getDistance(position, 0), exact);
+			CHECK(field.getDistance(position, 0) >= (exact - (2.0f * RADIUS) - (3.0f * CELL_SIZE)));
+		}
+
+		CHECK_LE(field.getDistance(position, 1), exact);
+		CHECK(field.getDistance(position, 1) >= (exact - (3.0f * CELL_SIZE)));
+	}
+
+	// Off the line only the finish is left to take, which is a straight line in the open box
+	for (float x = 0.5f; x < 90.0f; x += 3.0f) {
+		for (float z = 0.5f; z < 20.0f; z += 3.0f) {
+			const float exact = getLength(100.0f - x, 10.0f - z) - RADIUS;
+
+			CHECK_LE(field.getDistance({x, 3.0f, z}, 1), exact);
+		}
+	}
+
+	// Outside of the grid only the distance between the checkpoints is known
+	CHECK_LE(field.getDistance({-50.0f, 1.0f, 10.0f}, 0), 100.0f - RADIUS - 50.0f);
+	CHECK_EQ(field.getDistance({50.0f, 1.0f, 10.0f}, 2), 0.0f);
+}
+
+TEST(DistanceField_goesAroundWalls) {
+	Test::TemporaryDirectory directory("TMStarDistanceField");
+	const DistanceField field(makeCorner(), directory.path.string(), {CELL_SIZE, 2});
+
+	for (float x = 1.0f; x < 80.0f; x += 4.0f) {
+		for (float z = 1.0f; z < 20.0f; z += 4.0f) {
+			// Around the inner corner at (80, 20), then straight to the finish
+			const float exact = getLength(80.0f - x, 20.0f - z) + getLength(10.0f, 75.0f) - RADIUS;
+			const float straight = getLength(90.0f - x, 95.0f - z) - RADIUS;
+			const float distance = field.getDistance({x, 1.0f, z}, 0);
+
+			CHECK_LE(distance, exact);
+			// Knows about the wall
+			if (x < 40.0f) CHECK(distance > straight);
+		}
+	}
+
+	// The heuristic is the distance at top speed, in milliseconds
+	const DistanceHeuristic heuristic{&field, 20.0f};
+	TMInterface::SimState state;
+	state.cpStates.assign(1, 0);
+
+	const Vec3 position{10.0f, 1.0f, 10.0f};
+	std::memcpy(state.data.state2.data() + TMInterface::SimStateView::POSITION_OFFSET, &position, sizeof(position));
+
+	CHECK_EQ(heuristic(state.view()),
+	         static_cast<uint32_t>((field.getDistance(position, 0) * 1000.0f) / heuristic.maxSpeed));
+}
+
+TEST(DistanceField_reusesTheCache) {
+	Test::TemporaryDirectory directory("TMStarDistanceField");
+	const TrackDescription track = makeStraight();
+
+	const DistanceField built(track, directory.path.string(), {CELL_SIZE, 2});
+	const std::filesystem::file_time_type written = std::filesystem::last_write_time(built.getPath());
+
+	const DistanceField mapped(track, directory.path.string(), {CELL_SIZE, 2});
+
+	CHECK_EQ(mapped.getPath(), built.getPath());
+	CHECK(std::filesystem::last_write_time(mapped.getPath()) == written);
+	CHECK_EQ(mapped.getDistance({10.0f, 1.0f, 10.0f}, 0), built.getDistance({10.0f, 1.0f, 10.0f}, 0));
+
+	// Another resolution is another file
+	const DistanceField coarse(track, directory.path.string(), {2.0f * CELL_SIZE, 2});
+
+	CHECK(coarse.getPath() != built.getPath());
+}
+
+TEST(TrackDescription_loadsFiles) {
+	Test::TemporaryDirectory directory("TMStarTrack");
+	const std::string path = (directory.path / "straight.track").string();
+
+	{
+		std::ofstream file(path);
+		file << "# Same as makeStraight\n"
+		     << "radius 4\n"
+		     << "bounds 0 0 0  120 4 20\n"
+		     << "checkpoint 50 1 10\n"
+		     << "checkpoint 100 1 10  # finish\n";
+	}
+
+	CHECK_EQ(TrackDescription::load(path).hash(), makeStraight().hash());
+
+	{
+		std::ofstream file(path);
+		file << "radius 4\nbounds 0 0 0 120 4\ncheckpoint 50 1 10\n";
+	}
+
+	bool thrown = false;
+
+	try {
+		TrackDescription::load(path);
+	} catch (const std::runtime_error&) {
+		thrown = true;
+	}
+
+	CHECK(thrown);
+}
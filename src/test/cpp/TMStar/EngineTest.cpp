@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/Engine.h"
+#include "Test/GridSimulator.h"
+#include "Test/Test.h"
+
+using namespace TMStar;
+
+using GridEngine = Engine<Test::GridSimulator>;
+
+namespace {
+
+double getRewindsPerExpansion(const SearchStatistics& statistics) {
+	return static_cast<double>(statistics.rewinds) / static_cast<double>(statistics.expansions);
+}
+
+struct SortingEngine : public GridEngine {
+	using GridEngine::GridEngine;
+	using GridEngine::sortByTree;
+};
+
+}  // namespace
+
+TEST(Engine_batchesExpansionsWithinEpsilon) {
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+
+	SearchSettings settings;
+	settings.transpositionBytes = 1 << 16;
+	settings.batchSize = 1;
+
+	Test::GridSimulator optimal;
+	const GridEngine::Result optimum = GridEngine(optimal, settings).run(start.view());
+
+	CHECK(optimum.found);
+
+	// One expansion per batch, with the same bound
+	settings.batchEpsilon = 20;
+
+	Test::GridSimulator single;
+	const GridEngine::Result unbatched = GridEngine(single, settings).run(start.view());
+
+	CHECK(unbatched.found);
+	CHECK_LE(unbatched.cost, optimum.cost + settings.batchEpsilon);
+	CHECK_EQ(unbatched.statistics.batches, unbatched.statistics.expansions);
+
+	settings.batchSize = 32;
+
+	Test::GridSimulator simulator;
+	const GridEngine::Result batched = GridEngine(simulator, settings).run(start.view());
+
+	CHECK(batched.found);
+	CHECK_LE(batched.cost, optimum.cost + settings.batchEpsilon);
+	CHECK_EQ(Test::GridSimulator::replay(batched.actions), batched.cost);
+	CHECK(batched.statistics.batches < batched.statistics.expansions);
+	// Expanding in tree order mostly carries on from the child the simulator is at
+	CHECK_OP(getRewindsPerExpansion(batched.statistics), <, getRewindsPerExpansion(unbatched.statistics));
+}
+
+TEST(Engine_sortsBatchesInTreeOrder) {
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+
+	SearchSettings settings;
+	settings.transpositionBytes = 1 << 16;
+
+	Test::GridSimulator simulator;
+	SortingEngine engine(simulator, settings);
+
+	CHECK(engine.run(start.view()).found);
+
+	const NodeArena& nodes = engine.getNodes();
+
+	// Batches of nodes from all over the tree, the root included. Paths from the root in lexicographic order are the
+	// order a depth first search visits them in
+	for (NodeArena::Index stride = 1; stride < 64; stride += 7) {
+		std::vector<NodeArena::Index> batch;
+
+		for (NodeArena::Index node = 0; (node < nodes.size()) && (batch.size() < 32); node += stride) {
+			batch.push_back(node);
+		}
+
+		std::vector<std::pair<std::vector<NodeArena::Action>, NodeArena::Index>> paths;
+
+		for (NodeArena::Index node : batch) paths.emplace_back(nodes.getPath(node), node);
+
+		std::sort(paths.begin(), paths.end());
+		std::reverse(batch.begin(), batch.end());
+		engine.sortByTree(batch);
+
+		for (size_t i = 0; i < batch.size(); ++i) CHECK_EQ(batch[i], paths[i].second);
+	}
+}
@@ -0,0 +1,63 @@
+#include <filesystem>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/Engine.h"
+#include "Test/GridSimulator.h"
+#include "Test/TemporaryDirectory.h"
+#include "Test/Test.h"
+
+using namespace TMStar;
+
+using GridEngine = Engine<Test::GridSimulator>;
+
+namespace {
+
+size_t countRuns(const std::filesystem::path& directory) {
+	size_t runs = 0;
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory)) {
+		if (entry.path().extension() == ".run") ++runs;
+	}
+
+	return runs;
+}
+
+}  // namespace
+
+TEST(Engine_spillsOpenListToDisk) {
+	Test::TemporaryDirectory directory("TMStarSpill");
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+
+	SearchSettings settings;
+	settings.transpositionBytes = 1 << 16;
+
+	Test::GridSimulator inMemory;
+	const GridEngine::Result expected = GridEngine(inMemory, settings).run(start.view());
+
+	CHECK(expected.found);
+
+	settings.spill.directory = directory.path.string();
+	// Far less than the states of the search take up, so most buckets go to disk
+	settings.spill.memoryBytes = 64 << 10;
+	settings.spill.bucketWidth = 10;
+	settings.spill.minRunEntries = 16;
+
+	{
+		Test::GridSimulator simulator;
+		const GridEngine::Result spilled = GridEngine(simulator, settings).run(start.view());
+
+		CHECK(spilled.found);
+		CHECK_EQ(spilled.cost, expected.cost);
+		CHECK(spilled.actions == expected.actions);
+
+		const ExternalOpenList::Statistics& statistics = spilled.statistics.spill;
+
+		CHECK(statistics.spilledEntries > 0);
+		CHECK(statistics.runs > 0);
+		// Some buckets were read in the background while the ones before them were expanded
+		CHECK(statistics.prefetchedRuns > 0);
+	}
+
+	// The runs left over when the goal was found go with the engine
+	CHECK_EQ(countRuns(directory.path), size_t{0});
+}
@@ -0,0 +1,163 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Emulator/CarModel.h"
+#include "TMInterface/Interface.h"
+#include "TMStar/Engine.h"
+#include "TMStar/IdaEngine.h"
+#include "TMStar/InterfaceSimulator.h"
+#include "TMStar/SmaEngine.h"
+#include "Test/Peer.h"
+#include "Test/Test.h"
+
+namespace {
+
+using namespace TMStar;
+
+constexpr uint32_t TICKS_PER_ACTION = 30;
+// Deepest path the brute force tries. The optimum takes 6 actions
+constexpr size_t MAX_DEPTH = 7;
+
+// The finish is off to the left, close enough to keep uniform cost search short. Going straight misses it, the
+// optimum steers left twice
+Emulator::Track makeTrack() {
+	return Emulator::Track{{0.0f, 9.0f, 0.0f}, 0.0f, {{-9.0f, 9.0f, 18.0f}}, 3.0f};
+}
+
+std::vector<InputAction> makeActions() {
+	return {{true, false, 0}, {true, false, -65536}, {true, false, 65536}};
+}
+
+// Replays the actions on the car model the way the emulator runs them. Returns the race time it took to finish, or 0
+// if the actions didn't get there
+uint32_t replay(const Emulator::CarModel& model, const TMInterface::SimState& start,
+                const std::vector<InputAction>& actions) {
+	TMInterface::SimState state = start;
+
+	for (const InputAction& action : actions) {
+		state.data.inputAccelerateState = action.accelerate ? 1 : 0;
+		state.data.inputBrakeState = action.brake ? 1 : 0;
+		state.data.inputSteerState = action.steer;
+
+		for (uint32_t tick = 0; tick < TICKS_PER_ACTION; ++tick) {
+			model.step(state);
+
+			if (model.getCheckpointCount(state) == model.getCheckpointTarget()) {
+				return Emulator::CarModel::getTime(state) - Emulator::CarModel::getTime(start);
+			}
+		}
+	}
+
+	return 0;
+}
+
+// Fastest finish over every sequence of MAX_DEPTH actions, without any search
+uint32_t bruteForce(const Emulator::CarModel& model, const TMInterface::SimState& start) {
+	const std::vector<InputAction> actions = makeActions();
+	std::vector<size_t> indices(MAX_DEPTH, 0);
+	std::vector<InputAction> sequence(MAX_DEPTH);
+	uint32_t best = 0;
+
+	while (true) {
+		for (size_t i = 0; i < MAX_DEPTH; ++i) sequence[i] = actions[indices[i]];
+
+		const uint32_t time = replay(model, start, sequence);
+		if ((time != 0) && ((best == 0) || (time < best))) best = time;
+
+		// Next sequence, counting in base actions.size()
+		size_t i = 0;
+		for (; (i < MAX_DEPTH) && (++indices[i] == actions.size()); ++i) indices[i] = 0;
+
+		if (i == MAX_DEPTH) return best;
+	}
+}
+
+// Emulator with the track, and a client registered with it
+struct Race {
+	const Emulator::CarModel model;
+	Test::Peer peer;
+	TMInterface::Interface client;
+	InterfaceSimulator simulator;
+	const TMInterface::SimState start;
+
+	Race()
+	    : model(makeTrack()),
+	      peer({}, model),
+	      client(peer.getName()),
+	      simulator(registered(client), makeActions(), InterfaceSimulatorSettings{TICKS_PER_ACTION}),
+	      start(simulator.getState()) {}
+
+	static TMInterface::Interface& registered(TMInterface::Interface& client) {
+		// Acknowledged by the default callback
+		CHECK_EQ(Test::exchange(client, TMInterface::Packets::C_REGISTER{})->packetId,
+		         TMInterface::Packets::S_ON_REGISTERED_ID);
+
+		return client;
+	}
+
+	// Cost of the optimal path, checked against uniform cost search with Engine
+	uint32_t getOptimum() {
+		const uint32_t optimum = bruteForce(model, start);
+		CHECK(optimum != 0);
+
+		Engine<InterfaceSimulator> engine(simulator);
+		const Engine<InterfaceSimulator>::Result result = engine.run(start.view());
+
+		CHECK(result.found);
+		CHECK_EQ(result.cost, optimum);
+
+		return optimum;
+	}
+};
+
+SearchSettings makeSettings() {
+	SearchSettings settings;
+	settings.maxExpansions = 20'000;
+	settings.reserveNodes = 64;
+
+	return settings;
+}
+
+}  // namespace
+
+TEST(SmaEngine_findsOptimalPathOnEmulator) {
+	Race race;
+	const uint32_t optimum = race.getOptimum();
+
+	// Far less than the few hundred nodes uniform cost search keeps, but enough for the optimal path
+	SearchSettings settings = makeSettings();
+	settings.memoryBudget = 16 << 10;
+
+	SmaEngine<InterfaceSimulator> engine(race.simulator, settings);
+	const SmaEngine<InterfaceSimulator>::Result result = engine.run(race.start.view());
+
+	CHECK(result.found);
+	CHECK_EQ(result.cost, optimum);
+	CHECK_EQ(replay(race.model, race.start, result.actions), optimum);
+	CHECK(result.statistics.evictions > 0);
+	CHECK_LE(result.statistics.peakBytes, settings.memoryBudget);
+}
+
+TEST(IdaEngine_findsOptimalPathOnEmulator) {
+	Race race;
+	const uint32_t optimum = race.getOptimum();
+
+	const RewindStatistics before = race.simulator.getRewindStatistics();
+
+	IdaEngine<InterfaceSimulator> engine(race.simulator, makeSettings());
+	const IdaEngine<InterfaceSimulator>::Result result = engine.run(race.start.view());
+
+	const RewindStatistics& after = race.simulator.getRewindStatistics();
+
+	CHECK(result.found);
+	CHECK_EQ(result.cost, optimum);
+	CHECK_EQ(replay(race.model, race.start, result.actions), optimum);
+	// Without a heuristic, every pass raises the threshold by the time of one action
+	CHECK(result.statistics.iterations > 1);
+	// Backtracking only ever goes to states on the trajectory the server saved. Only getting to the start may need the
+	// whole state, after the uniform cost search left the server somewhere else
+	CHECK(after.timeRewinds > before.timeRewinds);
+	CHECK_EQ(after.rejected, uint64_t{0});
+	CHECK_LE(after.stateRewinds - before.stateRewinds, uint64_t{1});
+}
@@ -0,0 +1,52 @@
+#include <cstddef>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/Engine.h"
+#include "TMStar/ParallelEngine.h"
+#include "Test/GridSimulator.h"
+#include "Test/Test.h"
+
+using namespace TMStar;
+
+TEST(ParallelEngine_findsOptimalPathWithAnyWorkerCount) {
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+
+	SearchSettings settings;
+	settings.transpositionBytes = 1 << 16;
+
+	Test::GridSimulator single;
+	const Engine<Test::GridSimulator>::Result expected = Engine<Test::GridSimulator>(single, settings).run(start.view());
+
+	CHECK(expected.found);
+
+	for (const size_t workers : {1, 2, 4}) {
+		std::vector<Test::GridSimulator> simulators(workers);
+		std::vector<Test::GridSimulator*> pointers;
+
+		for (Test::GridSimulator& simulator : simulators) pointers.push_back(&simulator);
+
+		ParallelEngine<Test::GridSimulator> engine(pointers, settings);
+
+		// Only returns once every worker saw the others idle with nothing in flight
+		const ParallelEngine<Test::GridSimulator>::Result result = engine.run(start.view());
+
+		CHECK(result.found);
+		CHECK_EQ(result.cost, expected.cost);
+		// Ties may be broken differently, but the path has to be real
+		CHECK_EQ(Test::GridSimulator::replay(result.actions), result.cost);
+		CHECK(result.statistics.expansions > 0);
+
+		const ParallelSearchStatistics statistics = engine.getStatistics();
+
+		CHECK_EQ(statistics.workers, workers);
+		// Children went to the other workers, and every one of them expanded some
+		if (workers > 1) CHECK(statistics.messages > 0);
+
+		// Grid cells reached on different paths hash the same, whoever sent them. The workers split the table budget
+		CHECK(statistics.transpositions > 0);
+		CHECK_LE(statistics.tableBytes, settings.transpositionBytes);
+
+		for (const Test::GridSimulator& simulator : simulators) CHECK(simulator.getSimulations() > 0);
+	}
+}
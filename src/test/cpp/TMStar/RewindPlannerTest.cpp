@@ -0,0 +1,122 @@
+#include <cstdint>
+#include <cstring>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/RewindPlanner.h"
+#include "Test/Test.h"
+
+using namespace TMStar;
+
+namespace {
+
+// Step times run this far ahead of race times, like on the server
+constexpr uint32_t OFFSET = 10;
+
+TMInterface::SimState makeState(int32_t raceTime, uint8_t variant = 0) {
+	TMInterface::SimState state{};
+	std::memcpy(state.data.timers.data() + TMInterface::SimStateView::RACE_TIME_OFFSET, &raceTime, sizeof(raceTime));
+	state.data.state2[0] = variant;
+
+	return state;
+}
+
+// The server enters the step of the state and it is read
+void step(RewindPlanner& planner, const TMInterface::SimState& state) {
+	planner.onStep(static_cast<uint32_t>(state.view().getRaceTime()) + OFFSET);
+	planner.onRead(state.view());
+}
+
+}  // namespace
+
+TEST(RewindPlanner_followsTheTrajectory) {
+	RewindPlanner planner;
+	const TMInterface::SimState a = makeState(0);
+	const TMInterface::SimState b = makeState(10);
+	const TMInterface::SimState c = makeState(20);
+
+	// Nothing read yet, so the step times of states are unknown
+	CHECK(!planner.plan(a.view()).byTime);
+
+	step(planner, a);
+	step(planner, b);
+	step(planner, c);
+
+	CHECK(planner.plan(a.view()).byTime);
+	CHECK_EQ(planner.plan(a.view()).time, OFFSET);
+	CHECK(planner.plan(b.view()).byTime);
+	CHECK(planner.plan(c.view()).byTime);
+	// Same time, but not what the server saved there
+	CHECK(!planner.plan(makeState(10, 1).view()).byTime);
+	// Never saved
+	CHECK(!planner.plan(makeState(30).view()).byTime);
+
+	// Rewinding drops everything after the target, like the server does
+	planner.onRewound(planner.plan(a.view()));
+
+	CHECK(planner.plan(a.view()).byTime);
+	CHECK(!planner.plan(b.view()).byTime);
+	CHECK(!planner.plan(c.view()).byTime);
+
+	// Another trajectory from there replaces the old one at the same times
+	const TMInterface::SimState other = makeState(10, 2);
+	step(planner, other);
+
+	CHECK(planner.plan(other.view()).byTime);
+	CHECK(!planner.plan(b.view()).byTime);
+
+	// Entering a step forgets what was saved there until it is read
+	planner.onStep(OFFSET + 10);
+
+	CHECK(!planner.plan(other.view()).byTime);
+	CHECK(planner.plan(a.view()).byTime);
+
+	// A state that was sent is saved at its time from then on, and everything after it is gone
+	step(planner, b);
+	const TMInterface::SimState sent = makeState(5, 3);
+	const RewindPlan bySending = planner.plan(sent.view());
+
+	CHECK(!bySending.byTime);
+	planner.onRewound(bySending);
+
+	CHECK(planner.plan(sent.view()).byTime);
+	CHECK(planner.plan(a.view()).byTime);
+	CHECK(!planner.plan(b.view()).byTime);
+
+	CHECK_EQ(planner.getStatistics().timeRewinds, uint64_t{1});
+	CHECK_EQ(planner.getStatistics().stateRewinds, uint64_t{1});
+
+	// A new simulation forgets all of it
+	planner.clear();
+
+	CHECK(!planner.plan(a.view()).byTime);
+	CHECK(planner.isEnabled());
+}
+
+TEST(RewindPlanner_turnsOffIfTimeRewindsNeverWork) {
+	RewindPlanner planner;
+	const TMInterface::SimState a = makeState(0);
+
+	step(planner, a);
+	planner.onRejected();
+
+	CHECK(!planner.isEnabled());
+	CHECK_EQ(planner.getStatistics().rejected, uint64_t{1});
+
+	step(planner, a);
+
+	CHECK(!planner.plan(a.view()).byTime);
+
+	// Once one worked, a rejection only forgets the trajectory
+	RewindPlanner working;
+
+	step(working, a);
+	working.onRewound(working.plan(a.view()));
+	working.onRejected();
+
+	CHECK(working.isEnabled());
+	CHECK(!working.plan(a.view()).byTime);
+
+	step(working, a);
+
+	CHECK(working.plan(a.view()).byTime);
+}
@@ -0,0 +1,178 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/CachedSimulator.h"
+#include "TMStar/Engine.h"
+#include "TMStar/SimulationCache.h"
+#include "TMStar/StateStore.h"
+#include "Test/GridSimulator.h"
+#include "Test/TemporaryDirectory.h"
+#include "Test/Test.h"
+
+namespace {
+
+using namespace TMStar;
+
+using CachedEngine = Engine<CachedSimulator<Test::GridSimulator>>;
+
+std::vector<uint8_t> serialize(const TMInterface::SimStateView& state) {
+	std::vector<uint8_t> bytes;
+	StateStore::serialize(state, bytes);
+
+	return bytes;
+}
+
+// Inserts the transition and returns the bytes it added to the data file
+uint64_t insert(SimulationCache& cache, uint64_t key, const std::vector<uint8_t>& from,
+                const SimulationOutcome& outcome, const TMInterface::SimStateView& to) {
+	const uint64_t before = cache.getStatistics().dataBytes;
+	cache.insert(key, from, outcome, to);
+
+	return cache.getStatistics().dataBytes - before;
+}
+
+// Finds the transition and checks that it gives back what was inserted
+void checkHit(SimulationCache& cache, uint64_t key, const std::vector<uint8_t>& from, const SimulationOutcome& expected,
+              const TMInterface::SimStateView& expectedState) {
+	SimulationOutcome outcome;
+	TMInterface::SimState to;
+
+	CHECK(cache.find(key, from, outcome, to));
+	CHECK_EQ(outcome.cost, expected.cost);
+	CHECK_EQ(outcome.goal, expected.goal);
+	CHECK_EQ(outcome.valid, expected.valid);
+	CHECK(serialize(to.view()) == serialize(expectedState));
+}
+
+}  // namespace
+
+TEST(SimulationCache_storesDeltasAndFullStates) {
+	Test::TemporaryDirectory directory("TMStarSimulationCache");
+	SimulationCache cache(directory.path.string(), 16);
+
+	Test::GridSimulator simulator;
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+	const std::vector<uint8_t> from = serialize(start.view());
+
+	constexpr uint64_t recordBytes = (sizeof(SimulationCache::Record) + 7) & ~uint64_t{7};
+
+	// Nothing changed, the record is all there is
+	const SimulationOutcome same{10, false, true};
+	const uint64_t sameKey = SimulationCache::getKey(from, 0);
+
+	CHECK_EQ(insert(cache, sameKey, from, same, start.view()), recordBytes);
+	checkHit(cache, sameKey, from, same, start.view());
+
+	// A move changes a few bytes, so the delta is much smaller than the state
+	TMInterface::SimState moved;
+	const SimulationOutcome move = simulator.simulate(start.view(), 0, moved);
+	const uint64_t moveKey = SimulationCache::getKey(from, 1);
+
+	CHECK(insert(cache, moveKey, from, move, moved.view()) < (recordBytes + (from.size() / 16)));
+	checkHit(cache, moveKey, from, move, moved.view());
+
+	// A checkpoint more makes the state longer, which only goes as a whole
+	TMInterface::SimState longer = moved;
+	longer.cpStates.push_back(1);
+
+	const SimulationOutcome finish{20, true, true};
+	const uint64_t finishKey = SimulationCache::getKey(from, 2);
+
+	CHECK(insert(cache, finishKey, from, finish, longer.view()) >= (recordBytes + serialize(longer.view()).size()));
+	checkHit(cache, finishKey, from, finish, longer.view());
+
+	// A key that was never inserted, and a known one for a starting state of another size
+	SimulationOutcome outcome;
+	TMInterface::SimState to;
+
+	CHECK(!cache.find(SimulationCache::getKey(from, 3), from, outcome, to));
+	CHECK(!cache.find(finishKey, serialize(longer.view()), outcome, to));
+
+	CHECK_EQ(cache.getStatistics().hits, uint64_t{3});
+	CHECK_EQ(cache.getStatistics().misses, uint64_t{2});
+	CHECK_EQ(cache.getStatistics().entries, uint64_t{3});
+}
+
+TEST(SimulationCache_growsAndReopens) {
+	Test::TemporaryDirectory directory("TMStarSimulationCache");
+	const std::filesystem::path indexPath = directory.path / "index";
+
+	// A path east and north, off the grid in the end, every state the successor of the last one
+	Test::GridSimulator simulator;
+	std::vector<TMInterface::SimState> states{Test::GridSimulator::getStart()};
+	std::vector<SimulationOutcome> outcomes;
+
+	for (size_t i = 0; i < 100; ++i) {
+		states.emplace_back();
+		outcomes.push_back(simulator.simulate(states[i].view(), (i % 3 == 0) ? 2 : 0, states.back()));
+	}
+
+	auto getKey = [&](size_t i) { return SimulationCache::getKey(serialize(states[i].view()), 0); };
+
+	{
+		SimulationCache cache(directory.path.string(), 16);
+		const uintmax_t initialSize = std::filesystem::file_size(indexPath);
+
+		for (size_t i = 0; i < outcomes.size(); ++i) {
+			cache.insert(getKey(i), serialize(states[i].view()), outcomes[i], states[i + 1].view());
+		}
+
+		// Kept at most half full, so it doubled from 16 to 256 slots on the way
+		CHECK_EQ(std::filesystem::file_size(indexPath) - sizeof(SimulationCache::IndexHeader),
+		         (initialSize - sizeof(SimulationCache::IndexHeader)) * 16);
+		CHECK_EQ(cache.getStatistics().entries, uint64_t{100});
+
+		for (size_t i = 0; i < outcomes.size(); ++i) {
+			checkHit(cache, getKey(i), serialize(states[i].view()), outcomes[i], states[i + 1].view());
+		}
+	}
+
+	SimulationCache reopened(directory.path.string());
+
+	CHECK_EQ(reopened.getStatistics().entries, uint64_t{100});
+
+	for (size_t i = 0; i < outcomes.size(); ++i) {
+		checkHit(reopened, getKey(i), serialize(states[i].view()), outcomes[i], states[i + 1].view());
+	}
+}
+
+TEST(CachedSimulator_repeatsSearchFromCache) {
+	Test::TemporaryDirectory directory("TMStarSimulationCache");
+	const TMInterface::SimState start = Test::GridSimulator::getStart();
+
+	SearchSettings settings;
+	settings.transpositionBytes = 1 << 16;
+
+	uint64_t inserted = 0;
+	CachedEngine::Result first;
+
+	{
+		Test::GridSimulator simulator;
+		SimulationCache cache(directory.path.string(), 16);
+		CachedSimulator<Test::GridSimulator> cached(simulator, cache);
+
+		first = CachedEngine(cached, settings).run(start.view());
+
+		CHECK(first.found);
+		CHECK_EQ(cache.getStatistics().inserts, simulator.getSimulations());
+
+		inserted = cache.getStatistics().inserts;
+	}
+
+	// The same search again, with the cache from disk. The simulator isn't needed anymore
+	Test::GridSimulator simulator;
+	SimulationCache cache(directory.path.string());
+	CachedSimulator<Test::GridSimulator> cached(simulator, cache);
+
+	const CachedEngine::Result second = CachedEngine(cached, settings).run(start.view());
+
+	CHECK(second.found);
+	CHECK_EQ(second.cost, first.cost);
+	CHECK(second.actions == first.actions);
+	CHECK_EQ(simulator.getSimulations(), uint64_t{0});
+	CHECK_EQ(cache.getStatistics().hits, inserted);
+	CHECK_EQ(cache.getStatistics().misses, uint64_t{0});
+}
@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <cstring>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/StateHash.h"
+#include "Test/Test.h"
+
+using namespace TMStar;
+using TMInterface::SimStateView;
+
+namespace {
+
+TMInterface::SimState makeState(float x, float z, float speed, float yaw) {
+	TMInterface::SimState state{};
+	state.cpStates.resize(3);
+
+	const float position[] = {x, 9.0f, z};
+	const float velocity[] = {0.0f, 0.0f, speed};
+
+	std::memcpy(state.data.state2.data() + SimStateView::POSITION_OFFSET, position, sizeof(position));
+	std::memcpy(state.data.state2.data() + SimStateView::VELOCITY_OFFSET, velocity, sizeof(velocity));
+	std::memcpy(state.data.state2.data() + SimStateView::ORIENTATION_OFFSET, &yaw, sizeof(yaw));
+
+	return state;
+}
+
+}  // namespace
+
+TEST(StateQuantizer_mergesStatesWithinAStep) {
+	// Steps of 0.05 m, 0.1 m/s and 0.01 rad
+	const StateQuantizer quantizer;
+
+	const TMInterface::SimState state = makeState(10.0f, -4.0f, 20.0f, 0.3f);
+	TMInterface::SimState nearby = makeState(10.01f, -4.02f, 20.03f, 0.302f);
+
+	// Also reached at another race time, with other inputs
+	const int32_t time = 1230;
+	std::memcpy(nearby.data.timers.data() + SimStateView::RACE_TIME_OFFSET, &time, sizeof(time));
+	nearby.data.inputSteerState = 65536;
+
+	CHECK(hashState(nearby.view()) != hashState(state.view()));
+	CHECK_EQ(quantizer.hash(nearby.view()), quantizer.hash(state.view()));
+
+	// A whole step off in any of them tells the states apart
+	CHECK(quantizer.hash(makeState(10.06f, -4.0f, 20.0f, 0.3f).view()) != quantizer.hash(state.view()));
+	CHECK(quantizer.hash(makeState(10.0f, -4.0f, 20.15f, 0.3f).view()) != quantizer.hash(state.view()));
+	CHECK(quantizer.hash(makeState(10.0f, -4.0f, 20.0f, 0.315f).view()) != quantizer.hash(state.view()));
+
+	// So do the checkpoints taken
+	TMInterface::SimState checkpoint = state;
+	checkpoint.cpStates[0] = 1;
+
+	CHECK(quantizer.hash(checkpoint.view()) != quantizer.hash(state.view()));
+
+	// Coarser settings merge more
+	QuantizationSettings coarse;
+	coarse.position = 1.0f;
+
+	CHECK_EQ(StateQuantizer(coarse).hash(makeState(10.3f, -4.0f, 20.0f, 0.3f).view()),
+	         StateQuantizer(coarse).hash(state.view()));
+}
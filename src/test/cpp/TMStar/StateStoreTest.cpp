@@ -0,0 +1,286 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/StateStore.h"
+#include "Test/Test.h"
+
+using namespace TMStar;
+
+namespace {
+
+bool isSame(const TMInterface::SimState& a, const TMInterface::SimState& b) {
+	return (std::memcmp(&a.data, &b.data, sizeof(a.data)) == 0) && (a.cpStates == b.cpStates) &&
+	       (a.cpTimes.size() == b.cpTimes.size()) &&
+	       (std::memcmp(a.cpTimes.data(), b.cpTimes.data(), a.cpTimes.size() * sizeof(TMInterface::CheckpointTime)) ==
+	        0);
+}
+
+// Round trips data against base, with room for the worst case
+std::vector<uint8_t> roundTrip(const std::vector<uint8_t>& data, const std::vector<uint8_t>& base,
+                               size_t& encodedSize) {
+	std::vector<uint8_t> encoded((data.size() * 2) + 8);
+	encodedSize = StateStore::encodeDelta(data.data(), base.data(), data.size(), encoded.data(), data.size() * 2);
+
+	std::vector<uint8_t> decoded = base;
+	StateStore::applyDelta(encoded.data(), encodedSize, decoded.data());
+
+	return decoded;
+}
+
+}  // namespace
+
+TEST(StateStore_roundTripsDeltas) {
+	constexpr size_t SIZE = StateStore::CHUNK_SIZE;
+
+	std::vector<uint8_t> base(SIZE);
+	for (size_t i = 0; i < SIZE; ++i) base[i] = static_cast<uint8_t>(i * 7);
+
+	size_t encodedSize = 0;
+
+	// Identical chunks are deduplicated instead, so there is no delta
+	CHECK(roundTrip(base, base, encodedSize) == base);
+	CHECK_EQ(encodedSize, size_t{0});
+
+	// Past 127 unchanged bytes the run takes a two byte varint
+	for (const size_t position : {size_t{0}, size_t{1}, size_t{127}, size_t{128}, SIZE - 1}) {
+		std::vector<uint8_t> data = base;
+		data[position] ^= 0xFF;
+
+		CHECK(roundTrip(data, base, encodedSize) == data);
+		CHECK_EQ(encodedSize, ((position < 128) ? size_t{1} : size_t{2}) + 2);
+	}
+
+	std::vector<uint8_t> changed(SIZE);
+	for (size_t i = 0; i < SIZE; ++i) changed[i] = static_cast<uint8_t>(~base[i]);
+
+	// One run of 256 changed bytes
+	CHECK(roundTrip(changed, base, encodedSize) == changed);
+	CHECK_EQ(encodedSize, SIZE + 3);
+
+	// Too large for the half chunk the store allows
+	uint8_t small[(SIZE / 2) + 8];
+	CHECK_EQ(StateStore::encodeDelta(changed.data(), base.data(), SIZE, small, SIZE / 2), size_t{0});
+
+	// Every other byte changed, many short runs
+	std::vector<uint8_t> striped = base;
+	for (size_t i = 0; i < SIZE; i += 2) striped[i] ^= 0x01;
+
+	CHECK(roundTrip(striped, base, encodedSize) == striped);
+}
+
+TEST(StateStore_rebasesLongChains) {
+	StateStore store;
+
+	TMInterface::SimState state{};
+	state.cpStates.resize(3);
+	state.cpTimes.resize(1);
+
+	std::vector<TMInterface::SimState> expected{state};
+	std::vector<StateStore::Handle> handles{store.insert(state.view())};
+
+	const StateStore::Statistics root = store.getStatistics();
+
+	// Every step changes a few bytes of one chunk, each time to something new
+	constexpr uint32_t STEPS = (2 * (StateStore::MAX_DELTA_DEPTH + 1)) + 1;
+
+	for (uint32_t step = 1; step <= STEPS; ++step) {
+		std::memcpy(state.data.state2.data() + TMInterface::SimStateView::POSITION_OFFSET, &step, sizeof(step));
+
+		expected.push_back(state);
+		handles.push_back(store.insert(state.view(), handles.back()));
+	}
+
+	const StateStore::Statistics chain = store.getStatistics();
+
+	CHECK_EQ(chain.states, size_t{STEPS + 1});
+	// Every MAX_DELTA_DEPTH + 1 steps the chunk is stored raw again, so rebuilding it never takes longer chains
+	CHECK_EQ(chain.rawChunks - root.rawChunks, size_t{2});
+	CHECK_EQ(chain.deltaChunks, size_t{STEPS - 2});
+	// Everything else was the same as the parent
+	CHECK(chain.dedupedChunks > root.dedupedChunks);
+
+	for (size_t i = 0; i < handles.size(); ++i) {
+		CHECK(isSame(store.get(handles[i]), expected[i]));
+	}
+
+	// Bases are kept alive by the deltas on them, whatever the order of the releases
+	for (size_t i = 0; i < handles.size(); i += 2) store.release(handles[i]);
+
+	for (size_t i = 1; i < handles.size(); i += 2) {
+		CHECK(isSame(store.get(handles[i]), expected[i]));
+	}
+
+	for (size_t i = 1; i < handles.size(); i += 2) store.release(handles[i]);
+
+	const StateStore::Statistics empty = store.getStatistics();
+
+	CHECK_EQ(empty.states, size_t{0});
+	CHECK_EQ(empty.chunks, size_t{0});
+	CHECK_EQ(empty.logicalBytes, size_t{0});
+	CHECK_EQ(empty.storedBytes, size_t{0});
+}
+
+TEST(StateStore_deduplicatesAndCountsReferences) {
+	StateStore store;
+
+	TMInterface::SimState state{};
+	state.cpStates.resize(3);
+	for (size_t i = 0; i < state.data.state3.size(); ++i) state.data.state3[i] = static_cast<uint8_t>(i);
+
+	const StateStore::Handle first = store.insert(state.view());
+	const StateStore::Statistics once = store.getStatistics();
+
+	// The same state again only references the chunks there are
+	const StateStore::Handle second = store.insert(state.view());
+	const StateStore::Statistics twice = store.getStatistics();
+
+	CHECK(first != second);
+	CHECK_EQ(twice.chunks, once.chunks);
+	CHECK_EQ(twice.dedupedChunks - once.dedupedChunks, (state.view().getSize() + StateStore::CHUNK_SIZE - 1) /
+	                                                       StateStore::CHUNK_SIZE);
+	CHECK_EQ(twice.logicalBytes, 2 * once.logicalBytes);
+
+	store.retain(first);
+	store.release(first);
+	store.release(second);
+
+	// Still referenced once
+	CHECK(isSame(store.get(first), state));
+	CHECK_EQ(store.getStatistics().chunks, once.chunks);
+
+	store.release(first);
+
+	CHECK_EQ(store.getStatistics().states, size_t{0});
+	CHECK_EQ(store.getStatistics().storedBytes, size_t{0});
+
+	// Starts over after being emptied
+	const StateStore::Handle again = store.insert(state.view());
+
+	CHECK(isSame(store.get(again), state));
+	CHECK_EQ(store.getStatistics().chunks, once.chunks);
+}
+
+TEST(StateStore_insertsChildrenOfTheRestoredState) {
+	StateStore store;
+
+	TMInterface::SimState parent{};
+	parent.cpStates.resize(3);
+	for (size_t i = 0; i < parent.data.state3.size(); ++i) parent.data.state3[i] = static_cast<uint8_t>(i);
+
+	const StateStore::Handle root = store.insert(parent.view());
+
+	// Like an expansion: the parent is restored, then each child goes in against it
+	TMInterface::SimState current;
+	store.restore(root, current);
+
+	std::vector<TMInterface::SimState> children;
+	std::vector<StateStore::Handle> handles;
+
+	for (uint32_t action = 0; action < 4; ++action) {
+		TMInterface::SimState child = current;
+		std::memcpy(child.data.state2.data() + TMInterface::SimStateView::POSITION_OFFSET, &action, sizeof(action));
+
+		children.push_back(child);
+		handles.push_back(store.insert(child.view(), root));
+	}
+
+	CHECK_EQ(store.getStatistics().deltaChunks, size_t{3});
+
+	// The parent goes, and its handle is reused for a different state. That one mustn't be mistaken for the old parent
+	store.release(root);
+
+	TMInterface::SimState other = parent;
+	for (uint8_t& byte : other.data.state3) byte = static_cast<uint8_t>(~byte);
+
+	const StateStore::Handle reused = store.insert(other.view());
+
+	CHECK_EQ(reused, root);
+
+	TMInterface::SimState grandchild = other;
+	grandchild.data.state3[1] ^= 0x10;
+
+	const StateStore::Handle last = store.insert(grandchild.view(), reused);
+
+	CHECK(isSame(store.get(last), grandchild));
+	CHECK(isSame(store.get(reused), other));
+
+	for (size_t i = 0; i < handles.size(); ++i) {
+		CHECK(isSame(store.get(handles[i]), children[i]));
+	}
+}
+
+TEST(StateStore_loadsCompactedChangesInPlace) {
+	StateStore store;
+	std::vector<uint8_t> changes;
+	// What a checkpoint keeps of them
+	std::vector<uint8_t> log;
+
+	// Nothing there yet, from here on changes are logged as they happen
+	store.saveChanges(changes);
+	CHECK(changes.empty());
+
+	TMInterface::SimState parent{};
+	parent.cpStates.resize(3);
+	for (size_t i = 0; i < parent.data.state3.size(); ++i) parent.data.state3[i] = static_cast<uint8_t>(i);
+
+	const StateStore::Handle root = store.insert(parent.view());
+
+	std::vector<TMInterface::SimState> children;
+	std::vector<StateStore::Handle> handles;
+
+	for (uint32_t action = 0; action < 4; ++action) {
+		TMInterface::SimState child = parent;
+		std::memcpy(child.data.state2.data() + TMInterface::SimStateView::POSITION_OFFSET, &action, sizeof(action));
+
+		children.push_back(child);
+		handles.push_back(store.insert(child.view(), root));
+	}
+
+	store.saveChanges(changes);
+	StateStore::compactChanges(changes.data(), changes.size(), log);
+
+	// The parent goes, and a state that doesn't last takes its handle within the same batch
+	store.release(root);
+
+	TMInterface::SimState other = parent;
+	for (uint8_t& byte : other.data.state3) byte = static_cast<uint8_t>(~byte);
+
+	store.release(store.insert(other.view()));
+
+	TMInterface::SimState grandchild = children[0];
+	grandchild.data.state3[1] ^= 0x10;
+
+	children.push_back(grandchild);
+	handles.push_back(store.insert(grandchild.view(), handles[0]));
+
+	store.saveChanges(changes);
+
+	const size_t compacted = log.size();
+	StateStore::compactChanges(changes.data(), changes.size(), log);
+
+	// Without the state that didn't last and the frees
+	CHECK((log.size() - compacted) < changes.size());
+
+	const std::shared_ptr<std::vector<uint8_t>> owner = std::make_shared<std::vector<uint8_t>>(log);
+
+	StateStore loaded;
+	loaded.loadChanges(owner->data(), owner->size(), handles, owner);
+
+	CHECK_EQ(loaded.getStatistics().states, handles.size());
+
+	for (size_t i = 0; i < handles.size(); ++i) {
+		CHECK(isSame(loaded.get(handles[i]), children[i]));
+	}
+
+	// Carries on logging from there
+	loaded.saveChanges(changes);
+	CHECK(changes.empty());
+
+	loaded.release(handles[1]);
+	loaded.saveChanges(changes);
+	CHECK(!changes.empty());
+}
@@ -0,0 +1,38 @@
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "TMStar/Utils/Hash.h"
+#include "Test/Test.h"
+
+using namespace TMStar::Utils;
+
+TEST(Hash_quantizedMatchesScalar) {
+	// Ties, rounding to even, negatives, values past the clamp and NaNs, in every lane and for every tail length
+	const std::vector<float> values = {0.5f,  1.5f,   -2.5f, 3.49f, -0.51f, 1e20f, -1e20f,
+	                                   1e-8f, 12.25f, -7.0f, 2.5f,  1234.5f, -0.0f, 99.75f,
+	                                   std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity()};
+	const std::vector<float> scales = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,  1.0f,  1.0f,
+	                                   4.0f, 0.5f, 1.0f, 2.0f, 1.0f, 20.0f, 10.0f, 1.0f};
+
+	for (size_t count = 0; count <= values.size(); ++count) {
+		for (const uint64_t seed : {uint64_t{0}, uint64_t{0x123456789abcdef0}}) {
+			CHECK_EQ(hashQuantized(values.data(), scales.data(), count, seed),
+			         hashQuantizedScalar(values.data(), scales.data(), count, seed));
+		}
+	}
+}
+
+TEST(Hash_quantizedIgnoresDifferencesBelowAStep) {
+	const float scales[] = {20.0f, 20.0f, 20.0f, 10.0f, 10.0f};
+	const float values[] = {10.0f, -3.0f, 7.5f, 1.0f, 0.0f};
+	const float nudged[] = {10.01f, -3.02f, 7.49f, 1.04f, 0.03f};
+	const float moved[] = {10.06f, -3.0f, 7.5f, 1.0f, 0.0f};
+
+	const uint64_t hash = hashQuantized(values, scales, 5);
+
+	CHECK_EQ(hashQuantized(nudged, scales, 5), hash);
+	CHECK(hashQuantized(moved, scales, 5) != hash);
+	CHECK(hashQuantized(values, scales, 5, 1) != hash);
+}
@@ -0,0 +1,164 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "TMStar/Utils/Hash.h"
+#include "TMStar/Utils/TranspositionTable.h"
+#include "Test/Test.h"
+
+using namespace TMStar::Utils;
+
+namespace {
+
+using Result = TranspositionTable::Result;
+
+// Keys of the same bucket in a table of one bucket only differ in their upper halves
+constexpr uint64_t makeKey(uint64_t tag) {
+	return (tag << 32) | 0x1234;
+}
+
+}  // namespace
+
+TEST(TranspositionTable_keepsLowestCost) {
+	TranspositionTable table(1 << 12);
+
+	CHECK(table.isEnabled());
+	CHECK(table.update(makeKey(5), 100) == Result::NEW);
+	CHECK(table.update(makeKey(5), 100) == Result::DUPLICATE);
+	CHECK(table.update(makeKey(5), 120) == Result::DUPLICATE);
+	CHECK(table.update(makeKey(5), 80) == Result::IMPROVED);
+	CHECK(table.update(makeKey(5), 90) == Result::DUPLICATE);
+	CHECK(table.update(makeKey(6), 90) == Result::NEW);
+
+	table.clear();
+
+	CHECK(table.update(makeKey(5), 100) == Result::NEW);
+	CHECK(!TranspositionTable(0).isEnabled());
+}
+
+TEST(TranspositionTable_remapsTagZero) {
+	TranspositionTable table(1 << 12);
+
+	// A tag of 0 would look like an empty slot and never be found again
+	CHECK(table.update(0x1234, 50) == Result::NEW);
+	CHECK(table.update(0x1234, 50) == Result::DUPLICATE);
+	// Shares the tag 0 is mapped to
+	CHECK(table.update(makeKey(1), 60) == Result::DUPLICATE);
+	CHECK(table.update(makeKey(1), 40) == Result::IMPROVED);
+	CHECK(table.update(0x1234, 45) == Result::DUPLICATE);
+}
+
+TEST(TranspositionTable_replacesCheapestWhenFull) {
+	// Exactly one bucket
+	TranspositionTable table(64);
+
+	CHECK_EQ(table.getMemoryUsage(), size_t{64});
+
+	for (uint64_t tag = 1; tag <= TranspositionTable::SLOTS_PER_BUCKET; ++tag) {
+		CHECK(table.update(makeKey(tag), static_cast<uint32_t>(100 + tag)) == Result::NEW);
+	}
+
+	CHECK_EQ(table.getReplacements(), uint64_t{0});
+
+	// Takes the place of tag 1, which has the lowest cost
+	CHECK(table.update(makeKey(100), 500) == Result::NEW);
+	CHECK_EQ(table.getReplacements(), uint64_t{1});
+
+	for (uint64_t tag = 2; tag <= TranspositionTable::SLOTS_PER_BUCKET; ++tag) {
+		CHECK(table.update(makeKey(tag), 1000) == Result::DUPLICATE);
+	}
+
+	CHECK(table.update(makeKey(100), 1000) == Result::DUPLICATE);
+	CHECK(table.update(makeKey(1), 1000) == Result::NEW);
+	CHECK_EQ(table.getReplacements(), uint64_t{2});
+}
+
+TEST(TranspositionTable_updatesConcurrently) {
+	constexpr size_t THREADS = 4;
+	constexpr uint64_t KEYS = 2000;
+	constexpr uint32_t ROUNDS = 8;
+
+	// Plenty of room, nothing gets evicted
+	TranspositionTable table(1 << 20);
+	std::atomic<uint64_t> added{0};
+	std::vector<std::thread> threads;
+
+	for (size_t id = 0; id < THREADS; ++id) {
+		threads.emplace_back([&table, &added, id]() {
+			uint64_t own = 0;
+
+			// Every thread offers every key, at costs that interleave with those of the other threads
+			for (uint32_t round = 0; round < ROUNDS; ++round) {
+				for (uint64_t key = 0; key < KEYS; ++key) {
+					const uint32_t cost = 1000 - (round * THREADS) - static_cast<uint32_t>(id) + (key % 7);
+
+					if (table.update(mix(key + 1), cost) == Result::NEW) ++own;
+				}
+			}
+
+			added += own;
+		});
+	}
+
+	for (std::thread& thread : threads) thread.join();
+
+	// Exactly one thread got to add each key
+	CHECK_EQ(added.load(), KEYS);
+	CHECK_EQ(table.getReplacements(), uint64_t{0});
+
+	// The lowest cost any thread offered won
+	for (uint64_t key = 0; key < KEYS; ++key) {
+		const uint32_t lowest = 1000 - (((ROUNDS - 1) * THREADS) + (THREADS - 1)) + (key % 7);
+
+		CHECK(table.update(mix(key + 1), lowest) == Result::DUPLICATE);
+		CHECK(table.update(mix(key + 1), lowest - 1) == Result::IMPROVED);
+	}
+}
+
+TEST(TranspositionTable_replaysLoggedChanges) {
+	TranspositionTable table(1 << 12);
+	std::vector<TranspositionTable::Change> changes;
+
+	table.logChanges();
+
+	for (uint64_t key = 1; key <= 100; ++key) {
+		table.update(mix(key), static_cast<uint32_t>(key));
+	}
+
+	table.update(mix(1), 0);
+	table.update(mix(2), 50);
+	table.saveChanges(changes);
+
+	// Every update that took, the one that didn't is left out
+	CHECK_EQ(changes.size(), size_t{101});
+
+	// Applied in order to empty slots, the changes give the table
+	std::vector<uint64_t> slots(table.getSlotCount());
+
+	for (const TranspositionTable::Change& change : changes) {
+		slots[change.slot] = change.value;
+	}
+
+	TranspositionTable copy(1 << 12);
+
+	CHECK(!copy.attach(slots.data(), slots.size() / 2, nullptr));
+	CHECK(copy.attach(slots.data(), slots.size(), nullptr));
+
+	for (uint64_t key = 2; key <= 100; ++key) {
+		CHECK(copy.update(mix(key), static_cast<uint32_t>(key)) == Result::DUPLICATE);
+	}
+
+	CHECK(copy.update(mix(1), 0) == Result::DUPLICATE);
+	CHECK(copy.update(mix(101), 0) == Result::NEW);
+
+	// The attached slots are the table
+	std::vector<uint64_t> before(slots);
+	CHECK(copy.update(mix(102), 0) == Result::NEW);
+	CHECK(slots != before);
+
+	// Nothing was logged since
+	table.saveChanges(changes);
+	CHECK(changes.empty());
+}
@@ -0,0 +1,81 @@
+#include "Test/GridSimulator.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace Test {
+
+namespace {
+
+constexpr int32_t MOVE_X[] = {1, -1, 0, 0};
+constexpr int32_t MOVE_Z[] = {0, 0, 1, -1};
+constexpr uint32_t MOVE_COST[] = {10, 7, 13, 5};
+
+}  // namespace
+
+GridSimulator::GridSimulator() : actions{0, 1, 2, 3}, simulations(0) {}
+
+const std::vector<GridSimulator::Action>& GridSimulator::getActions() const {
+	return actions;
+}
+
+uint64_t GridSimulator::getSegmentHash(const Action& action) const {
+	return action;
+}
+
+TMStar::SimulationOutcome GridSimulator::simulate(const TMInterface::SimStateView& from, const Action& action,
+                                                  TMInterface::SimState& to) {
+	++simulations;
+
+	to.data = *from.data;
+	to.cpStates.assign(from.cpStates.begin(), from.cpStates.end());
+	to.cpTimes.clear();
+
+	const TMInterface::Vec3 position = from.getPosition();
+	const int32_t x = static_cast<int32_t>(std::lround(position.x)) + MOVE_X[action];
+	const int32_t z = static_cast<int32_t>(std::lround(position.z)) + MOVE_Z[action];
+
+	const TMInterface::Vec3 moved{static_cast<float>(x), position.y, static_cast<float>(z)};
+	std::memcpy(to.data.state2.data() + TMInterface::SimStateView::POSITION_OFFSET, &moved, sizeof(moved));
+	to.data.state3[static_cast<size_t>((x * 31) + (z * 7) + 1000) % to.data.state3.size()] ^= 0x5A;
+
+	TMStar::SimulationOutcome outcome;
+	outcome.cost = MOVE_COST[action] + static_cast<uint32_t>(((x * 7) + (z * 3)) & 7);
+	outcome.valid = (x > -SIZE) && (x < SIZE) && (z > -SIZE) && (z < SIZE);
+	outcome.goal = (x == GOAL_X) && (z == GOAL_Z);
+
+	return outcome;
+}
+
+uint64_t GridSimulator::getSimulations() const {
+	return simulations;
+}
+
+TMInterface::SimState GridSimulator::getStart() {
+	TMInterface::SimState state{};
+	state.cpStates.resize(3);
+
+	return state;
+}
+
+uint32_t GridSimulator::replay(const std::vector<Action>& actions) {
+	GridSimulator simulator;
+	TMInterface::SimState state = getStart();
+	TMInterface::SimState next;
+	uint32_t cost = 0;
+	bool goal = false;
+
+	for (const Action action : actions) {
+		const TMStar::SimulationOutcome outcome = simulator.simulate(state.view(), action, next);
+
+		if (!outcome.valid) return 0;
+
+		cost += outcome.cost;
+		goal = outcome.goal;
+		state = next;
+	}
+
+	return goal ? cost : 0;
+}
+
+}  // namespace Test
@@ -0,0 +1,50 @@
+#include "Test/Peer.h"
+
+#include <cstdint>
+
+#include "Test/Test.h"
+
+namespace Test {
+
+Peer::Peer(const Emulator::ServerSettings& settings, const Emulator::CarModel& model)
+    : running(true), name(makeName()), server(name, TMInterface::Utils::MappingOptions{true}, settings, model) {
+	if (!server) throw Failure("Can't create buffer " + name);
+
+	thread = std::thread([this] { server.run(running); });
+}
+
+Peer::~Peer() {
+	running = false;
+	thread.join();
+}
+
+const std::string& Peer::getName() const {
+	return name;
+}
+
+std::string Peer::makeName() {
+	static std::atomic<uint32_t> instances{0};
+
+	// Tests of several processes may run at the same time
+	const uint64_t time = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+	return "TMStarTest" + std::to_string(time) + '_' + std::to_string(instances++);
+}
+
+TMInterface::Packet* exchange(TMInterface::Interface& client, const TMInterface::Packet& packet) {
+	client.sendPacket(packet);
+
+	return waitAndReceive(client);
+}
+
+TMInterface::Packet* waitAndReceive(TMInterface::Interface& client) {
+	if (!client.waitForPacket(std::chrono::seconds(1))) fail(__FILE__, __LINE__, "No answer from the emulator");
+
+	TMInterface::Packet* packet = client.receivePacket();
+
+	if (packet == nullptr) fail(__FILE__, __LINE__, "Unknown packet from the emulator");
+
+	return packet;
+}
+
+}  // namespace Test
@@ -0,0 +1,19 @@
+#include "Test/TemporaryDirectory.h"
+
+#include <chrono>
+#include <system_error>
+
+namespace Test {
+
+TemporaryDirectory::TemporaryDirectory(const std::string& name)
+    : path(std::filesystem::temp_directory_path() /
+           (name + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()))) {
+	std::filesystem::create_directories(path);
+}
+
+TemporaryDirectory::~TemporaryDirectory() {
+	std::error_code error;
+	std::filesystem::remove_all(path, error);
+}
+
+}  // namespace Test
@@ -0,0 +1,32 @@
+#include "Test/Test.h"
+
+namespace Test {
+
+namespace {
+
+std::vector<TestCase>& getRegistry() {
+	// Function local, the TESTs of other files register before main and in no particular order
+	static std::vector<TestCase> tests;
+
+	return tests;
+}
+
+}  // namespace
+
+Failure::Failure(const std::string& message) : std::runtime_error(message) {}
+
+bool add(const char* name, Body body) {
+	getRegistry().push_back({name, body});
+
+	return true;
+}
+
+const std::vector<TestCase>& getTests() {
+	return getRegistry();
+}
+
+void fail(const char* file, int line, const std::string& message) {
+	throw Failure(std::string(file) + ':' + std::to_string(line) + ": " + message);
+}
+
+}  // namespace Test
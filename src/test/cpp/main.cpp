@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Test/Test.h"
+
+namespace {
+
+void printUsage(const char* name) {
+	std::cerr << "Usage: " << name << " [options]\n"
+	          << "  --filter <text>      only run tests whose name contains text\n"
+	          << "  --list               print the names of the tests instead of running them\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	std::string filter;
+	bool list = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if ((arg == "--filter") && ((i + 1) < argc)) {
+			filter = argv[++i];
+		} else if (arg == "--list") {
+			list = true;
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<Test::TestCase> tests = Test::getTests();
+	std::sort(tests.begin(), tests.end(),
+	          [](const Test::TestCase& a, const Test::TestCase& b) { return std::string(a.name) < b.name; });
+
+	size_t run = 0;
+	size_t failed = 0;
+
+	for (const Test::TestCase& test : tests) {
+		if (std::string(test.name).find(filter) == std::string::npos) continue;
+
+		if (list) {
+			std::cout << test.name << '\n';
+			continue;
+		}
+
+		std::cout << "[ RUN  ] " << test.name << std::endl;
+
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		bool passed = true;
+
+		try {
+			test.body();
+		} catch (const std::exception& e) {
+			std::cout << e.what() << std::endl;
+			passed = false;
+		}
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+
+		std::cout << (passed ? "[  OK  ] " : "[ FAIL ] ") << test.name << " (" << elapsed.count() << "ms)" << std::endl;
+		++run;
+		if (!passed) ++failed;
+	}
+
+	if (!list) std::cout << (run - failed) << '/' << run << " tests passed" << std::endl;
+
+	return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "TMInterface/SimState.h"
+#include "TMStar/Engine.h"
+
+namespace Test {
+
+// Simulator for the searches that doesn't need a server. The car moves one meter per action on a grid, and each move
+// costs a little more or less depending on where it ends, so the optimal path isn't just any shortest one. Every cell
+// also flips a byte of its own far from the position, which gives the states more than one chunk that changes.
+class GridSimulator {
+public:
+	using Action = uint8_t;
+
+	// Cells strictly between -SIZE and SIZE in both directions are valid
+	static constexpr int32_t SIZE = 30;
+	static constexpr int32_t GOAL_X = 18;
+	static constexpr int32_t GOAL_Z = -15;
+
+protected:
+	const std::vector<Action> actions;
+	uint64_t simulations;
+
+public:
+	GridSimulator();
+
+	// East, west, north and south
+	const std::vector<Action>& getActions() const;
+	uint64_t getSegmentHash(const Action& action) const;
+	TMStar::SimulationOutcome simulate(const TMInterface::SimStateView& from, const Action& action,
+	                                   TMInterface::SimState& to);
+
+	uint64_t getSimulations() const;
+
+	// At the center of the grid
+	static TMInterface::SimState getStart();
+	// Race time of the actions from the start, or 0 if they don't end at the goal
+	static uint32_t replay(const std::vector<Action>& actions);
+};
+
+}  // namespace Test
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "Emulator/Server.h"
+#include "TMInterface/Interface.h"
+
+namespace Test {
+
+// Emulator server on its own thread of the test, stopped when leaving scope. Every instance gets a buffer of its own
+class Peer {
+protected:
+	std::atomic_bool running;
+	const std::string name;
+	Emulator::Server server;
+	std::thread thread;
+
+public:
+	explicit Peer(const Emulator::ServerSettings& settings = {}, const Emulator::CarModel& model = {});
+	~Peer();
+
+	const std::string& getName() const;
+
+	// Delete copy stuff
+	Peer(const Peer&) = delete;
+	Peer& operator=(const Peer&) = delete;
+
+protected:
+	static std::string makeName();
+};
+
+// Sends packet and returns the answer. Throws Failure if there is none within a second
+TMInterface::Packet* exchange(TMInterface::Interface& client, const TMInterface::Packet& packet);
+TMInterface::Packet* waitAndReceive(TMInterface::Interface& client);
+
+}  // namespace Test
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace Test {
+
+// Fresh directory in the system's temporary directory, deleted with everything in it when leaving scope
+class TemporaryDirectory {
+public:
+	const std::filesystem::path path;
+
+	explicit TemporaryDirectory(const std::string& name);
+	~TemporaryDirectory();
+
+	// Delete copy stuff
+	TemporaryDirectory(const TemporaryDirectory&) = delete;
+	TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+};
+
+}  // namespace Test
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Test {
+
+using Body = void (*)();
+
+struct TestCase {
+	const char* name;
+	Body body;
+};
+
+// Thrown by the CHECK macros, ends the test
+class Failure : public std::runtime_error {
+public:
+	explicit Failure(const std::string& message);
+};
+
+// Registers a test, TEST does this before main runs. Returns true so it can initialize a static
+bool add(const char* name, Body body);
+const std::vector<TestCase>& getTests();
+
+[[noreturn]] void fail(const char* file, int line, const std::string& message);
+
+template <typename A, typename B>
+[[noreturn]] void failOp(const char* file, int line, const char* expression, const A& a, const B& b);
+
+}  // namespace Test
+
+// TEST(Suite_name) { ... } defines and registers a test. --filter matches on the name
+#define TEST(name)                                                  \
+	static void name();                                             \
+	static const bool name##Registered = ::Test::add(#name, &name); \
+	static void name()
+
+#define CHECK(condition)                                                             \
+	do {                                                                             \
+		if (!(condition)) ::Test::fail(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+	} while (false)
+
+// Also prints both sides
+#define CHECK_OP(a, op, b)                                                         \
+	do {                                                                           \
+		const auto& checkA = (a);                                                  \
+		const auto& checkB = (b);                                                  \
+		if (!(checkA op checkB)) {                                                 \
+			::Test::failOp(__FILE__, __LINE__, #a " " #op " " #b, checkA, checkB); \
+		}                                                                          \
+	} while (false)
+
+#define CHECK_EQ(a, b) CHECK_OP(a, ==, b)
+#define CHECK_LE(a, b) CHECK_OP(a, <=, b)
+
+namespace Test {
+
+// template functions
+template <typename A, typename B>
+void failOp(const char* file, int line, const char* expression, const A& a, const B& b) {
+	std::ostringstream message;
+	message << expression << " with " << a << " and " << b;
+
+	fail(file, line, message.str());
+}
+
+}  // namespace Test